@@ -0,0 +1,88 @@
+// Будильники.
+//
+// Кожен будильник має час доби, дні тижня та режим (вимкнений, один раз,
+// повторювати). Для ввімкнених будильників рахується момент наступного
+// спрацювання (секунда від початку епохи годинника), і вони тримаються в
+// маленькій мін-купі за цим моментом. Тому перевірка на кожному пробудженні -
+// одне порівняння з вершиною купи, а планувальник будить чип точно до
+// найближчого будильника.
+//
+// Будильник спрацьовує, коли його момент настав або вже минув (а не тільки в
+// ту саму секунду), тому пробудження, яке проскочило секунду будильника, його
+// не пропустить. Будильник, який запізнився більше ніж на ALARM_MAX_LATE_S
+// (наприклад, поки годинник стояв в меню), пропускається. Одноразовий
+// будильник після цього теж вимикається, і takeDisarmed() повідомляє про
+// це, щоб зміну можна було записати у флеш так само, як після спрацювання.
+//
+// Об'єкт живе в RTC пам'яті (RTC_DATA_ATTR), тому поля мають тільки
+// ініціалізатори, і пробудження з глибокого сну їх не скидає.
+#pragma once
+
+#include <stdint.h>
+
+// Кількість будильників
+#define ALARM_SLOTS 4
+
+// Найбільше запізнення, з яким будильник ще спрацьовує, с
+#define ALARM_MAX_LATE_S 600
+
+// Дні тижня (біт 0 - понеділок, біт 6 - неділя)
+#define ALARM_EVERY_DAY 0x7F
+
+enum AlarmMode
+{
+    ALARM_OFF,
+    ALARM_ONCE,   // Спрацює один раз і вимкнеться
+    ALARM_REPEAT, // Спрацьовує в кожен вибраний день
+    ALARM_MODES
+};
+
+struct Alarm
+{
+    uint8_t mode; // AlarmMode
+    uint8_t days; // Дні тижня (ALARM_EVERY_DAY - щодня)
+    uint8_t hours, minutes, seconds;
+    uint8_t melody; // Номер мелодії (MELODIES в MelodyPlayer.h)
+};
+
+class AlarmEngine
+{
+private:
+    Alarm alarms[ALARM_SLOTS] = {{ALARM_REPEAT, ALARM_EVERY_DAY, 7, 30, 0, 0}};
+
+    uint64_t fireAt[ALARM_SLOTS] = {}; // Наступне спрацювання кожного будильника
+    uint8_t heap[ALARM_SLOTS] = {};    // Номери будильників, мін-купа за fireAt
+    uint8_t heapSize = 0;
+
+    bool disarmed = false; // Одноразовий будильник вимкнувся в poll()
+
+    // Перше спрацювання будильника пізніше секунди after (UINT64_MAX - ніколи)
+    uint64_t nextFire(const Alarm &alarm, uint64_t after);
+
+    void push(uint8_t slot);
+    void pop();
+
+public:
+    const Alarm &get(int slot);
+
+    // Змінити будильник slot (now - поточна секунда годинника)
+    void set(int slot, const Alarm &alarm, uint64_t now);
+
+    // Перерахувати всі спрацювання (після встановлення часу або дати)
+    void rebuild(uint64_t now);
+
+    // Секунда найближчого спрацювання (UINT64_MAX - будильників немає)
+    uint64_t next();
+
+    // Чи настав момент найближчого будильника
+    bool due(uint64_t now);
+
+    // Номер будильника, який спрацював (або -1). Спрацювання знімається з
+    // купи: повторюваний будильник планується на наступний день, а
+    // одноразовий вимикається
+    int poll(uint64_t now);
+
+    // Чи вимкнув poll() одноразовий будильник (після спрацювання або
+    // пропуску) з минулого виклику
+    bool takeDisarmed();
+};
@@ -0,0 +1,76 @@
+// Вимірювання заряду акумулятора.
+//
+// Раз на період АЦП читається кілька разів підряд (передискретизація з
+// децимацією дає кілька зайвих біт і прибирає шум), напруга згладжується
+// експоненційним середнім, а заряд береться з таблиці розряду Li-ion
+// (напруга розімкненого кола), а не лінійно. Відсоток на екрані змінюється
+// тільки коли різниця більша за гістерезис, тому не стрибає туди-сюди.
+//
+// Об'єкт живе в RTC пам'яті (конструктор constexpr, див. ClockCore.h), тому
+// фільтр переживає глибокий сон: після пробудження перше вимірювання йде
+// через той самий фільтр, а не береться як є. Годинник вимикається тільки
+// після кількох вимірювань з нулем підряд, а не через одне погане читання.
+#pragma once
+
+#include <Arduino.h>
+
+// Кількість читань АЦП за одне вимірювання (4^n дає n зайвих біт)
+#define BATTERY_OVERSAMPLING 16
+#define BATTERY_EXTRA_BITS 2
+
+// Коефіцієнт експоненційного середнього: нове значення має вагу 1/2^n
+#define BATTERY_EMA_SHIFT 2
+
+// На скільки відсотків має змінитись заряд, щоб змінилось показане значення
+#define BATTERY_HYSTERESIS 2
+
+// Скільки вимірювань підряд відфільтрований заряд має бути 0%, щоб
+// акумулятор вважався розрядженим
+#define BATTERY_EMPTY_READINGS 3
+
+// Точка таблиці розряду: напруга (мВ) та заряд (%)
+struct BatteryPoint
+{
+    uint16_t millivolts;
+    uint8_t percent;
+};
+
+class BatteryMonitor
+{
+private:
+    uint8_t pin;
+    uint32_t period;          // Як часто вимірювати (мс)
+    uint32_t lastSample = 0;  // millis() останнього вимірювання
+    bool sampled = false;     // Чи було хоч одне вимірювання
+
+    int32_t filtered = 0;     // Згладжена напруга, мкВ
+    int charge = 0;           // Показаний заряд, %
+    uint8_t emptyReadings = 0; // Вимірювання з 0% підряд
+
+    // Середнє з BATTERY_OVERSAMPLING читань, в мкВ на акумуляторі
+    int32_t sample();
+
+public:
+    constexpr BatteryMonitor(uint8_t pin, uint32_t periodMs) : pin(pin), period(periodMs)
+    {
+    }
+
+    // Після старту (millis() почався заново): наступне вимірювання одразу,
+    // фільтр та показаний заряд лишаються
+    void resume(uint32_t now);
+
+    // Виміряти, якщо вже час. Повертає true, якщо АЦП читався
+    bool update(uint32_t now);
+
+    // Через скільки мілісекунд наступне вимірювання
+    uint32_t nextWakeMs(uint32_t now);
+
+    float getVoltage();
+    int getCharge();
+
+    // Чи заряд був 0% останні BATTERY_EMPTY_READINGS вимірювань
+    bool isEmpty();
+
+    // Заряд за таблицею розряду для напруги в мілівольтах
+    static int chargeFromMillivolts(int32_t millivolts);
+};
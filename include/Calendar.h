@@ -0,0 +1,97 @@
+// Григоріанський календар за сталий час.
+//
+// Перетворення дати в номер дня від 01.01.1970 і назад без циклів по роках
+// та місяцях (алгоритми days_from_civil / civil_from_days Говарда Хіннанта).
+// Рік ділиться на 400-річні ери по 146097 днів, а рік всередині ери
+// починається з березня, тому 29 лютого - останній день року, і довжини
+// місяців рахуються однією формулою. Правило високосних років повне
+// (2100 - не високосний, 2000 - високосний).
+//
+// Всі функції constexpr, тому перевірки нижче виконує компілятор.
+#pragma once
+
+#include <stdint.h>
+
+// Дата за григоріанським календарем
+struct CivilDate
+{
+    int16_t year;
+    uint8_t month; // 1-12
+    uint8_t date;  // 1-31
+};
+
+constexpr bool isLeapYear(int year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+// Кількість днів в місяці (month - 1-12)
+constexpr int daysInMonth(int month, int year)
+{
+    constexpr uint8_t days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return (month == 2 && isLeapYear(year)) ? 29 : days[month - 1];
+}
+
+// Номер дня від 01.01.1970 (до нього - від'ємний)
+constexpr int32_t daysFromCivil(int year, int month, int date)
+{
+    year -= month <= 2;
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    // Рік ери (0-399), день року з 1 березня (0-365) та день ери (0-146096)
+    uint32_t yearOfEra = year - era * 400;
+    uint32_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + date - 1;
+    uint32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + (int32_t)dayOfEra - 719468;
+}
+
+// Дата дня з номером days від 01.01.1970
+constexpr CivilDate civilFromDays(int32_t days)
+{
+    days += 719468;
+    int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+    uint32_t dayOfEra = days - era * 146097;
+    uint32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    uint32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    uint32_t monthFromMarch = (5 * dayOfYear + 2) / 153;
+    uint32_t date = dayOfYear - (153 * monthFromMarch + 2) / 5 + 1;
+    uint32_t month = monthFromMarch < 10 ? monthFromMarch + 3 : monthFromMarch - 9;
+    int32_t year = (int32_t)yearOfEra + era * 400 + (month <= 2);
+    return {(int16_t)year, (uint8_t)month, (uint8_t)date};
+}
+
+// День тижня дня з номером days від 01.01.1970 (0 - понеділок, 6 - неділя;
+// 01.01.1970 був четвер)
+constexpr int weekdayFromDays(int32_t days)
+{
+    return (days % 7 + 10) % 7;
+}
+
+// Чи переводяться перший та останній день кожного місяця років from-to
+// туди й назад без змін і чи йдуть дні підряд
+constexpr bool calendarRoundTrips(int from, int to)
+{
+    int32_t expected = daysFromCivil(from, 1, 1);
+    for (int year = from; year <= to; year++)
+        for (int month = 1; month <= 12; month++)
+        {
+            int last = daysInMonth(month, year);
+            if (daysFromCivil(year, month, 1) != expected)
+                return false;
+
+            CivilDate first = civilFromDays(expected);
+            CivilDate end = civilFromDays(expected + last - 1);
+            if (first.year != year || first.month != month || first.date != 1 || end.year != year ||
+                end.month != month || end.date != last)
+                return false;
+
+            expected += last;
+        }
+    return true;
+}
+
+static_assert(daysFromCivil(1970, 1, 1) == 0, "epoch");
+static_assert(daysFromCivil(2000, 3, 1) - daysFromCivil(2000, 2, 28) == 2, "2000 is a leap year");
+static_assert(daysFromCivil(2100, 3, 1) - daysFromCivil(2100, 2, 28) == 1, "2100 is not a leap year");
+static_assert(civilFromDays(daysFromCivil(2199, 12, 31)).date == 31, "end of range");
+static_assert(weekdayFromDays(daysFromCivil(2025, 7, 17)) == 3 && weekdayFromDays(-1) == 2, "weekday");
+static_assert(calendarRoundTrips(1970, 2199), "calendar round trip");
@@ -0,0 +1,61 @@
+// Ядро годинника на цілих числах.
+//
+// Час зберігається як 64-бітний лічильник мікросекунд від 01.01.1970 00:00:00
+// (місцевий час). Поправка на дрифт кварцу задається в мільярдних частках
+// (ppb) і накопичується з залишком, тому на відміну від float секунд
+// похибка округлення не накопичується ніколи. Години, хвилини, дата і т.д.
+// рахуються з лічильника тільки коли змінилась секунда (або день).
+//
+// Ядро живе в RTC пам'яті (RTC_DATA_ATTR), тому конструктор за замовчуванням
+// має лишатися constexpr (тільки ініціалізатори полів): тоді об'єкт
+// ініціалізується ще при збірці прямо в .rtc.data, а не конструктором при
+// старті, який скидав би годинник після кожного пробудження з глибокого сну.
+#pragma once
+
+#include <stdint.h>
+
+#define MICROS_PER_SECOND 1000000ULL
+#define SECONDS_PER_DAY 86400UL
+#define PPB 1000000000LL
+
+// Найменший та найбільший рік, які можна встановити
+#define CLOCK_MIN_YEAR 1970
+#define CLOCK_MAX_YEAR 2199
+
+class ClockCore
+{
+private:
+    uint64_t epochUs = 0;  // Мікросекунди від початку епохи
+    int32_t remainder = 0; // Залишок поправки (в ppb від мікросекунди)
+
+    // Кеш полів, порахованих з лічильника
+    uint64_t cachedSecond = UINT64_MAX;
+    uint32_t cachedDay = UINT32_MAX;
+    uint8_t hours = 0, minutes = 0, seconds = 0;
+    uint8_t date = 1, month = 1;
+    uint16_t year = CLOCK_MIN_YEAR;
+
+    // Перерахунок полів, якщо змінилась секунда
+    void refresh();
+
+public:
+    // Просунути годинник на deltaUs мікросекунд millis() з поправкою
+    // correctionPpb (на скільки ppb годинник має йти швидше за millis())
+    void advance(uint64_t deltaUs, int32_t correctionPpb);
+
+    // Встановлення часу (дата не змінюється) та дати (час не змінюється)
+    void setTime(int hours, int minutes, int seconds);
+    void setDate(int date, int month, int year);
+
+    int getHours();
+    int getMinutes();
+    int getSeconds();
+    int getDate();
+    int getMonth();
+    int getYear();
+
+    uint32_t getSecondOfDay();
+    uint32_t getMicrosOfSecond();
+    uint64_t getEpochSeconds();
+    uint64_t getEpochUs();
+};
@@ -0,0 +1,115 @@
+// Кеш спрайтів цифр для циферблату.
+//
+// Цифри 0-9 та ':' класичного шрифту 5x7 Adafruit GFX растеризуються ще під
+// час компіляції в тому ж форматі, що і буфер SSD1306: сторінки по 8 рядків,
+// кожен байт - колонка з 8 пікселів (молодший біт зверху). Тому намалювати
+// символ - це скопіювати кілька рядків байтів в буфер, замість того щоб
+// Adafruit GFX заново масштабувала кожен піксель через fillRect().
+//
+// Результат побітово такий самий, як print() з відповідним setTextSize()
+// (жирний варіант - як два print() зі зсувом на 1 піксель вправо).
+//
+// Для кожного символу також відома кількість світних пікселів, щоб ще до
+// відмальовки вибрати тонший варіант, якщо текст не влазить в бюджет
+// пікселів екрану (струм панелі росте з кількістю світних пікселів).
+#pragma once
+
+#include <Adafruit_SSD1306.h>
+#include <stdint.h>
+
+// Кількість символів в кеші: 0-9 та ':'
+#define SPRITE_GLYPHS 11
+
+// Колонки символів шрифту 5x7 (як в glcdfont.c бібліотеки Adafruit GFX)
+constexpr uint8_t SPRITE_FONT[SPRITE_GLYPHS][5] = {
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, // 0
+    {0x00, 0x42, 0x7F, 0x40, 0x00}, // 1
+    {0x72, 0x49, 0x49, 0x49, 0x46}, // 2
+    {0x21, 0x41, 0x49, 0x4D, 0x33}, // 3
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, // 4
+    {0x27, 0x45, 0x45, 0x45, 0x39}, // 5
+    {0x3C, 0x4A, 0x49, 0x49, 0x31}, // 6
+    {0x41, 0x21, 0x11, 0x09, 0x07}, // 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, // 8
+    {0x46, 0x49, 0x49, 0x29, 0x1E}, // 9
+    {0x00, 0x00, 0x14, 0x00, 0x00}, // :
+};
+
+// Спрайти всіх символів одного розміру: [символ][сторінка][колонка]
+template <int Scale, bool Bold>
+struct SpriteTable
+{
+    static constexpr int WIDTH = 5 * Scale + (Bold ? 1 : 0);
+    static constexpr int PAGES = Scale;
+
+    uint8_t data[SPRITE_GLYPHS][PAGES][WIDTH];
+    uint16_t lit[SPRITE_GLYPHS]; // Світні пікселі кожного символу
+};
+
+// Чи світиться піксель (x, y) символу glyph, збільшеного в scale разів
+constexpr bool spritePixel(int glyph, int x, int y, int scale)
+{
+    return x >= 0 && x / scale < 5 && (SPRITE_FONT[glyph][x / scale] >> (y / scale) & 1);
+}
+
+// Растеризація всіх символів (виконується компілятором)
+template <int Scale, bool Bold>
+constexpr SpriteTable<Scale, Bold> rasterise()
+{
+    SpriteTable<Scale, Bold> table = {};
+
+    for (int glyph = 0; glyph < SPRITE_GLYPHS; glyph++)
+        for (int page = 0; page < Scale; page++)
+            for (int x = 0; x < table.WIDTH; x++)
+            {
+                uint8_t column = 0;
+                for (int bit = 0; bit < 8; bit++)
+                {
+                    int y = page * 8 + bit;
+                    if (spritePixel(glyph, x, y, Scale) || (Bold && spritePixel(glyph, x - 1, y, Scale)))
+                        column |= 1 << bit;
+                }
+                table.data[glyph][page][x] = column;
+                for (int bit = 0; bit < 8; bit++)
+                    table.lit[glyph] += column >> bit & 1;
+            }
+
+    return table;
+}
+
+inline constexpr SpriteTable<4, true> SPRITES_4X_BOLD = rasterise<4, true>();
+inline constexpr SpriteTable<4, false> SPRITES_4X = rasterise<4, false>();
+inline constexpr SpriteTable<2, false> SPRITES_2X = rasterise<2, false>();
+inline constexpr SpriteTable<1, false> SPRITES_1X = rasterise<1, false>();
+
+// Опис одного розміру для функцій малювання
+struct SpriteFont
+{
+    uint8_t scale;   // Збільшення (як в setTextSize())
+    uint8_t width;   // Ширина спрайта в пікселях
+    uint8_t pages;   // Висота спрайта в сторінках по 8 рядків
+    const uint8_t *data;
+    const uint16_t *lit;
+};
+
+constexpr SpriteFont FACE_4X_BOLD = {4, SPRITES_4X_BOLD.WIDTH, SPRITES_4X_BOLD.PAGES, &SPRITES_4X_BOLD.data[0][0][0],
+                                     SPRITES_4X_BOLD.lit};
+constexpr SpriteFont FACE_4X = {4, SPRITES_4X.WIDTH, SPRITES_4X.PAGES, &SPRITES_4X.data[0][0][0], SPRITES_4X.lit};
+constexpr SpriteFont FACE_2X = {2, SPRITES_2X.WIDTH, SPRITES_2X.PAGES, &SPRITES_2X.data[0][0][0], SPRITES_2X.lit};
+constexpr SpriteFont FACE_1X = {1, SPRITES_1X.WIDTH, SPRITES_1X.PAGES, &SPRITES_1X.data[0][0][0], SPRITES_1X.lit};
+
+// Перевірка растеризації на кількох відомих колонках
+static_assert(SPRITES_1X.data[0][0][0] == 0x3E, "1x '0' first column");
+static_assert(SPRITES_2X.data[1][0][4] == 0xFF && SPRITES_2X.data[1][1][4] == 0x3F, "2x '1' stem");
+static_assert(SPRITES_4X_BOLD.data[10][1][12] == 0x0F && SPRITES_4X_BOLD.data[10][1][13] == 0x00, "4x bold ':'");
+static_assert(SPRITES_1X.lit[8] == 17 && SPRITES_4X.lit[8] == 17 * 16 && SPRITES_4X_BOLD.lit[8] == 316, "lit '8'");
+
+// Намалювати текст в буфер дисплея, починаючи з (x, y), як print() після
+// setCursor(x, y), але без переносу рядка (що не влізло - обрізається).
+// Цифри та ':' беруться з кешу, решта символів малюється через drawChar().
+// Повертає x після останнього символу.
+int16_t drawSpriteText(Adafruit_SSD1306 &display, int16_t x, int16_t y, const char *text, const SpriteFont &font);
+
+// Скільки пікселів засвітить drawSpriteText() (символи не з кешу не
+// рахуються; символи, що накладаються, рахуються окремо)
+uint16_t spriteTextPixels(const char *text, const SpriteFont &font);
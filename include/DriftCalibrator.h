@@ -0,0 +1,113 @@
+// Калібровка дрифту годинника за виправленнями користувача.
+//
+// Годинник йде з поправкою (ppb), яка залежить від режиму (день - millis()
+// між легкими снами, ніч - RTC таймер глибокого сну) та температури:
+//
+//   поправка = ppb[режим] + quadratic * ((T - T0)^2 - (Tк - T0)^2)
+//
+// де T0 - вершина параболи кварцу (DRIFT_TURNOVER_C), а Tк - кімнатна
+// температура (DRIFT_ROOM_C). ppb[режим] - поправка при кімнатній
+// температурі, тому температурний член там нуль: коефіцієнт не може
+// підміняти собою поправки, і регуляризація коефіцієнта до нуля не зсуває
+// хід годинника в кімнаті.
+//
+// Між двома встановленнями часу користувачем накопичуються секунди в
+// кожному режимі, температурна "доза" (сума температурного члена * dt) та
+// поправка, яку годинник вже додав. Коли користувач виправляє час, різниця між
+// встановленим та показаним часом разом з уже доданою поправкою дає одне
+// рівняння на три невідомі. Рівняння накопичуються в нормальні рівняння
+// найменших квадратів (з поступовим забуванням старих, бо кварц старіє), а
+// регуляризація тягне розв'язок до заводських констант, поки рівнянь мало.
+#pragma once
+
+#include <stdint.h>
+
+// Початкові поправки: на скільки ppb годинник має йти швидше за millis()
+// вдень та вночі. Знайдені двійковим пошуком для одного екземпляра плати (з
+// ними годинник відставав на 1 хвилину через 4.5 днів), далі їх уточнює
+// калібровка
+#define DRIFT_DAY_PPB 2181676
+#define DRIFT_NIGHT_PPB 2681676
+
+// Температура вершини параболи кварцу, °C
+#define DRIFT_TURNOVER_C 25.0f
+
+// Кімнатна температура, при якій знайдені початкові поправки, °C
+#define DRIFT_ROOM_C 22.0f
+
+// Невідомі: поправка вдень, вночі (ppb) та квадратичний коефіцієнт
+// (ppb/°C^2)
+#define DRIFT_PARAMS 3
+
+// Виправлення після меншого проміжку не дає рівняння: похибка встановлення
+// (до секунди) на ньому більша за сам дрифт. Годинник просто
+// синхронізується знову
+#define DRIFT_MIN_INTERVAL_S (24 * 3600.0)
+
+// Виправлення, більше за цю частку проміжку (ppm), - не дрифт, а переведення
+// годинника (часовий пояс, літній час) або перше встановлення
+#define DRIFT_MAX_PPM 500.0
+
+// Вага старих рівнянь після кожного нового
+#define DRIFT_FORGET 0.9
+
+// Сила регуляризації: скільки секунд^2 "спостережень" мають заводські
+// значення (пів доби для поправок, пів доби при 20 °C від вершини для
+// коефіцієнта). Коефіцієнт видно тільки з проміжків при різній
+// температурі: добові та сезонні зміни кімнати на кілька градусів
+// змінюють хід на сотні ppb, менше за похибку встановлення часу до
+// секунди, і тоді коефіцієнт має лишатися біля нуля. Після тижнів в
+// кімнаті на 8 °C холоднішій він знаходиться (DriftSimulation.h)
+#define DRIFT_PRIOR_S2 (43200.0 * 43200.0)
+#define DRIFT_PRIOR_Q2 (43200.0 * 400.0 * 43200.0 * 400.0)
+
+// Результат калібровки (зберігається у флеш разом з налаштуваннями)
+struct DriftFit
+{
+    double ppb[DRIFT_PARAMS];               // Поточний розв'язок
+    double xtx[DRIFT_PARAMS][DRIFT_PARAMS]; // Нормальні рівняння
+    double xty[DRIFT_PARAMS];
+    uint16_t samples;                       // Кількість рівнянь
+};
+
+class DriftCalibrator
+{
+private:
+    DriftFit fit = {{DRIFT_DAY_PPB, DRIFT_NIGHT_PPB, 0}, {}, {}, 0};
+
+    float celsius = DRIFT_ROOM_C; // Остання температура
+    bool synced = false;          // Чи встановлював користувач час
+
+    // Проміжок з останнього встановлення часу
+    double x[DRIFT_PARAMS] = {0, 0, 0}; // Секунди вдень, вночі, °C^2·с
+    double appliedNs = 0;               // Вже додана поправка, нс
+
+    // Розв'язати нормальні рівняння з регуляризацією
+    void solve();
+
+public:
+    // Поправка для режиму (night - режим сну) при поточній температурі
+    int32_t getPpb(bool night);
+
+    // Поправка для просування годинника на deltaUs мікросекунд. Проміжок
+    // враховується в поточному рівнянні
+    int32_t correction(uint64_t deltaUs, bool night);
+
+    // Нове вимірювання температури
+    void setTemperature(float celsius);
+
+    // Користувач встановив час, і годинник пішов на errorUs мікросекунд
+    // (встановлений мінус показаний). Повертає true, якщо з виправлення
+    // вийшло нове рівняння і калібровка оновилась
+    bool userCorrection(int64_t errorUs);
+
+    // Годинник встановлений не користувачем (після втрати живлення час
+    // відновлюється з флешу, і його похибка невідома)
+    void desync();
+
+    // Збереження та відновлення результату
+    const DriftFit &getFit();
+    void restore(const DriftFit &fit);
+
+    uint16_t getSamples();
+};
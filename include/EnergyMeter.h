@@ -0,0 +1,106 @@
+// Облік енергії по підсистемах.
+//
+// Лічильники дешеві (кілька додавань за пробудження) і живуть в RTC пам'яті,
+// тому переживають глибокий сон. З них за моделлю струмів нижче рахується
+// приблизне споживання в мА·год на добу для кожної підсистеми.
+#pragma once
+
+#include <Arduino.h>
+#include <esp_sleep.h>
+
+// Модель струмів (мА), підібрана під ESP32-C3 на 10 МГц, дві SSD1306 з
+// мінімальною яскравістю та BMP280. Змінюйте під свої вимірювання.
+#define CURRENT_CPU_AWAKE_MA 5.0   // CPU працює
+#define CURRENT_CPU_BOOST_MA 8.0   // Додатково до CPU на 80 МГц (PowerGovernor.h)
+#define CURRENT_CPU_SLEEP_MA 0.25  // Легкий сон
+#define CURRENT_CPU_DEEP_MA 0.005  // Глибокий сон (працює тільки RTC)
+#define CURRENT_OLED_IDLE_MA 0.8   // Одна ввімкнена панель без світних пікселів
+#define CURRENT_I2C_MA 1.0         // Додатково до CPU під час передачі по I2C
+#define CURRENT_PIEZO_MA 12.0      // Пієзодинамік звучить
+#define CURRENT_BASELINE_MA 0.21   // Дільник напруги батареї, LDO, сон датчика
+
+// Струм одного світного пікселя (мкА): на контрасті 0 та додатково за
+// кожен крок контрасту (на 255 вся панель - близько 20 мА)
+#define CURRENT_OLED_PIXEL_UA 0.3
+#define CURRENT_OLED_CONTRAST_UA 0.008
+
+// Заряд одного вимірювання (мкА·с)
+#define CHARGE_TEMPERATURE_READ_UAS 50.0 // Перетворення BMP280 (шина рахується в i2c)
+#define CHARGE_BATTERY_READ_UAS 0.5      // Перетворення АЦП
+
+// Оцінка споживання в мА·год на добу по підсистемах
+struct EnergyEstimate
+{
+    float cpu;
+    float sleep;
+    float oled;
+    float i2c;
+    float temperature;
+    float battery;
+    float piezo;
+    float baseline;
+    float total;
+};
+
+class EnergyMeter
+{
+private:
+    // Пробудження за причиною
+    uint32_t timerWakes = 0;
+    uint32_t gpioWakes = 0;
+    uint32_t otherWakes = 0;
+
+    uint64_t totalUs = 0;      // Весь час обліку
+    uint64_t awakeUs = 0;      // Час роботи CPU
+    uint64_t deepSleepUs = 0;  // Час в глибокому сні
+    uint64_t displayOnUs = 0;  // Час, коли дисплеї світились
+    uint64_t piezoOnUs = 0;    // Час, коли звучав пієзодинамік
+    uint64_t i2cUs = 0;        // Час передач по I2C (виміряний, I2CBus.h)
+    uint64_t boostUs = 0;      // Час на найбільшій частоті CPU
+
+    uint64_t oledBytes[2] = {0, 0}; // Байти, відправлені на кожен дисплей
+    uint16_t oledPixels[2] = {0, 0}; // Світні пікселі на кожному дисплеї
+    uint8_t oledContrast = 0;        // Контраст дисплеїв
+    float oledPixelsUa = 0;          // Струм світних пікселів обох дисплеїв
+    double oledPixelsUas = 0;        // Заряд світних пікселів (мкА·с)
+    uint32_t temperatureReads = 0;  // Виклики bmp.readTemperature()
+    uint32_t batteryReads = 0;      // Читання АЦП батареї
+
+    bool displayOn = false;
+    uint32_t markUs = 0;  // micros() останнього обліку часу
+    uint32_t wakeUs = 0;  // micros() останнього пробудження
+
+    // Додати час з останнього обліку до лічильників станів
+    void accumulate();
+
+public:
+    // Початок обліку після старту чипа (micros() почався з нуля)
+    void boot();
+
+    // Пробудження з легкого сну та перехід в сон
+    void wake(esp_sleep_wakeup_cause_t cause);
+    void sleep();
+
+    // Старт після глибокого сну, який тривав sleptUs (micros() під час
+    // нього не йде, тому тривалість рахується за RTC таймером)
+    void resume(uint64_t sleptUs);
+
+    void setDisplayOn(bool on);
+    // Світні пікселі на дисплеї panel та контраст (однаковий на обох)
+    void setOledLoad(int panel, uint16_t litPixels, uint8_t contrast);
+    // Час, коли звучав пієзодинамік (рахує MelodyPlayer)
+    void countPiezoUs(uint32_t us);
+    void countOledBytes(int panel, uint32_t bytes);
+    void countI2CUs(uint32_t us);
+    void countBoostUs(uint32_t us);
+    void countTemperatureRead();
+    void countBatteryRead(uint32_t samples = 1);
+
+    // Скинути всі лічильники
+    void reset();
+
+    EnergyEstimate estimate();
+
+    // Вивід лічильників та оцінки (наприклад, в Serial)
+    void print(Print &out);
+};
@@ -0,0 +1,26 @@
+// Форматування чисел для екранів без String.
+//
+// Всі функції пишуть в буфер, який передає викликач (зазвичай масив на
+// стеку), завершують рядок нулем і повертають вказівник на цей нуль, тому
+// поля можна дописувати одне за одним. Куча не використовується зовсім.
+#pragma once
+
+#include <stdint.h>
+
+// Розміри буферів разом з нульовим символом
+#define FORMAT_HOURS_MINUTES_SIZE 6 // HH:MM
+#define FORMAT_TIME_SIZE 9          // HH:MM:SS
+#define FORMAT_DATE_SIZE 11         // DD.MM.YYYY
+#define FORMAT_TEMPERATURE_SIZE 8   // -40.0
+
+// Число рівно з digits цифр, доповнене зліва символом pad ('0' або ' ').
+// Від'ємні числа пишуться як 0, а зайві старші цифри відкидаються.
+char *formatNumber(char *out, int32_t value, uint8_t digits, char pad = '0');
+
+char *formatHoursMinutes(char *out, int hours, int minutes);
+char *formatTime(char *out, int hours, int minutes, int seconds);
+char *formatDate(char *out, int date, int month, int year);
+
+// Температура з одним знаком після коми (як String(t) без останньої цифри),
+// "--.-" для NAN та значень від 10000 за модулем
+char *formatTemperature(char *out, float celsius);
@@ -0,0 +1,42 @@
+// Шина I2C панелей та датчика температури.
+//
+// SSD1306 та BMP280 обидва працюють в fast mode, тому вся шина весь час
+// на 400 кГц. Раніше на 400 кГц йшли тільки кадри, а команди та датчик - на
+// 100 кГц, і кожен setClock() заново налаштовував контролер I2C.
+//
+// Час передач вимірюється (I2CTiming): скільки їх було, скільки часу вони
+// зайняли разом та найдовша з них. Передача по Wire блокуюча, тому це і є
+// час, який CPU чекав на шину.
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define I2C_SDA_PIN 8
+#define I2C_SCL_PIN 10
+
+// Найвища частота, яку підтримують всі пристрої на шині (SSD1306 - 400 кГц)
+#define I2C_BUS_CLOCK 400000
+
+class I2CTiming
+{
+private:
+    uint32_t transactions = 0;
+    uint64_t totalUs = 0;
+    uint32_t maxUs = 0;
+    uint32_t untakenUs = 0; // Ще не забраний take()
+
+public:
+    // Передача (або операція з кількох передач), яка почалась в started
+    // (micros())
+    void count(uint32_t started);
+
+    // Час на шині з попереднього виклику, мкс
+    uint32_t take();
+
+    // Вивід лічильників (наприклад, в Serial)
+    void print(Print &out, const char *name);
+};
+
+// endTransmission() з вимірюванням часу передачі
+uint8_t timedEndTransmission(TwoWire *wire, I2CTiming *timing);
@@ -0,0 +1,68 @@
+// Черга фронтів кнопок від переривань до loop().
+//
+// Переривання (єдиний виробник) записує фронт з часом, коли він стався, а
+// loop() (єдиний споживач) забирає їх по черзі. Кожен індекс змінює тільки
+// одна сторона, тому блокування не потрібні: достатньо, щоб запис елемента
+// був видимий раніше за зсув індексу (release\acquire).
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdint.h>
+
+// Розмір черги (степінь двійки). Брязкіт однієї кнопки дає кілька фронтів,
+// тому запас великий.
+#define INPUT_QUEUE_SIZE 32
+
+// Зміна рівня на порту кнопки
+struct InputEdge
+{
+    uint8_t pin;
+    uint8_t level;
+    uint32_t timeMs; // millis() в момент переривання
+};
+
+class InputQueue
+{
+private:
+    InputEdge edges[INPUT_QUEUE_SIZE];
+    std::atomic<uint8_t> head{0}; // Куди пише переривання
+    std::atomic<uint8_t> tail{0}; // Звідки читає loop()
+    std::atomic<uint8_t> dropped{0};
+
+public:
+    // З переривання (тому теж в IRAM). Якщо черга повна, фронт відкидається
+    bool IRAM_ATTR push(const InputEdge &edge)
+    {
+        uint8_t h = head.load(std::memory_order_relaxed);
+        uint8_t next = (h + 1) & (INPUT_QUEUE_SIZE - 1);
+        if (next == tail.load(std::memory_order_acquire))
+        {
+            // Лічильник теж змінює тільки переривання
+            dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        edges[h] = edge;
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // З loop()
+    bool pop(InputEdge &edge)
+    {
+        uint8_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return false;
+
+        edge = edges[t];
+        tail.store((t + 1) & (INPUT_QUEUE_SIZE - 1), std::memory_order_release);
+        return true;
+    }
+
+    // Скільки фронтів не влізло в чергу
+    uint8_t getDropped()
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+};
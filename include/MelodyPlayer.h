@@ -0,0 +1,156 @@
+// Мелодії будильника на апаратному ШІМ (LEDC).
+//
+// Мелодія записується нотами (частота, тривалість, гучність), і компілятор
+// ще під час збірки перетворює їх в кроки LEDC: частота таймера, шпаринність
+// каналу та тривалість кроку в мікросекундах (сусідні паузи зливаються).
+// Під час гри кроки перемикає одноразовий esp_timer, а не loop(), тому ритм
+// не залежить від того, що робить решта прошивки.
+//
+// LEDC працює від генератора RTC8M, який залишається ввімкненим в легкому сні,
+// тому нота звучить, поки чип спить. Але esp_timer сон не перериває, тому
+// прошивка будить чип трохи раніше кожної зміни (nextWakeUs()), і обробник
+// таймера перемикає крок вчасно.
+//
+// Гучність мелодії може наростати: на першому повторі шпаринність кожного
+// кроку множиться на rampStart / 256 і рівномірно росте до повної за
+// rampLoops повторів.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <driver/ledc.h>
+#include <esp_timer.h>
+
+// Найбільше кроків в одній мелодії
+#define MELODY_MAX_STEPS 16
+
+// На скільки раніше зміни кроку будити чип, мкс. Не менше за час
+// пробудження з легкого сну, але менше за час одного пробудження, щоб зміна
+// кроку встигала за одне пробудження.
+#define MELODY_WAKE_LEAD_US 1000
+
+// Канал та таймер LEDC пієзодинаміка
+#define MELODY_LEDC_CHANNEL LEDC_CHANNEL_0
+#define MELODY_LEDC_TIMER LEDC_TIMER_0
+
+// Нота: частота (0 - пауза), тривалість та гучність (шпаринність з 255)
+struct Note
+{
+    uint16_t hz;
+    uint16_t ms;
+    uint8_t volume;
+};
+
+// Крок LEDC
+struct MelodyStep
+{
+    uint32_t us;  // Тривалість
+    uint16_t hz;  // Частота таймера (0 - пауза, частота не змінюється)
+    uint8_t duty; // Шпаринність з 255 (0 - тиша)
+};
+
+struct Melody
+{
+    const char *name; // Назва на екрані (до 5 літер)
+    MelodyStep steps[MELODY_MAX_STEPS];
+    uint8_t count;
+    uint8_t rampStart; // Гучність першого повтору (з 256)
+    uint8_t rampLoops; // За скільки повторів гучність стає повною (0 - одразу)
+};
+
+// Перетворити ноти в кроки LEDC
+template <size_t N>
+constexpr Melody compileMelody(const char *name, const Note (&notes)[N], uint8_t rampStart, uint8_t rampLoops)
+{
+    static_assert(N <= MELODY_MAX_STEPS, "melody is too long");
+
+    Melody melody = {name, {}, 0, rampStart, rampLoops};
+    for (size_t i = 0; i < N; i++)
+    {
+        uint8_t duty = notes[i].hz ? notes[i].volume : 0;
+        uint16_t hz = duty ? notes[i].hz : 0;
+        uint32_t us = notes[i].ms * 1000UL;
+
+        MelodyStep *last = melody.count ? &melody.steps[melody.count - 1] : nullptr;
+        if (last && last->duty == duty && last->hz == hz)
+            last->us += us;
+        else
+            melody.steps[melody.count++] = {us, hz, duty};
+    }
+    return melody;
+}
+
+// Тривалість одного повтору мелодії, мкс
+constexpr uint32_t melodyLength(const Melody &melody)
+{
+    uint32_t us = 0;
+    for (int i = 0; i < melody.count; i++)
+        us += melody.steps[i].us;
+    return us;
+}
+
+// Шпаринність кроку на повторі loop з наростанням гучності
+constexpr uint8_t melodyDuty(const Melody &melody, const MelodyStep &step, uint32_t loop)
+{
+    uint32_t gain = melody.rampLoops && loop < melody.rampLoops
+                        ? melody.rampStart + (256 - melody.rampStart) * loop / melody.rampLoops
+                        : 256;
+    return step.duty * gain >> 8;
+}
+
+// Мелодії будильника (номер - поле melody в Alarm)
+constexpr Note BEEP_NOTES[] = {{1000, 250, 150}, {0, 250, 0}};
+constexpr Note CHIRP_NOTES[] = {{2000, 80, 150}, {0, 40, 0}, {2000, 80, 150}, {0, 40, 0}, {2000, 80, 150}, {0, 680, 0}};
+constexpr Note RISE_NOTES[] = {{523, 150, 150}, {659, 150, 150}, {784, 150, 150}, {1047, 300, 150}, {0, 450, 0}};
+
+constexpr Melody MELODIES[] = {
+    compileMelody("BEEP", BEEP_NOTES, 0, 0),
+    compileMelody("CHIRP", CHIRP_NOTES, 64, 8),
+    compileMelody("RISE", RISE_NOTES, 64, 8),
+};
+constexpr int MELODY_COUNT = sizeof(MELODIES) / sizeof(MELODIES[0]);
+
+static_assert(MELODIES[0].count == 2 && melodyLength(MELODIES[0]) == 500000, "beep keeps the old 250 ms rhythm");
+static_assert(melodyLength(MELODIES[1]) == 1000000 && melodyLength(MELODIES[2]) == 1200000, "melody length");
+static_assert(melodyDuty(MELODIES[1], MELODIES[1].steps[0], 0) == 37 &&
+                  melodyDuty(MELODIES[1], MELODIES[1].steps[0], 8) == 150,
+              "volume ramp");
+
+class MelodyPlayer
+{
+private:
+    esp_timer_handle_t timer = nullptr;
+    const Melody *melody = nullptr;
+
+    // Крок, який зараз звучить, номер повтору та момент наступної зміни
+    // (esp_timer_get_time()). Змінюються обробником таймера.
+    volatile uint8_t step = 0;
+    volatile uint32_t loop = 0;
+    volatile int64_t nextChangeAt = 0;
+    volatile bool playing = false;
+
+    // Час, коли динамік звучав, ще не забраний takeSoundingUs()
+    std::atomic<uint32_t> soundingUs{0};
+
+    static void onTimer(void *arg);
+
+    // Вивести крок step на LEDC і запланувати наступну зміну на at
+    void apply(int64_t at);
+
+public:
+    // Налаштувати LEDC на піні динаміка та створити таймер
+    void begin(uint8_t pin);
+
+    // Грати мелодію по колу з першого кроку
+    void play(const Melody &melody);
+    void stop();
+    bool isPlaying();
+
+    // Через скільки мкс будити чип перед наступною зміною кроку (UINT64_MAX
+    // - мелодія не грає)
+    uint64_t nextWakeUs();
+
+    // Час, коли динамік звучав, з попереднього виклику, мкс
+    uint32_t takeSoundingUs();
+};
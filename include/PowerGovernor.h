@@ -0,0 +1,64 @@
+// Керування частотою CPU та легким сном.
+//
+// Прошивка не викликає сон сама: вона бере блокування на час роботи, яка
+// їх потребує, а в кінці loop() чекає наступної події (idle()). Поки взяте
+// POWER_LOCK_CPU_MAX, CPU працює на POWER_MAX_FREQ_MHZ (навігація по меню,
+// повний перемальований кадр), інакше - на POWER_MIN_FREQ_MHZ.
+// POWER_LOCK_NO_SLEEP не дає заснути посеред роботи з периферією.
+//
+// Якщо ESP-IDF зібраний з CONFIG_PM_ENABLE, частоту та легкий сон веде
+// esp_pm: блокування - це блокування esp_pm, а idle() блокує задачу, і чип
+// засинає сам, коли всі задачі чекають, до найближчого таймера (включно з
+// esp_timer мелодії) або кнопки. В Arduino-ESP32 esp_pm вимкнений
+// (esp_pm_configure() повертає ESP_ERR_NOT_SUPPORTED), тому те саме робиться
+// вручну: setCpuFrequencyMhz() на першому та останньому блокуванні частоти і
+// esp_light_sleep_start() в idle(). I2C працює від XTAL, а LEDC - від RTC8M,
+// тому зміна частоти не змінює ні швидкість шини, ні ноти.
+#pragma once
+
+#include <Arduino.h>
+#include <esp_pm.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define POWER_MAX_FREQ_MHZ 80
+#define POWER_MIN_FREQ_MHZ 10 // Як board_build.f_cpu
+
+enum PowerLock
+{
+    POWER_LOCK_CPU_MAX,  // Найбільша частота CPU
+    POWER_LOCK_NO_SLEEP, // Без легкого сну
+    POWER_LOCK_COUNT
+};
+
+class PowerGovernor
+{
+private:
+    bool automatic = false; // esp_pm налаштований
+    esp_pm_lock_handle_t locks[POWER_LOCK_COUNT] = {};
+    uint8_t counts[POWER_LOCK_COUNT] = {};
+    TaskHandle_t task = nullptr; // Задача, яка чекає в idle()
+
+    // Час на найбільшій частоті, ще не забраний takeBoostUs(), та початок
+    // поточного блокування частоти (micros())
+    uint32_t boostUs = 0;
+    uint32_t boostSince = 0;
+
+public:
+    // Налаштувати esp_pm (або ручний режим, якщо він не підтримується).
+    // Викликається з задачі, яка буде чекати в idle()
+    void begin();
+    bool isAutomatic();
+
+    // Блокування рахуються: кожен acquire() потребує свого release()
+    void acquire(PowerLock lock);
+    void release(PowerLock lock);
+
+    // Чекати us мкс або до wakeFromISR() (з будь-якого переривання, яке
+    // будить чип)
+    void idle(uint64_t us);
+    void IRAM_ATTR wakeFromISR();
+
+    // Час на найбільшій частоті з попереднього виклику, мкс
+    uint32_t takeBoostUs();
+};
@@ -0,0 +1,103 @@
+// Опис екранів налаштувань.
+//
+// Кожен екран меню - рядок таблиці: назва в списку, заголовок, поля та чи
+// змінюють вони збережені налаштування. Кожне поле описує свою змінну,
+// межі, чи значення ходить по колу, та де воно на екрані. Кнопки та
+// відмальовка йдуть через один загальний код, тому новий екран або поле - це
+// тільки рядок в таблиці, а вибір поля - індекс, а не ланцюжок порівнянь.
+#pragma once
+
+#include <stdint.h>
+
+enum MenuFieldType
+{
+    FIELD_NUMBER, // Число з цифрами та стрілками над і під ним
+    FIELD_TOGGLE, // Ввімкнено/вимкнено
+    FIELD_CHOICE, // Одне зі значень min-max з назвою (label)
+    FIELD_BIT     // Один біт змінної (літера label або крапка)
+};
+
+struct MenuField
+{
+    uint8_t type; // MenuFieldType
+    int *value;   // FIELD_NUMBER, FIELD_CHOICE, FIELD_BIT
+    bool *flag;   // FIELD_TOGGLE
+
+    // Межі значення (FIELD_BIT: min - номер біта) і чи воно ходить по колу
+    // (інакше зупиняється на межі). limit, якщо є, замінює max, коли межа
+    // залежить від інших полів (днів в місяці)
+    int16_t min, max;
+    bool wrap;
+    int (*limit)();
+
+    // Місце значення на правому екрані. FIELD_NUMBER: кількість цифр та x
+    // стрілок вибраного поля
+    uint8_t x, y;
+    uint8_t digits;
+    uint8_t arrowX;
+
+    // Текст значення (FIELD_CHOICE) або біта (FIELD_BIT)
+    const char *(*label)(int value);
+
+    // Викликається після зміни кнопкою
+    void (*changed)();
+};
+
+// Незмінний текст на правому екрані (наприклад, ":" між полями часу)
+struct MenuLabel
+{
+    const char *text;
+    uint8_t x, y;
+};
+
+struct MenuScreen
+{
+    const char *name;  // В списку меню
+    const char *title; // Заголовок на лівому екрані
+    uint8_t titleX;
+
+    const MenuField *fields;
+    uint8_t fieldCount;
+    const MenuLabel *labels;
+    uint8_t labelCount;
+
+    // Чи змінюють поля налаштування, які зберігаються у флеш
+    bool saved;
+
+    // Кожен кадр, поки екран відкритий (після обробки кнопок)
+    void (*update)();
+    // Свій вміст правого екрану замість полів
+    void (*draw)();
+};
+
+// Рядок таблиці для кожного типу поля
+constexpr MenuField numberField(int *value, int min, int max, bool wrap, uint8_t x, uint8_t digits, uint8_t arrowX,
+                                int (*limit)() = nullptr)
+{
+    return {FIELD_NUMBER, value, nullptr, (int16_t)min, (int16_t)max, wrap, limit, x, 26, digits, arrowX, nullptr, nullptr};
+}
+
+constexpr MenuField toggleField(bool *flag, uint8_t x, uint8_t y)
+{
+    return {FIELD_TOGGLE, nullptr, flag, 0, 1, true, nullptr, x, y, 0, 0, nullptr, nullptr};
+}
+
+constexpr MenuField choiceField(int *value, int count, uint8_t x, uint8_t y, const char *(*label)(int),
+                                void (*changed)() = nullptr)
+{
+    return {FIELD_CHOICE, value, nullptr, 0, (int16_t)(count - 1), true, nullptr, x, y, 0, 0, label, changed};
+}
+
+constexpr MenuField bitField(int *value, int bit, uint8_t x, uint8_t y, const char *(*label)(int))
+{
+    return {FIELD_BIT, value, nullptr, (int16_t)bit, (int16_t)bit, false, nullptr, x, y, 0, 0, label, nullptr};
+}
+
+template <typename T, int N>
+constexpr uint8_t menuCount(const T (&)[N])
+{
+    return N;
+}
+
+// Змінити поле кнопкою: delta - +1 (UP) або -1 (DOWN)
+void stepMenuField(const MenuField &field, int delta);
@@ -0,0 +1,80 @@
+// Збереження налаштувань у флеш (NVS через Preferences).
+//
+// Всі налаштування - один запис з версією, який читається при старті одним
+// getBytes() і записується цілим, тому для змін досить одного прапорця
+// (які саме поля змінились, неважливо). Запис робиться тільки після виходу
+// з екрану налаштувань і не частіше ніж раз на SETTINGS_COMMIT_INTERVAL:
+// кілька налаштувань підряд дають один запис, а вихід без змін не дає
+// жодного.
+#pragma once
+
+#include "AlarmEngine.h"
+#include "DriftCalibrator.h"
+
+#include <Preferences.h>
+#include <stdint.h>
+
+// Версія запису. Запис іншої версії (або розміру) ігнорується, і годинник
+// стартує з налаштуваннями за замовчуванням.
+#define SETTINGS_VERSION 5
+
+#define SETTINGS_NAMESPACE "clock"
+#define SETTINGS_KEY "settings"
+
+// Найменший проміжок між записами у флеш, мс
+#define SETTINGS_COMMIT_INTERVAL 60000
+
+struct Settings
+{
+    uint16_t version;
+
+    Alarm alarms[ALARM_SLOTS];
+
+    uint8_t sleepOn;
+    uint8_t sleepStart[3]; // Години, хвилини, секунди
+    uint8_t sleepEnd[3];
+
+    uint8_t displaySeconds;
+
+    uint8_t date, month;
+    uint16_t year;
+    uint8_t clockTime[3];
+
+    DriftFit drift;
+};
+
+class SettingsStore
+{
+private:
+    Preferences preferences;
+
+    bool dirty = false;       // Чи змінювались налаштування після запису
+    bool queued = false;      // Чи запитаний запис (вихід з налаштувань)
+    bool committed = false;   // Чи був запис після старту
+    uint32_t lastCommit = 0;  // millis() останнього запису
+    uint32_t commits = 0;     // Кількість записів після старту
+
+public:
+    // Прочитати запис. Повертає false, якщо його немає або він іншої версії
+    bool load(Settings &settings);
+
+    // Налаштування змінились
+    void mark();
+
+    // Запитати запис змін (при виході з налаштувань)
+    void queue();
+
+    // Чи чекає запис на виконання
+    bool pending();
+
+    // Записати settings, якщо запис запитаний, є зміни і з минулого
+    // запису пройшло SETTINGS_COMMIT_INTERVAL (force - не чекати).
+    // Повертає true, якщо запис зроблено
+    bool commit(uint32_t now, const Settings &settings, bool force = false);
+
+    // Через скільки мілісекунд можна буде зробити запитаний запис
+    // (UINT32_MAX - запису не чекає)
+    uint32_t nextCommitMs(uint32_t now);
+
+    uint32_t getCommits();
+};
@@ -0,0 +1,75 @@
+// Тіньовий фреймбуфер для SSD1306.
+//
+// Бібліотека Adafruit при кожному display() відправляє весь буфер (1024 байти)
+// по I2C, навіть якщо на екрані нічого не змінилось. Цей клас пам'ятає, що
+// вже є в пам'яті панелі, порівнює з ним кожну сторінку (8 рядків пікселів)
+// і відправляє лише ті відрізки колонок, що змінились, виставляючи для них
+// вікно адрес колонок\сторінок контролера. Заодно він рахує світні пікселі
+// на панелі (по змінених байтах), з яких рахується струм панелі.
+#pragma once
+
+#include <Adafruit_SSD1306.h>
+#include <Wire.h>
+
+#include "I2CBus.h"
+
+#define OLED_WIDTH 128
+#define OLED_HEIGHT 64
+#define OLED_PAGES (OLED_HEIGHT / 8)
+#define OLED_BUFFER_SIZE (OLED_WIDTH * OLED_PAGES)
+
+// Максимальний розмір однієї передачі по I2C (разом з контрольним байтом)
+#ifdef I2C_BUFFER_LENGTH
+#define OLED_I2C_CHUNK I2C_BUFFER_LENGTH
+#else
+#define OLED_I2C_CHUNK 32
+#endif
+
+// Якщо між двома зміненими відрізками на сторінці менше ніж стільки
+// однакових байтів, то вигідніше відправити їх разом, ніж ще раз
+// налаштовувати вікно (7 байт команд + адреса + контрольний байт)
+#define OLED_RUN_MERGE_GAP 9
+
+// Копія пам'яті панелі. Окремо від класу (без конструктора), щоб її можна
+// було тримати в RTC пам'яті: панель не втрачає вміст, поки чип в глибокому
+// сні, і після пробудження копія все ще правильна.
+struct ShadowMemory
+{
+    uint8_t data[OLED_BUFFER_SIZE]; // Те, що зараз знаходиться в пам'яті панелі
+    bool valid;                     // Чи відповідає копія пам'яті панелі
+    uint16_t lit;                   // Світні пікселі в копії
+};
+
+class ShadowDisplay
+{
+private:
+    Adafruit_SSD1306 *display; // Екран, з буфера якого беремо кадр
+    TwoWire *wire;             // Шина, на якій висить екран
+    uint8_t address;           // I2C адреса екрану
+    I2CTiming *timing;         // Куди записується час кожної передачі
+
+    ShadowMemory *shadow; // Те, що зараз знаходиться в пам'яті панелі
+
+    uint32_t bytesSent = 0; // Скільки байтів відправлено по I2C за весь час
+
+    // Відправка відрізку колонок first..last однієї сторінки
+    uint16_t sendRun(uint8_t page, uint8_t first, uint8_t last, const uint8_t *data);
+
+public:
+    // Конструктор. Приймає екран, шину, адресу екрану на шині, пам'ять
+    // для копії вмісту панелі та лічильник часу передач
+    ShadowDisplay(Adafruit_SSD1306 *display, TwoWire *wire, uint8_t address, ShadowMemory *shadow, I2CTiming *timing);
+
+    // Забути вміст панелі (наступний flush() відправить весь кадр).
+    // Потрібно після begin() або якщо панель могла втратити пам'ять.
+    void invalidate();
+
+    // Відправка на панель тільки змінених частин кадру.
+    // Повертає кількість байтів, відправлених по I2C.
+    uint16_t flush();
+
+    uint32_t getBytesSent();
+
+    // Скільки пікселів світиться на панелі після останнього flush()
+    uint16_t getLitPixels();
+};
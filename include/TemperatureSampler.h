@@ -0,0 +1,75 @@
+// Вимірювання температури BMP280 в примусовому режимі.
+//
+// Датчик спить між вимірюваннями. Перетворення запускається перед сном на
+// останньому пробудженні перед тим, як потрібне нове значення, а на
+// наступному пробудженні готовий результат зчитується без очікування.
+// Значення оновлюється приблизно раз на період (± чверть періоду), щоб
+// вимірювання йшли разом з пробудженнями, які вже заплановані (зміна
+// хвилини, батарея тощо), і окремих пробуджень для датчика майже не було.
+// Результат зберігається вже відформатованим, і екран просто друкує
+// готовий рядок.
+#pragma once
+
+#include <Adafruit_BMP280.h>
+
+#include "Format.h"
+#include "I2CBus.h"
+
+// Найдовше перетворення (передискретизація x16 триває до ~40 мс), мс
+#define TEMPERATURE_CONVERSION_MS 50
+
+// Якщо результат ще не готовий, перевіряємо знову через стільки мілісекунд
+#define TEMPERATURE_RETRY_MS 5
+
+// Біт "йде перетворення" в регістрі статусу BMP280
+#define BMP280_STATUS_MEASURING 0x08
+
+class TemperatureSampler
+{
+private:
+    Adafruit_BMP280 *bmp;
+    I2CTiming *timing; // Час кожної операції з датчиком на шині
+
+    uint32_t period = 30000;    // Як часто оновлювати значення (мс)
+    uint32_t lastSample = 0;    // millis() останнього результату
+    uint32_t triggeredAt = 0;   // millis() запуску перетворення
+    bool measuring = false;     // Чи чекаємо на результат
+
+    float celsius = NAN;
+    char text[FORMAT_TEMPERATURE_SIZE] = "";
+
+    // Запустити одне перетворення
+    void trigger();
+    // Прочитати результат перетворення
+    float read();
+    // Регістр статусу датчика
+    uint8_t status();
+    void publish(float value, uint32_t now);
+
+public:
+    TemperatureSampler(Adafruit_BMP280 *bmp, I2CTiming *timing);
+
+    // Налаштувати датчик на примусовий режим і отримати перше значення
+    // (один раз чекає на перетворення)
+    void begin(uint32_t now);
+
+    // Те саме без очікування: поки йде перетворення, показується останнє
+    // відоме значення cached (наприклад, збережене перед глибоким сном)
+    void resume(uint32_t now, float cached);
+
+    // Частота оновлення для поточного стану (наприклад, рідше в режимі сну)
+    void setPeriod(uint32_t periodMs);
+
+    // Зчитати результат, якщо перетворення вже завершилось.
+    // Повертає true, якщо з'явилось нове значення
+    bool update(uint32_t now);
+
+    // Перед сном: plannedUs - скільки чип спатиме через інші події.
+    // Повертає, скільки спати з урахуванням датчика (не більше plannedUs),
+    // і запускає перетворення, якщо на наступному пробудженні вже потрібне
+    // нове значення
+    uint64_t schedule(uint32_t now, uint64_t plannedUs);
+
+    float getCelsius();
+    const char *getText();
+};
@@ -0,0 +1,102 @@
+// Журнал подій в RTC пам'яті.
+//
+// Кільцевий буфер записує, що відбувалось з годинником: старт і причину
+// пробудження, зміни режиму та режиму сну, фронти кнопок, будильник,
+// температуру та заряд. Запис - байт заголовка (тип в молодших 4 бітах,
+// маленьке значення 0-14 в старших, 15 - значення окремо) та час від
+// попереднього запису в мс (varint), тому більшість записів займає 2-3
+// байти, і кілька КБ вміщують дні роботи. Коли місця не вистачає, найстаріші
+// записи витісняються.
+//
+// Буфер в RTC_NOINIT пам'яті, тому переживає і глибокий сон, і
+// перезавантаження (наприклад, від watchdog). Після втрати живлення вміст
+// випадковий, і begin() його очищає. Клас не має ні конструктора, ні
+// ініціалізаторів полів: інакше старт програми обнулив би буфер.
+//
+// Журнал відправляється в Serial (dump()), а нативна збірка читає його
+// (load()) і відтворює фронти кнопок та датчики на справжньому loop().
+#pragma once
+
+#include <Arduino.h>
+
+#define TRACE_RING_BYTES 2048
+
+// Значення в заголовку (0-14) або окремим varint (TRACE_WIDE)
+#define TRACE_WIDE 15
+
+enum TraceEvent
+{
+    TRACE_BOOT,        // Старт прошивки (причина пробудження)
+    TRACE_WAKE,        // Пробудження не за таймером (причина)
+    TRACE_MODE,        // Новий режим (mode)
+    TRACE_BUTTON,      // Фронт кнопки (пін * 2 + рівень)
+    TRACE_SLEEPING,    // Режим сну почався (1) або закінчився (0)
+    TRACE_ALARM_START, // Будильник почав грати (номер)
+    TRACE_ALARM_STOP,  // Будильник зупинений (номер)
+    TRACE_TEMPERATURE, // Температура, десяті °C
+    TRACE_BATTERY,     // Напруга акумулятора, 10 мВ
+    TRACE_EVENT_COUNT
+};
+
+struct TraceRecord
+{
+    uint8_t type; // TraceEvent
+    int32_t value;
+    uint32_t timeMs; // Час RTC таймера (від ввімкнення живлення)
+};
+
+// Позиція читання (від найстарішого запису)
+struct TraceCursor
+{
+    uint16_t offset;
+    uint32_t timeMs;
+};
+
+class TraceRing
+{
+private:
+    uint32_t magic; // TRACE_MAGIC, якщо вміст дійсний
+    uint8_t bytes[TRACE_RING_BYTES];
+    uint16_t tail; // Початок найстарішого запису
+    uint16_t used; // Зайняті байти
+    uint32_t firstMs; // Час найстарішого запису
+    uint32_t lastMs;  // Час найновішого запису
+    uint32_t evicted; // Скільки записів витіснено
+    uint16_t loading; // Скільки байтів ще чекає load()
+
+    // Останні значення для recordChange() (біт в changed - значення є)
+    int32_t last[TRACE_EVENT_COUNT];
+    uint16_t changed;
+
+    uint8_t at(uint16_t offset);
+
+    // Розібрати запис на offset (від tail). Повертає його довжину
+    uint16_t decode(uint16_t offset, TraceRecord &record, uint32_t &deltaMs);
+    void evict();
+
+public:
+    // На кожному старті: очистити, якщо вміст недійсний (після втрати
+    // живлення)
+    void begin();
+    void clear();
+
+    // Записати подію в момент timeMs (час RTC таймера в мс)
+    void record(TraceEvent type, int32_t value, uint32_t timeMs);
+    // Записати, тільки якщо значення відрізняється від записаного раніше
+    void recordChange(TraceEvent type, int32_t value, uint32_t timeMs);
+
+    uint16_t size();
+    uint32_t getEvicted();
+
+    // Читання записів від найстарішого
+    void rewind(TraceCursor &cursor);
+    bool next(TraceCursor &cursor, TraceRecord &record);
+
+    // Вивід в текстовому вигляді (рядки "trace: ...", байти в hex) та
+    // читання такого виводу (рядок за рядком). load() повертає true, коли
+    // прочитаний весь журнал
+    void dump(Print &out);
+    bool load(const char *line);
+
+    static const char *eventName(uint8_t type);
+};
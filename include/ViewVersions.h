@@ -0,0 +1,75 @@
+// Версії того, що видно на екранах.
+//
+// Кожна частина стану, яку показує екран (час з точністю до того, що на
+// екрані, дата, температура, будильник, меню, поля налаштувань, заряд), має
+// лічильник, який збільшується, коли вона змінюється. Кадр пам'ятає версії
+// частин, з яких він намальований, і якщо жодна з них не змінилась, він не
+// перемальовується і не відправляється на панелі: більшість пробуджень
+// (секунди, яких не видно, датчик, кнопки без дії) нічого не змінюють.
+#pragma once
+
+#include <stdint.h>
+
+enum ViewPart
+{
+    VIEW_SCREEN,      // Який екран показаний
+    VIEW_TIME,        // Години та хвилини
+    VIEW_SECONDS,     // Секунди
+    VIEW_DATE,        // Дата
+    VIEW_TEMPERATURE, // Текст температури
+    VIEW_ALARM,       // Будильник, який грає
+    VIEW_MENU,        // Вибір в меню
+    VIEW_FIELD,       // Поля екрану налаштувань
+    VIEW_BATTERY,     // Заряд батареї
+    VIEW_DIM,         // Приглушений вигляд (ніч)
+    VIEW_PART_COUNT
+};
+
+#define VIEW_MASK(part) (1UL << (part))
+
+// Версії частин, з яких намальований кадр
+struct ViewStamp
+{
+    uint32_t parts; // Які частини показує кадр (0 - кадр ще не намальований)
+    uint16_t versions[VIEW_PART_COUNT];
+};
+
+class ViewVersions
+{
+private:
+    uint16_t versions[VIEW_PART_COUNT] = {};
+
+public:
+    void bump(ViewPart part)
+    {
+        versions[part]++;
+    }
+
+    // Присвоєння, яке збільшує версію, тільки якщо значення змінилось
+    template <typename T>
+    void set(T &value, T next, ViewPart part)
+    {
+        if (value != next)
+        {
+            value = next;
+            bump(part);
+        }
+    }
+
+    // Чи треба перемалювати кадр з частин parts, намальований з версій
+    // drawn. Якщо так, drawn стає поточними версіями.
+    bool changed(ViewStamp &drawn, uint32_t parts)
+    {
+        bool dirty = drawn.parts != parts;
+        for (int part = 0; part < VIEW_PART_COUNT; part++)
+        {
+            if ((parts & VIEW_MASK(part)) && drawn.versions[part] != versions[part])
+            {
+                drawn.versions[part] = versions[part];
+                dirty = true;
+            }
+        }
+        drawn.parts = parts;
+        return dirty;
+    }
+};
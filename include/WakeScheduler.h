@@ -0,0 +1,51 @@
+// Планувальник пробуджень.
+//
+// Замість того щоб прокидатись кожні 200 мс, кожна підсистема повідомляє,
+// через скільки часу їй потрібно наступне пробудження (зміна хвилини на
+// екрані, будильник, межі режиму сну, датчики тощо), і чип спить до
+// найближчої з цих подій. Натиски кнопок будять чип через GPIO.
+#pragma once
+
+#include <stdint.h>
+
+#include "ClockCore.h"
+
+// Прокидаємось трохи пізніше події, щоб вона гарантовано вже настала
+#define WAKE_MARGIN_US 1000
+
+// Найдовший сон, якщо жодна подія не запланована
+#define MAX_SLEEP_US (3600ULL * MICROS_PER_SECOND)
+
+class WakeScheduler
+{
+private:
+    uint64_t deadline = MAX_SLEEP_US; // Мікросекунд до найближчої події
+
+public:
+    // Початок планування наступного сну (limit - найдовший сон)
+    void reset(uint64_t limit = MAX_SLEEP_US)
+    {
+        deadline = limit;
+    }
+
+    // Подія через us мікросекунд millis()
+    void request(uint64_t us)
+    {
+        if (us < deadline)
+            deadline = us;
+    }
+
+    // Подія через clockUs мікросекунд годинника, який йде швидше за
+    // millis() на correctionPpb (див. ClockCore::advance)
+    void requestClock(uint64_t clockUs, int32_t correctionPpb)
+    {
+        uint64_t realUs = clockUs - (int64_t)clockUs * correctionPpb / (PPB + correctionPpb);
+        request(realUs + WAKE_MARGIN_US);
+    }
+
+    // Скільки спати до найближчої події
+    uint64_t get()
+    {
+        return deadline;
+    }
+};
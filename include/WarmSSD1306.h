@@ -0,0 +1,20 @@
+// SSD1306, який вміє продовжити роботу після глибокого сну чипа.
+//
+// Панелі живляться весь час, тому після пробудження з глибокого сну всі
+// їх налаштування (та вміст пам'яті) залишаються такими ж, як перед сном.
+// begin() в такому випадку тільки зайвий раз відправляє всю послідовність
+// ініціалізації (і вмикає панель, навіть якщо вона була погашена), тому
+// замість нього викликається resume(): він лише виділяє буфер кадру.
+#pragma once
+
+#include <Adafruit_SSD1306.h>
+
+class WarmSSD1306 : public Adafruit_SSD1306
+{
+public:
+    using Adafruit_SSD1306::Adafruit_SSD1306;
+
+    // Те саме, що begin(), але без жодної передачі на панель.
+    // Повертає false, якщо не вдалось виділити буфер.
+    bool resume(uint8_t switchvcc, uint8_t address);
+};
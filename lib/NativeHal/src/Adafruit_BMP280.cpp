@@ -0,0 +1,127 @@
+#include "Adafruit_BMP280.h"
+#include "NativeHal.h"
+
+#define BMP280_REGISTER_CHIPID 0xD0
+#define BMP280_REGISTER_STATUS 0xF3
+#define BMP280_REGISTER_CONTROL 0xF4
+#define BMP280_REGISTER_CONFIG 0xF5
+#define BMP280_REGISTER_TEMPDATA 0xFA
+#define BMP280_REGISTER_DIG_T1 0x88
+
+// Датчик на шині: відповідає ідентифікатором чипа, решта регістрів нулі
+class FakeBmpDevice : public I2CDevice
+{
+public:
+    uint8_t reg = 0;
+
+    void receive(const uint8_t *data, size_t length) override
+    {
+        if (length > 0)
+            reg = data[0];
+    }
+
+    size_t transmit(uint8_t *data, size_t length) override
+    {
+        for (size_t i = 0; i < length; i++)
+            data[i] = (reg == BMP280_REGISTER_CHIPID && i == 0) ? BMP280_CHIPID : 0;
+        return length;
+    }
+};
+
+static FakeBmpDevice device;
+
+Adafruit_BMP280::Adafruit_BMP280(TwoWire *theWire) : wire(theWire)
+{
+}
+
+void Adafruit_BMP280::writeRegister(uint8_t reg, uint8_t value)
+{
+    wire->beginTransmission(address);
+    wire->write(reg);
+    wire->write(value);
+    wire->endTransmission();
+}
+
+void Adafruit_BMP280::readRegisters(uint8_t reg, uint8_t count)
+{
+    wire->beginTransmission(address);
+    wire->write(reg);
+    wire->endTransmission();
+    wire->requestFrom(address, count);
+    while (wire->available())
+        wire->read();
+}
+
+uint32_t Adafruit_BMP280::conversionUs()
+{
+    // Типовий час перетворення з datasheet: 1 мс + 2 мс на кожен семпл
+    static const uint8_t samples[] = {0, 1, 2, 4, 8, 16};
+    return 1000 + 2000 * samples[tempSampling];
+}
+
+void Adafruit_BMP280::latch()
+{
+    if (mode == MODE_NORMAL || (measuringUntil != 0 && hal::nowUs() >= measuringUntil))
+    {
+        latched = hal::getTemperature();
+        if (mode != MODE_NORMAL)
+            measuringUntil = 0;
+    }
+}
+
+bool Adafruit_BMP280::begin(uint8_t addr, uint8_t chipid)
+{
+    address = addr;
+    wire->attach(addr, &device);
+
+    readRegisters(BMP280_REGISTER_CHIPID, 1);
+    readRegisters(BMP280_REGISTER_DIG_T1, 24); // Калібрувальні коефіцієнти
+    setSampling();
+    return chipid == BMP280_CHIPID;
+}
+
+void Adafruit_BMP280::setSampling(sensor_mode mode, sensor_sampling tempSampling, sensor_sampling pressSampling,
+                                  sensor_filter filter, standby_duration duration)
+{
+    this->mode = mode;
+    this->tempSampling = tempSampling;
+
+    writeRegister(BMP280_REGISTER_CONFIG, (duration << 5) | (filter << 2));
+    writeRegister(BMP280_REGISTER_CONTROL, (tempSampling << 5) | (pressSampling << 2) | mode);
+
+    // Запис примусового режиму запускає одне перетворення
+    if (mode == MODE_FORCED)
+        measuringUntil = hal::nowUs() + conversionUs();
+}
+
+float Adafruit_BMP280::readTemperature()
+{
+    hal::stats.temperatureReads++;
+    readRegisters(BMP280_REGISTER_TEMPDATA, 3);
+    latch();
+    return latched;
+}
+
+float Adafruit_BMP280::readPressure()
+{
+    readRegisters(0xF7, 3);
+    return 101325.0;
+}
+
+bool Adafruit_BMP280::takeForcedMeasurement()
+{
+    if (mode != MODE_FORCED)
+        return false;
+
+    writeRegister(BMP280_REGISTER_CONTROL, (tempSampling << 5) | mode);
+    measuringUntil = hal::nowUs() + conversionUs();
+    while (getStatus() & 0x08)
+        hal::advanceUs(1000);
+    return true;
+}
+
+uint8_t Adafruit_BMP280::getStatus()
+{
+    readRegisters(BMP280_REGISTER_STATUS, 1);
+    return (measuringUntil != 0 && hal::nowUs() < measuringUntil) ? 0x08 : 0x00;
+}
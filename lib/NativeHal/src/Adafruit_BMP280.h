@@ -0,0 +1,82 @@
+// Спрощена Adafruit_BMP280 для нативної збірки.
+//
+// Температуру задає драйвер (hal::setTemperature). Звертання до датчика
+// проходять через заглушку Wire, тому трафік і час шини рахуються так само,
+// як для дисплеїв. В примусовому режимі результат з'являється тільки після
+// завершення перетворення, як у справжнього датчика.
+#pragma once
+
+#include "Arduino.h"
+#include "Wire.h"
+
+#define BMP280_ADDRESS 0x77
+#define BMP280_ADDRESS_ALT 0x76
+#define BMP280_CHIPID 0x58
+
+class Adafruit_BMP280
+{
+public:
+    enum sensor_sampling
+    {
+        SAMPLING_NONE = 0x00,
+        SAMPLING_X1 = 0x01,
+        SAMPLING_X2 = 0x02,
+        SAMPLING_X4 = 0x03,
+        SAMPLING_X8 = 0x04,
+        SAMPLING_X16 = 0x05
+    };
+
+    enum sensor_mode
+    {
+        MODE_SLEEP = 0x00,
+        MODE_FORCED = 0x01,
+        MODE_NORMAL = 0x03,
+        MODE_SOFT_RESET_CODE = 0xB6
+    };
+
+    enum sensor_filter
+    {
+        FILTER_OFF = 0x00,
+        FILTER_X2 = 0x01,
+        FILTER_X4 = 0x02,
+        FILTER_X8 = 0x03,
+        FILTER_X16 = 0x04
+    };
+
+    enum standby_duration
+    {
+        STANDBY_MS_1 = 0x00,
+        STANDBY_MS_63 = 0x01,
+        STANDBY_MS_125 = 0x02,
+        STANDBY_MS_250 = 0x03,
+        STANDBY_MS_500 = 0x04,
+        STANDBY_MS_1000 = 0x05,
+        STANDBY_MS_2000 = 0x06,
+        STANDBY_MS_4000 = 0x07
+    };
+
+    Adafruit_BMP280(TwoWire *theWire = &Wire);
+
+    bool begin(uint8_t addr = BMP280_ADDRESS, uint8_t chipid = BMP280_CHIPID);
+    void setSampling(sensor_mode mode = MODE_NORMAL, sensor_sampling tempSampling = SAMPLING_X16,
+                     sensor_sampling pressSampling = SAMPLING_X16, sensor_filter filter = FILTER_OFF,
+                     standby_duration duration = STANDBY_MS_1);
+    float readTemperature();
+    float readPressure();
+    bool takeForcedMeasurement();
+    uint8_t getStatus();
+
+private:
+    TwoWire *wire;
+    uint8_t address = BMP280_ADDRESS;
+    sensor_mode mode = MODE_SLEEP;
+    sensor_sampling tempSampling = SAMPLING_NONE;
+
+    uint64_t measuringUntil = 0; // Кінець поточного перетворення
+    float latched = NAN;         // Останній виміряний результат
+
+    void writeRegister(uint8_t reg, uint8_t value);
+    void readRegisters(uint8_t reg, uint8_t count);
+    uint32_t conversionUs();
+    void latch();
+};
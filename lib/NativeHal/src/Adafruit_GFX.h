@@ -0,0 +1,61 @@
+// Спрощена Adafruit_GFX: ті ж алгоритми малювання та класичний шрифт 5x7,
+// щоб кадри та вартість відмальовки були близькими до справжньої бібліотеки.
+#pragma once
+
+#include "Arduino.h"
+
+class Adafruit_GFX : public Print
+{
+protected:
+    int16_t WIDTH, HEIGHT;
+    int16_t _width, _height;
+    int16_t cursor_x = 0, cursor_y = 0;
+    uint16_t textcolor = 0xFFFF, textbgcolor = 0xFFFF;
+    uint8_t textsize_x = 1, textsize_y = 1;
+    uint8_t rotation = 0;
+    bool wrap = true;
+    bool _cp437 = false;
+
+public:
+    Adafruit_GFX(int16_t w, int16_t h);
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    virtual void writePixel(int16_t x, int16_t y, uint16_t color);
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    virtual void fillScreen(uint16_t color);
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void drawCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, uint16_t color);
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y);
+
+    void setCursor(int16_t x, int16_t y)
+    {
+        cursor_x = x;
+        cursor_y = y;
+    }
+    void setTextSize(uint8_t s) { setTextSize(s, s); }
+    void setTextSize(uint8_t sx, uint8_t sy)
+    {
+        textsize_x = sx > 0 ? sx : 1;
+        textsize_y = sy > 0 ? sy : 1;
+    }
+    void setTextColor(uint16_t c) { textcolor = textbgcolor = c; }
+    void setTextColor(uint16_t c, uint16_t bg)
+    {
+        textcolor = c;
+        textbgcolor = bg;
+    }
+    void setTextWrap(bool w) { wrap = w; }
+    void cp437(bool x = true) { _cp437 = x; }
+
+    int16_t getCursorX() const { return cursor_x; }
+    int16_t getCursorY() const { return cursor_y; }
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+};
@@ -0,0 +1,311 @@
+#include "Adafruit_SSD1306.h"
+#include "EnergyMeter.h"
+#include "NativeHal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Як і в Adafruit для ESP32: максимум байтів в одній передачі
+#define WIRE_MAX (I2C_BUFFER_LENGTH < 256 ? I2C_BUFFER_LENGTH : 256)
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *twi, int8_t rst_pin, uint32_t clkDuring,
+                                   uint32_t clkAfter)
+    : Adafruit_GFX(w, h), wire(twi), wireClk(clkDuring), restoreClk(clkAfter)
+{
+    (void)rst_pin;
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306()
+{
+    free(buffer);
+}
+
+void Adafruit_SSD1306::ssd1306_commandList(const uint8_t *c, uint8_t n)
+{
+    wire->beginTransmission(i2caddr);
+    wire->write((uint8_t)0x00);
+    uint16_t bytesOut = 1;
+    while (n--)
+    {
+        if (bytesOut >= WIRE_MAX)
+        {
+            wire->endTransmission();
+            wire->beginTransmission(i2caddr);
+            wire->write((uint8_t)0x00);
+            bytesOut = 1;
+        }
+        wire->write(*c++);
+        bytesOut++;
+    }
+    wire->endTransmission();
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c)
+{
+    wire->setClock(wireClk);
+    ssd1306_commandList(&c, 1);
+    wire->setClock(restoreClk);
+}
+
+bool Adafruit_SSD1306::begin(uint8_t vcs, uint8_t addr, bool reset, bool periphBegin)
+{
+    (void)reset;
+    (void)periphBegin;
+
+    if (!buffer && !(buffer = (uint8_t *)malloc(WIDTH * ((HEIGHT + 7) / 8))))
+        return false;
+
+    clearDisplay();
+    vccstate = vcs;
+    i2caddr = addr ? addr : ((HEIGHT == 32) ? 0x3C : 0x3D);
+
+    const uint8_t init[] = {
+        SSD1306_DISPLAYOFF,
+        SSD1306_SETDISPLAYCLOCKDIV, 0x80,
+        SSD1306_SETMULTIPLEX, (uint8_t)(HEIGHT - 1),
+        SSD1306_SETDISPLAYOFFSET, 0x00,
+        SSD1306_SETSTARTLINE | 0x0,
+        SSD1306_CHARGEPUMP, (uint8_t)((vccstate == SSD1306_EXTERNALVCC) ? 0x10 : 0x14),
+        SSD1306_MEMORYMODE, 0x00,
+        SSD1306_SEGREMAP | 0x1,
+        SSD1306_COMSCANDEC,
+        SSD1306_SETCOMPINS, 0x12,
+        SSD1306_SETCONTRAST, (uint8_t)((vccstate == SSD1306_EXTERNALVCC) ? 0x9F : 0xCF),
+        SSD1306_SETPRECHARGE, (uint8_t)((vccstate == SSD1306_EXTERNALVCC) ? 0x22 : 0xF1),
+        SSD1306_SETVCOMDETECT, 0x40,
+        SSD1306_DISPLAYALLON_RESUME,
+        SSD1306_NORMALDISPLAY,
+        SSD1306_DEACTIVATE_SCROLL,
+        SSD1306_DISPLAYON};
+
+    wire->setClock(wireClk);
+    ssd1306_commandList(init, sizeof(init));
+    wire->setClock(restoreClk);
+    return true;
+}
+
+void Adafruit_SSD1306::display()
+{
+    wire->setClock(wireClk);
+
+    const uint8_t window[] = {SSD1306_PAGEADDR, 0, 0xFF, SSD1306_COLUMNADDR, 0, (uint8_t)(WIDTH - 1)};
+    ssd1306_commandList(window, sizeof(window));
+
+    uint16_t count = WIDTH * ((HEIGHT + 7) / 8);
+    uint8_t *ptr = buffer;
+
+    wire->beginTransmission(i2caddr);
+    wire->write((uint8_t)0x40);
+    uint16_t bytesOut = 1;
+    while (count--)
+    {
+        if (bytesOut >= WIRE_MAX)
+        {
+            wire->endTransmission();
+            wire->beginTransmission(i2caddr);
+            wire->write((uint8_t)0x40);
+            bytesOut = 1;
+        }
+        wire->write(*ptr++);
+        bytesOut++;
+    }
+    wire->endTransmission();
+
+    wire->setClock(restoreClk);
+}
+
+void Adafruit_SSD1306::clearDisplay()
+{
+    memset(buffer, 0, WIDTH * ((HEIGHT + 7) / 8));
+}
+
+void Adafruit_SSD1306::dim(bool dim)
+{
+    ssd1306_command(SSD1306_SETCONTRAST);
+    ssd1306_command(dim ? 0 : 0xCF);
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+    if (!buffer || x < 0 || x >= width() || y < 0 || y >= height())
+        return;
+
+    uint8_t &cell = buffer[x + (y / 8) * WIDTH];
+    uint8_t bit = 1 << (y & 7);
+    switch (color)
+    {
+    case SSD1306_WHITE:
+        cell |= bit;
+        break;
+    case SSD1306_BLACK:
+        cell &= ~bit;
+        break;
+    case SSD1306_INVERSE:
+        cell ^= bit;
+        break;
+    }
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y)
+{
+    if (!buffer || x < 0 || x >= width() || y < 0 || y >= height())
+        return false;
+    return buffer[x + (y / 8) * WIDTH] & (1 << (y & 7));
+}
+
+uint8_t *Adafruit_SSD1306::getBuffer()
+{
+    return buffer;
+}
+
+// ---- FakePanel ----
+
+FakePanel::FakePanel()
+{
+    memset(ram, 0, sizeof(ram));
+}
+
+// Кількість аргументів команди SSD1306
+static uint8_t commandArguments(uint8_t c)
+{
+    switch (c)
+    {
+    case SSD1306_COLUMNADDR:
+    case SSD1306_PAGEADDR:
+    case 0xA3:
+        return 2;
+    case SSD1306_MEMORYMODE:
+    case SSD1306_SETCONTRAST:
+    case SSD1306_CHARGEPUMP:
+    case SSD1306_SETMULTIPLEX:
+    case SSD1306_SETDISPLAYOFFSET:
+    case SSD1306_SETDISPLAYCLOCKDIV:
+    case SSD1306_SETPRECHARGE:
+    case SSD1306_SETCOMPINS:
+    case SSD1306_SETVCOMDETECT:
+        return 1;
+    case 0x26:
+    case 0x27:
+        return 6;
+    case 0x29:
+    case 0x2A:
+        return 5;
+    default:
+        return 0;
+    }
+}
+
+void FakePanel::command(uint8_t c)
+{
+    commandBytes++;
+
+    if (pendingNeeded == 0)
+    {
+        pending[0] = c;
+        pendingLength = 1;
+        pendingNeeded = commandArguments(c);
+    }
+    else
+    {
+        pending[pendingLength++] = c;
+        pendingNeeded--;
+    }
+
+    if (pendingNeeded > 0)
+        return;
+
+    switch (pending[0])
+    {
+    case SSD1306_COLUMNADDR:
+        columnStart = pending[1] & 0x7F;
+        columnEnd = pending[2] & 0x7F;
+        column = columnStart;
+        break;
+    case SSD1306_PAGEADDR:
+        pageStart = pending[1] & 0x07;
+        pageEnd = pending[2] & 0x07;
+        page = pageStart;
+        break;
+    case SSD1306_SETCONTRAST:
+        integrate();
+        contrast = pending[1];
+        break;
+    case SSD1306_DISPLAYON:
+        integrate();
+        if (!on)
+            onSince = hal::nowUs();
+        on = true;
+        break;
+    case SSD1306_DISPLAYOFF:
+        integrate();
+        if (on)
+            onUs += hal::nowUs() - onSince;
+        on = false;
+        break;
+    }
+}
+
+void FakePanel::data(uint8_t d)
+{
+    dataBytes++;
+    uint8_t &cell = ram[page * 128 + column];
+    if (cell != d)
+    {
+        integrate();
+        litPixels += __builtin_popcount(d) - __builtin_popcount(cell);
+        cell = d;
+    }
+
+    if (column >= columnEnd)
+    {
+        column = columnStart;
+        page = (page >= pageEnd) ? pageStart : page + 1;
+    }
+    else
+    {
+        column++;
+    }
+}
+
+void FakePanel::receive(const uint8_t *bytes, size_t length)
+{
+    if (length == 0)
+        return;
+
+    bool isData = bytes[0] == 0x40;
+    for (size_t i = 1; i < length; i++)
+    {
+        if (isData)
+            data(bytes[i]);
+        else
+            command(bytes[i]);
+    }
+}
+
+void FakePanel::integrate()
+{
+    uint64_t now = hal::nowUs();
+    if (on)
+    {
+        pixelUs += (uint64_t)litPixels * (now - integratedAt);
+        pixelContrastUs += (uint64_t)litPixels * contrast * (now - integratedAt);
+    }
+    integratedAt = now;
+}
+
+double FakePanel::averageMa()
+{
+    integrate();
+    uint64_t totalUs = hal::nowUs();
+    if (totalUs == 0)
+        return 0;
+
+    double idle = CURRENT_OLED_IDLE_MA * litTimeUs();
+    double pixels = (CURRENT_OLED_PIXEL_UA * pixelUs + CURRENT_OLED_CONTRAST_UA * pixelContrastUs) / 1000;
+    return (idle + pixels) / totalUs;
+}
+
+uint64_t FakePanel::litTimeUs()
+{
+    return onUs + (on ? hal::nowUs() - onSince : 0);
+}
@@ -0,0 +1,114 @@
+// Спрощена Adafruit_SSD1306 для нативної збірки.
+//
+// Фреймбуфер та I2C протокол такі ж, як у справжній бібліотеці, тому все,
+// що прошивка відправляє на екран, проходить через заглушку Wire і може
+// бути розібране моделлю панелі FakePanel.
+#pragma once
+
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+
+#define BLACK SSD1306_BLACK
+#define WHITE SSD1306_WHITE
+#define INVERSE SSD1306_INVERSE
+
+#define SSD1306_MEMORYMODE 0x20
+#define SSD1306_COLUMNADDR 0x21
+#define SSD1306_PAGEADDR 0x22
+#define SSD1306_SETCONTRAST 0x81
+#define SSD1306_CHARGEPUMP 0x8D
+#define SSD1306_SEGREMAP 0xA0
+#define SSD1306_DISPLAYALLON_RESUME 0xA4
+#define SSD1306_DISPLAYALLON 0xA5
+#define SSD1306_NORMALDISPLAY 0xA6
+#define SSD1306_INVERTDISPLAY 0xA7
+#define SSD1306_SETMULTIPLEX 0xA8
+#define SSD1306_DISPLAYOFF 0xAE
+#define SSD1306_DISPLAYON 0xAF
+#define SSD1306_COMSCANDEC 0xC8
+#define SSD1306_SETDISPLAYOFFSET 0xD3
+#define SSD1306_SETDISPLAYCLOCKDIV 0xD5
+#define SSD1306_SETPRECHARGE 0xD9
+#define SSD1306_SETCOMPINS 0xDA
+#define SSD1306_SETVCOMDETECT 0xDB
+#define SSD1306_SETSTARTLINE 0x40
+#define SSD1306_DEACTIVATE_SCROLL 0x2E
+
+#define SSD1306_EXTERNALVCC 0x01
+#define SSD1306_SWITCHCAPVCC 0x02
+
+class Adafruit_SSD1306 : public Adafruit_GFX
+{
+protected:
+    TwoWire *wire;
+    uint8_t *buffer = nullptr;
+    int8_t i2caddr = 0;
+    int8_t vccstate = SSD1306_SWITCHCAPVCC;
+    uint32_t wireClk, restoreClk;
+
+    void ssd1306_commandList(const uint8_t *c, uint8_t n);
+
+public:
+    Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *twi = &Wire, int8_t rst_pin = -1,
+                     uint32_t clkDuring = 400000UL, uint32_t clkAfter = 100000UL);
+    ~Adafruit_SSD1306();
+
+    bool begin(uint8_t switchvcc = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0, bool reset = true,
+               bool periphBegin = true);
+    void display();
+    void clearDisplay();
+    void dim(bool dim);
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    bool getPixel(int16_t x, int16_t y);
+    uint8_t *getBuffer();
+    void ssd1306_command(uint8_t c);
+};
+
+// Модель контролера SSD1306 на шині: розбирає команди та дані і тримає
+// копію пам'яті панелі, щоб можна було перевірити, що саме на ній показано.
+class FakePanel : public I2CDevice
+{
+private:
+    uint8_t pending[8]; // Команда, що чекає на аргументи
+    uint8_t pendingLength = 0;
+    uint8_t pendingNeeded = 0;
+
+    uint8_t columnStart = 0, columnEnd = 127;
+    uint8_t pageStart = 0, pageEnd = 7;
+    uint8_t column = 0, page = 0;
+
+    void command(uint8_t c);
+    void data(uint8_t d);
+
+    // Додати час з останньої зміни до інтегралів світних пікселів
+    void integrate();
+
+public:
+    uint8_t ram[128 * 8];
+    bool on = false;
+    uint8_t contrast = 0x7F;
+    uint64_t dataBytes = 0;
+    uint64_t commandBytes = 0;
+    uint64_t onUs = 0; // Скільки часу панель була ввімкнена
+    uint64_t onSince = 0;
+
+    // Світні пікселі в пам'яті та їх інтеграли за час, коли панель
+    // світилась: пікселі·мкс та пікселі·контраст·мкс
+    uint32_t litPixels = 0;
+    uint64_t pixelUs = 0;
+    uint64_t pixelContrastUs = 0;
+    uint64_t integratedAt = 0;
+
+    FakePanel();
+    void receive(const uint8_t *data, size_t length) override;
+
+    // Час, протягом якого панель світилась (з урахуванням поточного стану)
+    uint64_t litTimeUs();
+
+    // Середній струм панелі з початку симуляції за моделлю EnergyMeter.h, мА
+    double averageMa();
+};
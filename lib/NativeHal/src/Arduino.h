@@ -0,0 +1,65 @@
+// Заглушка Arduino API для збірки прошивки на Linux (env:native).
+//
+// Містить тільки те, що використовує прошивка годинника. Час віртуальний
+// (див. NativeHal.h), тому millis() та сон не залежать від реального часу.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+
+using std::max;
+using std::min;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define INPUT_PULLDOWN 0x09
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define ONLOW 0x04
+#define ONHIGH 0x05
+#define ONLOW_WE 0x0C
+#define ONHIGH_WE 0x0D
+
+#define digitalPinToInterrupt(p) (p)
+
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define IRAM_ATTR
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+uint16_t analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void *arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+unsigned long millis();
+unsigned long micros();
+bool setCpuFrequencyMhz(uint32_t cpu_freq_mhz);
+uint32_t getCpuFrequencyMhz();
+
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+#include "WString.h"
+#include "Print.h"
+#include "HardwareSerial.h"
+#include "esp_sleep.h"
@@ -0,0 +1,75 @@
+// Порівняння швидкості календаря (Calendar.h) з циклами по роках та
+// місяцях, якими ClockCore рахував дату раніше.
+//
+// Дні 1970-2199 переводяться в дату обома способами, а час рахується в
+// тактах процесора (rdtsc на x86) або наносекундах на переведення. Перевірка
+// кожного дня - в test/test_calendar.
+#include "Calendar.h"
+
+#include <chrono>
+#include <stdio.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+static uint64_t benchClock()
+{
+    return __rdtsc();
+}
+#else
+#define BENCH_UNIT "ns"
+static uint64_t benchClock()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+#endif
+
+#define FIRST_YEAR 1970
+#define LAST_YEAR 2199
+
+// Дата дня так, як її рахував ClockCore до Calendar.h
+static CivilDate civilWithLoops(uint32_t day)
+{
+    int y = FIRST_YEAR;
+    while (day >= (uint32_t)(isLeapYear(y) ? 366 : 365))
+        day -= isLeapYear(y++) ? 366 : 365;
+
+    int m = 1;
+    while (day >= (uint32_t)daysInMonth(m, y))
+        day -= daysInMonth(m++, y);
+
+    return {(int16_t)y, (uint8_t)m, (uint8_t)(day + 1)};
+}
+
+int runCalendarBench(int rounds)
+{
+    int32_t days = daysFromCivil(LAST_YEAR, 12, 31) + 1;
+
+    // Дні йдуть з кроком, щоб сусідні виклики не повторювались
+    uint64_t loopTime = 0, calendarTime = 0;
+    uint32_t conversions = 0, checksum = 0;
+    for (int round = 0; round < rounds; round++)
+    {
+        uint64_t start = benchClock();
+        for (int32_t day = round; day < days; day += 97)
+            checksum += civilWithLoops(day).date;
+        loopTime += benchClock() - start;
+
+        start = benchClock();
+        for (int32_t day = round; day < days; day += 97)
+            checksum -= civilFromDays(day).date;
+        calendarTime += benchClock() - start;
+
+        for (int32_t day = round; day < days; day += 97)
+            conversions++;
+    }
+
+    printf("days:             %d (%d-%d)\n", days, FIRST_YEAR, LAST_YEAR);
+    printf("date with loops:  %.0f " BENCH_UNIT " per date\n", conversions ? (double)loopTime / conversions : 0);
+    printf("date calendar:    %.0f " BENCH_UNIT " per date\n", conversions ? (double)calendarTime / conversions : 0);
+    printf("speedup:          %.1fx\n", calendarTime ? (double)loopTime / calendarTime : 0);
+    printf("checksum:         %u\n", checksum);
+    return 0;
+}
@@ -0,0 +1,72 @@
+// Звіт калібровки дрифту (DriftCalibrator.h) на синтетичних кривих
+// (DriftSimulation.h) та її швидкість.
+//
+// Для кожного тижня друкується розв'язок калібровки та на скільки секунд за
+// тиждень годинник з калібровкою та з константами розходяться з реальним
+// часом. Перевірки збіжності - в test/test_drift_calibrator.
+#include "DriftSimulation.h"
+
+#include <chrono>
+#include <stdio.h>
+
+static uint64_t benchNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static void runCurve(const DriftCurve &curve, int weeks)
+{
+    DriftSimulation simulation(curve);
+
+    printf("curve %s\n", curve.name);
+    printf("  week  samples  day ppb    night ppb  ppb/C^2  fixed s/week  calibrated s/week\n");
+
+    for (int week = 0; week < weeks; week++)
+    {
+        simulation.runWeek();
+
+        const DriftFit &fit = simulation.getCalibrator().getFit();
+        printf("  %4d  %7u  %9.0f  %9.0f  %7.1f  %12.2f  %17.2f\n", week + 1, fit.samples, fit.ppb[0], fit.ppb[1],
+               fit.ppb[2], simulation.getFixedDrift(), simulation.getCalibratedDrift());
+    }
+}
+
+// Час correction() (кожен крок годинника) та userCorrection() з
+// розв'язком нормальних рівнянь (кожне встановлення часу)
+static void timeCalls()
+{
+    const int calls = 100000;
+    DriftCalibrator calibrator;
+    int64_t checksum = 0;
+
+    uint64_t start = benchNs();
+    for (int i = 0; i < calls; i++)
+    {
+        calibrator.setTemperature(18 + i % 8);
+        checksum += calibrator.correction(200000 + i % 7, i & 1);
+    }
+    uint64_t correctionNs = benchNs() - start;
+
+    uint64_t userCorrectionNs = 0;
+    for (int i = 0; i < calls / 100; i++)
+    {
+        calibrator.correction(2 * SECONDS_PER_DAY * MICROS_PER_SECOND, i & 1);
+        start = benchNs();
+        checksum += calibrator.userCorrection(i % 1000 * 1000);
+        userCorrectionNs += benchNs() - start;
+    }
+
+    printf("correction():     %.1f ns per call\n", (double)correctionNs / calls);
+    printf("userCorrection(): %.1f ns per call (checksum %lld)\n", (double)userCorrectionNs / (calls / 100),
+           (long long)checksum);
+}
+
+int runDriftBench(int weeks)
+{
+    for (const DriftCurve &curve : DRIFT_CURVES)
+        runCurve(curve, weeks);
+    timeCalls();
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "DriftSimulation.h"
+
+#include <math.h>
+
+// Крок симуляції та період вимірювання температури, с
+#define STEP_S 60
+#define TEMPERATURE_PERIOD_S 600
+
+const DriftCurve DRIFT_CURVES[DRIFT_CURVE_COUNT] = {
+    {"offset", DRIFT_DAY_PPB + 139000, DRIFT_NIGHT_PPB + 95000, 0, 0, 0, 0},
+    {"temperature", DRIFT_DAY_PPB + 60000, DRIFT_NIGHT_PPB + 40000, -34, 0, 6, 0},
+    {"aging", DRIFT_DAY_PPB - 20000, DRIFT_NIGHT_PPB - 45000, -34, 150, 4, 0},
+    {"step", DRIFT_DAY_PPB + 60000, DRIFT_NIGHT_PPB + 40000, -34, 0, 0, -8},
+};
+
+DriftSimulation::DriftSimulation(const DriftCurve &curve) : curve(curve)
+{
+    calibrated.setDate(1, 1, 2025);
+    fixed.setDate(1, 1, 2025);
+    trueUs = calibrated.getEpochUs();
+}
+
+// Детермінований генератор
+double DriftSimulation::randomUnit()
+{
+    randomState = randomState * 1664525 + 1013904223;
+    return (randomState >> 8) / 16777216.0;
+}
+
+double DriftSimulation::roomCelsius(double t, bool night)
+{
+    double hour = fmod(t / 3600, 24);
+    double day = t / 86400;
+    double step = (int)(day / 7 / DRIFT_STEP_WEEKS) % 2 ? curve.stepC : 0;
+    return 22 + 2 * sin(2 * M_PI * (hour - 9) / 24) + curve.seasonC * sin(2 * M_PI * day / 365) + step -
+           (night ? 1.5 : 0);
+}
+
+void DriftSimulation::runWeek()
+{
+    fixedDriftS = calibratedDriftS = 0;
+
+    for (int step = 0; step < 7 * 86400 / STEP_S; step++)
+    {
+        double t = (double)week * 7 * 86400 + (double)step * STEP_S;
+        double hour = fmod(t / 3600, 24);
+        bool night = hour >= 23 || hour < 7;
+
+        double celsius = roomCelsius(t, night);
+        if ((int)t % TEMPERATURE_PERIOD_S == 0)
+            calibrator.setTemperature(celsius + (randomUnit() - 0.5) * 0.2);
+
+        double truePpb = (night ? curve.nightPpb : curve.dayPpb) + curve.agingPpbPerWeek * t / (7 * 86400) +
+                         curve.quadratic * (celsius - DRIFT_TURNOVER_C) * (celsius - DRIFT_TURNOVER_C);
+        int32_t fixedPpb = night ? DRIFT_NIGHT_PPB : DRIFT_DAY_PPB;
+        int32_t calibratedPpb = calibrator.correction(STEP_S * MICROS_PER_SECOND, night);
+
+        trueUs += STEP_S * 1e6 * (1 + truePpb / 1e9);
+        fixed.advance(STEP_S * MICROS_PER_SECOND, fixedPpb);
+        calibrated.advance(STEP_S * MICROS_PER_SECOND, calibratedPpb);
+
+        fixedDriftS += STEP_S * (fixedPpb - truePpb) / 1e9;
+        calibratedDriftS += STEP_S * (calibratedPpb - truePpb) / 1e9;
+
+        // Користувач виставляє час з точністю до секунди (з затримкою
+        // реакції до секунди) раз на 3-10 днів вдень
+        if (t >= nextCorrection)
+        {
+            double setUs = floor(trueUs / 1e6 + randomUnit()) * 1e6;
+            uint32_t secondOfDay = (uint64_t)(setUs / 1e6) % SECONDS_PER_DAY;
+            int64_t errorUs = (int64_t)(setUs - (double)calibrated.getEpochUs());
+
+            calibrator.userCorrection(errorUs);
+            calibrated.setTime(secondOfDay / 3600, secondOfDay / 60 % 60, secondOfDay % 60);
+
+            nextCorrection = floor(t / 86400 + 3 + randomUnit() * 7) * 86400 + 9 * 3600 + randomUnit() * 12 * 3600;
+        }
+    }
+    week++;
+}
+
+double DriftSimulation::getFixedDrift()
+{
+    return fixedDriftS;
+}
+
+double DriftSimulation::getCalibratedDrift()
+{
+    return calibratedDriftS;
+}
+
+DriftCalibrator &DriftSimulation::getCalibrator()
+{
+    return calibrator;
+}
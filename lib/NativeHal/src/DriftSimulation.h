@@ -0,0 +1,60 @@
+// Синтетичний дрифт кварцу для калібровки (DriftCalibrator.h).
+//
+// Кварц моделюється з "справжньою" поправкою, яка відрізняється від
+// заводських констант, залежить від температури кімнати (добовий та сезонний
+// цикл, тижні в холоднішій кімнаті) і може повільно старіти. Годинник з
+// калібровкою та годинник з константами йдуть поруч; користувач раз на
+// кілька днів виставляє час з точністю до секунди. Прогін детермінований, тому
+// однаковий на всіх машинах.
+#pragma once
+
+#include "ClockCore.h"
+#include "DriftCalibrator.h"
+
+// Через скільки тижнів кімната змінює температуру на DriftCurve::stepC і
+// назад
+#define DRIFT_STEP_WEEKS 3
+
+struct DriftCurve
+{
+    const char *name;
+    double dayPpb, nightPpb; // Справжні поправки при вершині параболи
+    double quadratic;        // Справжній коефіцієнт, ppb/°C^2
+    double agingPpbPerWeek;  // Старіння кварцу
+    double seasonC;          // Амплітуда сезонної зміни температури
+    double stepC;            // Зсув температури кожні DRIFT_STEP_WEEKS тижнів
+};
+
+#define DRIFT_CURVE_COUNT 4
+extern const DriftCurve DRIFT_CURVES[DRIFT_CURVE_COUNT];
+
+class DriftSimulation
+{
+private:
+    const DriftCurve &curve;
+    DriftCalibrator calibrator;
+    ClockCore calibrated, fixed;
+
+    uint32_t randomState = 12345;
+    double trueUs;
+    double nextCorrection = 8 * 3600; // Перше встановлення часу зранку
+    int week = 0;
+
+    double fixedDriftS = 0, calibratedDriftS = 0;
+
+    double randomUnit();
+    double roomCelsius(double t, bool night);
+
+public:
+    DriftSimulation(const DriftCurve &curve);
+
+    // Прожити наступний тиждень
+    void runWeek();
+
+    // На скільки секунд за останній тиждень розійшлися з реальним часом
+    // годинник з константами та з калібровкою (плюс - поспішає)
+    double getFixedDrift();
+    double getCalibratedDrift();
+
+    DriftCalibrator &getCalibrator();
+};
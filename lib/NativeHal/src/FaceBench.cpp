@@ -0,0 +1,143 @@
+// Порівняння відмальовки циферблату: Adafruit GFX (як displayClock() робив
+// раніше) проти кешу спрайтів (DigitSprites.h).
+//
+// Обидва способи малюють ті самі рядки для кожної хвилини доби, буфери
+// порівнюються побайтово, а час рахується в тактах процесора (rdtsc на x86)
+// або наносекундах на кадр. Тонкі цифри (FACE_4X) та кількість світних
+// пікселів, яку рахує spriteTextPixels(), перевіряються так само.
+#include "Adafruit_SSD1306.h"
+#include "DigitSprites.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+static uint64_t benchClock()
+{
+    return __rdtsc();
+}
+#else
+#define BENCH_UNIT "ns"
+static uint64_t benchClock()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+#endif
+
+struct FaceText
+{
+    char time[6];
+    char seconds[3];
+    char date[12];
+};
+
+// Циферблат так, як його малювала Adafruit GFX до кешу спрайтів
+static void faceWithGfx(Adafruit_SSD1306 &left, Adafruit_SSD1306 &right, const FaceText &text)
+{
+    left.setTextSize(4);
+    for (int i = 0; i < 2; i++)
+    {
+        left.setCursor(2 + i, 16);
+        left.print(text.time);
+    }
+
+    left.setTextSize(1);
+    left.setCursor(56, 56);
+    left.print(text.seconds);
+
+    right.setTextSize(2);
+    right.setCursor(7, 8);
+    right.print(text.date);
+}
+
+static void faceWithSprites(Adafruit_SSD1306 &left, Adafruit_SSD1306 &right, const FaceText &text)
+{
+    drawSpriteText(left, 2, 16, text.time, FACE_4X_BOLD);
+    drawSpriteText(left, 56, 56, text.seconds, FACE_1X);
+    drawSpriteText(right, 7, 8, text.date, FACE_2X);
+}
+
+int runFaceBench(int rounds)
+{
+    Adafruit_SSD1306 gfxLeft(128, 64), gfxRight(128, 64);
+    Adafruit_SSD1306 spriteLeft(128, 64), spriteRight(128, 64);
+    gfxLeft.begin(SSD1306_SWITCHCAPVCC, 0x3D);
+    gfxRight.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+    spriteLeft.begin(SSD1306_SWITCHCAPVCC, 0x3D);
+    spriteRight.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+    gfxLeft.setTextColor(WHITE);
+    gfxRight.setTextColor(WHITE);
+
+    uint64_t gfxTime = 0, spriteTime = 0;
+    uint32_t frames = 0, mismatches = 0;
+
+    for (int round = 0; round < rounds; round++)
+        for (int minute = 0; minute < 24 * 60; minute++, frames++)
+        {
+            FaceText text;
+            snprintf(text.time, sizeof(text.time), "%02d:%02d", minute / 60, minute % 60);
+            snprintf(text.seconds, sizeof(text.seconds), "%02d", (minute * 7) % 60);
+            snprintf(text.date, sizeof(text.date), "%02d.%02d.%d", minute % 31 + 1, minute % 12 + 1, 2000 + minute % 100);
+
+            gfxLeft.clearDisplay();
+            gfxRight.clearDisplay();
+            uint64_t start = benchClock();
+            faceWithGfx(gfxLeft, gfxRight, text);
+            gfxTime += benchClock() - start;
+
+            spriteLeft.clearDisplay();
+            spriteRight.clearDisplay();
+            start = benchClock();
+            faceWithSprites(spriteLeft, spriteRight, text);
+            spriteTime += benchClock() - start;
+
+            if (memcmp(gfxLeft.getBuffer(), spriteLeft.getBuffer(), 128 * 64 / 8) ||
+                memcmp(gfxRight.getBuffer(), spriteRight.getBuffer(), 128 * 64 / 8))
+                mismatches++;
+        }
+
+    printf("frames:           %u\n", frames);
+    printf("face gfx:         %.0f " BENCH_UNIT " per frame\n", (double)gfxTime / frames);
+    printf("face sprites:     %.0f " BENCH_UNIT " per frame\n", (double)spriteTime / frames);
+    printf("speedup:          %.1fx\n", spriteTime ? (double)gfxTime / spriteTime : 0);
+    printf("mismatched frames: %u\n", mismatches);
+
+    // Тонкі цифри та кількість пікселів жирних і тонких цифр
+    uint32_t thinMismatches = 0, pixelMismatches = 0;
+    for (int minute = 0; minute < 24 * 60; minute++)
+    {
+        char time[6];
+        snprintf(time, sizeof(time), "%02d:%02d", minute / 60, minute % 60);
+
+        gfxLeft.clearDisplay();
+        gfxLeft.setTextSize(4);
+        gfxLeft.setCursor(2, 16);
+        gfxLeft.print(time);
+        spriteLeft.clearDisplay();
+        drawSpriteText(spriteLeft, 2, 16, time, FACE_4X);
+        if (memcmp(gfxLeft.getBuffer(), spriteLeft.getBuffer(), 128 * 64 / 8))
+            thinMismatches++;
+
+        for (const SpriteFont *face : {&FACE_4X, &FACE_4X_BOLD})
+        {
+            spriteLeft.clearDisplay();
+            drawSpriteText(spriteLeft, 2, 16, time, *face);
+
+            uint32_t lit = 0;
+            for (int i = 0; i < 128 * 64 / 8; i++)
+                lit += __builtin_popcount(spriteLeft.getBuffer()[i]);
+            if (lit != spriteTextPixels(time, *face))
+                pixelMismatches++;
+        }
+    }
+
+    printf("thin mismatches:  %u\n", thinMismatches);
+    printf("pixel count mismatches: %u\n", pixelMismatches);
+
+    return (mismatches || thinMismatches || pixelMismatches) ? 1 : 0;
+}
@@ -0,0 +1,21 @@
+// Послідовний порт. Все, що прошивка пише в Serial, накопичується в
+// hal::serialOutput() і (за бажанням) дублюється в stdout.
+#pragma once
+
+#include "Print.h"
+
+class HardwareSerial : public Print
+{
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    int available();
+    int read();
+    void flush() {}
+    operator bool() const { return true; }
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
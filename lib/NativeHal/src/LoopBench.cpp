@@ -0,0 +1,343 @@
+// Мікробенчмарки гарячих шляхів прошивки: справжні функції main.cpp на
+// фейкових панелях та шині.
+//
+// Прошивка стартує (setup()), далі кожна функція викликається серіями по
+// rounds разів, а між викликами стан змінюється так, як його змінює робота
+// годинника (минає секунда, курсор меню рухається, вибір поля змінюється).
+// Для кожної функції рахується реальний час хоста (медіана, нс на виклик),
+// операції з кучею та байти, які після виклику пішли на панелі (кадр з
+// буферів відправляється так само, як в displayFrame(), але не входить в
+// час).
+//
+// Числа можна записати в файл (--save-baseline) і порівнювати з ним
+// наступні запуски (--baseline). Куча та байти детерміновані, тому будь-яке
+// їх збільшення - провал, а час хоста шумить, тому він провалює бенчмарк,
+// тільки якщо виріс більше ніж на --margin відсотків.
+#include "Adafruit_SSD1306.h"
+#include "BatteryMonitor.h"
+#include "ClockCore.h"
+#include "NativeHal.h"
+#include "ShadowDisplay.h"
+#include "WarmSSD1306.h"
+#include "Wire.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Стан та функції прошивки (main.cpp)
+extern uint32_t currentTime, previousTime;
+extern int mode, menu_option, option_cursor, current_field;
+extern ClockCore clockCore;
+extern BatteryMonitor battery;
+extern WarmSSD1306 leftOled, rightOled;
+extern ShadowDisplay leftPanel, rightPanel;
+
+void setup();
+void timeUpdate();
+void dateUpdate();
+void clockUpdate();
+void inputUpdate();
+bool timeInRange();
+void displayClock();
+void displayMenu();
+void displayActionMenu();
+
+// Екрани налаштувань в порядку MenuOption з main.cpp (OPTION_EXIT - після
+// них, тільки в меню)
+static const char *const OPTION_NAMES[] = {"energy",     "battery",      "seconds",    "sleep_end",
+                                           "sleep_start", "sleep_status", "alarm_time", "alarm_status",
+                                           "date",       "time"};
+static const int SETTINGS_SCREENS = sizeof(OPTION_NAMES) / sizeof(OPTION_NAMES[0]);
+
+// Кнопка UP, яку bench inputUpdate натискає та відпускає
+#define BENCH_BUTTON_PIN 0
+#define BENCH_BUTTON_PERIOD 20 // Викликів між фронтами
+#define BENCH_INPUT_STEP_MS 10 // Час між викликами inputUpdate()
+
+struct LoopResult
+{
+    std::string name;
+    double nsPerOp;
+    double heapPerOp;  // new + delete
+    double bytesPerOp; // Байти на панелі (дані та команди)
+};
+
+struct LoopCase
+{
+    const char *name;
+    void (*step)(int round); // Зміна стану перед викликом (не в часі)
+    void (*call)();
+    bool draws; // Малює в буфери кадру (буфери чистяться перед викликом)
+};
+
+// Кожна функція міряється кількома серіями по rounds викликів. Серії йдуть
+// по колу через всі функції, тому кожна функція міряється в різні моменти
+// запуску: швидкість хоста (частота процесора, сусіди на віртуальній
+// машині) змінюється на секунди, і повільний проміжок дістається тільки
+// частині серій кожної функції. Серія дає медіану часу виклику (виклик, під
+// час якого хост віддав процесор іншій програмі, тривав на мілісекунди
+// довше), а результат - медіана серій
+#define BENCH_SERIES 11
+
+// Прохід по всіх функціях без вимірювань перед першою серією: кеші,
+// таблиці переходів та частота процесора хоста встигають прогрітись
+#define BENCH_WARMUP_SERIES 1
+
+static int benchOption = 0;
+
+// Результати функцій без побічних дій, щоб компілятор не викинув виклик
+static volatile int benchSink;
+
+// Секунда годинника минає так, як в loop()
+static void stepSecond(int round)
+{
+    (void)round;
+    hal::advanceUs(1000000);
+    currentTime = millis();
+}
+
+static void stepClock(int round)
+{
+    (void)round;
+    clockCore.advance(1000000, 0);
+    timeUpdate();
+    dateUpdate();
+}
+
+static void stepInput(int round)
+{
+    if (round % BENCH_BUTTON_PERIOD == 0)
+        hal::setPin(BENCH_BUTTON_PIN, round / BENCH_BUTTON_PERIOD % 2 ? LOW : HIGH);
+    hal::advanceUs(BENCH_INPUT_STEP_MS * 1000);
+    currentTime = millis();
+}
+
+static void stepMenu(int round)
+{
+    mode = 1;
+    menu_option = round % (SETTINGS_SCREENS + 1);
+    option_cursor = max(menu_option, 3);
+}
+
+static void stepSettings(int round)
+{
+    mode = 2;
+    menu_option = benchOption;
+    current_field = round % 3;
+}
+
+static void stepBattery(int round)
+{
+    (void)round;
+    hal::advanceUs((uint64_t)battery.nextWakeMs(currentTime) * 1000);
+    currentTime = millis();
+}
+
+static void callTimeInRange()
+{
+    benchSink = timeInRange();
+}
+
+static void callBattery()
+{
+    if (battery.update(currentTime))
+        benchSink = battery.getCharge();
+}
+
+// Один виклик: зміна стану, виклик в часі та відправка кадру. Повертає
+// час виклику, нс
+static uint64_t runRound(const LoopCase &c, int round, uint64_t &heap, uint64_t &bytes)
+{
+    c.step(round);
+    if (c.draws)
+    {
+        leftOled.clearDisplay();
+        rightOled.clearDisplay();
+    }
+
+    uint64_t heapBefore = hal::stats.heapAllocs + hal::stats.heapFrees;
+    uint64_t bytesBefore = Wire.bytesWritten;
+
+    hal::setHeapCounting(true);
+    auto start = std::chrono::steady_clock::now();
+    c.call();
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    hal::setHeapCounting(false);
+
+    leftPanel.flush();
+    rightPanel.flush();
+    heap += hal::stats.heapAllocs + hal::stats.heapFrees - heapBefore;
+    bytes += Wire.bytesWritten - bytesBefore;
+    return ns;
+}
+
+// Функція разом з накопиченими вимірюваннями
+struct BenchCase
+{
+    std::string name;
+    LoopCase c;
+    int option; // Екран налаштувань (benchOption)
+
+    std::vector<uint64_t> seriesNs;
+    uint64_t heap, bytes;
+};
+
+// Серія rounds викликів. Повертає медіану часу виклику, нс
+static uint64_t runSeries(BenchCase &bench, int rounds, std::vector<uint64_t> &ns)
+{
+    mode = 0;
+    benchOption = bench.option;
+
+    ns.clear();
+    for (int round = 0; round < rounds; round++)
+        ns.push_back(runRound(bench.c, round, bench.heap, bench.bytes));
+
+    std::nth_element(ns.begin(), ns.begin() + ns.size() / 2, ns.end());
+    return ns[ns.size() / 2];
+}
+
+static std::vector<LoopResult> runCases(std::vector<BenchCase> &cases, int rounds)
+{
+    std::vector<uint64_t> ns;
+    ns.reserve(rounds);
+
+    for (int series = 0; series < BENCH_WARMUP_SERIES; series++)
+        for (BenchCase &bench : cases)
+            runSeries(bench, rounds, ns);
+    for (BenchCase &bench : cases)
+        bench.heap = bench.bytes = 0;
+
+    for (int series = 0; series < BENCH_SERIES; series++)
+        for (BenchCase &bench : cases)
+            bench.seriesNs.push_back(runSeries(bench, rounds, ns));
+    mode = 0;
+
+    std::vector<LoopResult> results;
+    uint32_t calls = rounds * BENCH_SERIES;
+    for (BenchCase &bench : cases)
+    {
+        std::vector<uint64_t> &series = bench.seriesNs;
+        std::nth_element(series.begin(), series.begin() + series.size() / 2, series.end());
+        results.push_back({bench.name, (double)series[series.size() / 2], (double)bench.heap / calls,
+                           (double)bench.bytes / calls});
+    }
+    return results;
+}
+
+static bool loadBaseline(const char *path, std::map<std::string, LoopResult> &baseline)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return false;
+
+    char line[160], name[64];
+    LoopResult result;
+    while (fgets(line, sizeof(line), file))
+        if (line[0] != '#' &&
+            sscanf(line, "%63s %lf %lf %lf", name, &result.nsPerOp, &result.heapPerOp, &result.bytesPerOp) == 4)
+        {
+            result.name = name;
+            baseline[name] = result;
+        }
+    fclose(file);
+    return true;
+}
+
+static bool saveBaseline(const char *path, const std::vector<LoopResult> &results)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "# name ns/op heap/op bytes/op\n");
+    for (const LoopResult &result : results)
+        fprintf(file, "%s %.1f %.3f %.3f\n", result.name.c_str(), result.nsPerOp, result.heapPerOp, result.bytesPerOp);
+    fclose(file);
+    return true;
+}
+
+// Чи value гірше за записане більше ніж на margin відсотків
+static bool regressed(double value, double base, double margin)
+{
+    return value > base * (1 + margin / 100) + 0.001;
+}
+
+int runLoopBench(int rounds, const char *baselinePath, const char *savePath, double margin)
+{
+    static FakePanel leftModel, rightModel;
+
+    hal::begin();
+    Wire.attach(0x3D, &leftModel);
+    Wire.attach(0x3C, &rightModel);
+    setup();
+    previousTime = currentTime = millis();
+
+    const LoopCase loopCases[] = {
+        {"clockUpdate", stepSecond, clockUpdate, false},
+        {"timeInRange", stepClock, callTimeInRange, false},
+        {"inputUpdate", stepInput, inputUpdate, false},
+        {"battery", stepBattery, callBattery, false},
+        {"displayClock", stepClock, displayClock, true},
+        {"displayMenu", stepMenu, displayMenu, true},
+    };
+
+    std::vector<BenchCase> cases;
+    for (const LoopCase &c : loopCases)
+        cases.push_back({c.name, c, 0, {}, 0, 0});
+
+    // Кожен екран налаштувань окремо
+    for (int option = 0; option < SETTINGS_SCREENS; option++)
+        cases.push_back({std::string("displayActionMenu/") + OPTION_NAMES[option],
+                         {nullptr, stepSettings, displayActionMenu, true},
+                         option,
+                         {},
+                         0,
+                         0});
+
+    std::vector<LoopResult> results = runCases(cases, rounds);
+
+    std::map<std::string, LoopResult> baseline;
+    if (baselinePath && !loadBaseline(baselinePath, baseline))
+    {
+        printf("baseline:         can't read %s\n", baselinePath);
+        return 2;
+    }
+
+    printf("%-32s %10s %8s %9s\n", "function", "ns/op", "heap/op", "bytes/op");
+    uint32_t regressions = 0;
+    for (const LoopResult &result : results)
+    {
+        const char *verdict = "";
+        auto base = baseline.find(result.name);
+        if (base != baseline.end())
+        {
+            const LoopResult &b = base->second;
+            if (regressed(result.nsPerOp, b.nsPerOp, margin) || regressed(result.heapPerOp, b.heapPerOp, 0) ||
+                regressed(result.bytesPerOp, b.bytesPerOp, 0))
+            {
+                verdict = "  REGRESSED";
+                regressions++;
+            }
+        }
+        else if (baselinePath)
+            verdict = "  (not in baseline)";
+
+        printf("%-32s %10.1f %8.3f %9.1f%s\n", result.name.c_str(), result.nsPerOp, result.heapPerOp,
+               result.bytesPerOp, verdict);
+    }
+
+    if (baselinePath)
+        printf("regressions:      %u (margin %.0f%%)\n", regressions, margin);
+
+    if (savePath && !saveBaseline(savePath, results))
+    {
+        printf("baseline:         can't write %s\n", savePath);
+        return 2;
+    }
+
+    return regressions ? 1 : 0;
+}
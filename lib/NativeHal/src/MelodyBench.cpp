@@ -0,0 +1,62 @@
+// Вартість плеєра мелодій (MelodyPlayer.h) на таймерах та LEDC нативного HAL.
+//
+// Кожна мелодія грає задану кількість секунд, а чип між змінами нот спить
+// легким сном до моменту, який просить плеєр, як в loop() прошивки.
+// Друкується, скільки разів чип прокидався і скільки часу не спав, та час
+// хоста на секунду мелодії. Точність кожної зміни LEDC перевіряє
+// test/test_melody_player.
+#include "MelodyPlayer.h"
+#include "NativeHal.h"
+
+#include <chrono>
+#include <esp_sleep.h>
+#include <stdio.h>
+
+#define BENCH_PIN 3
+
+// Зміщення початку мелодії від старту, щоб вона не починалась на круглій
+// мікросекунді, та робота loop() на кожному пробудженні (кадр, кнопки), мкс
+#define START_OFFSET_US 12345
+#define LOOP_WORK_US 900
+
+static void runMelody(const Melody &melody, int seconds)
+{
+    hal::begin();
+
+    MelodyPlayer player;
+    player.begin(BENCH_PIN);
+    hal::advanceUs(START_OFFSET_US);
+
+    hal::setLedcLogging(true);
+    uint64_t start = hal::nowUs();
+    uint64_t end = start + (uint64_t)seconds * 1000000;
+    player.play(melody);
+
+    uint64_t soundingUs = 0;
+    auto hostStart = std::chrono::steady_clock::now();
+    while (hal::nowUs() < end)
+    {
+        hal::advanceUs(LOOP_WORK_US);
+        soundingUs += player.takeSoundingUs();
+
+        esp_sleep_enable_timer_wakeup(player.nextWakeUs());
+        esp_light_sleep_start();
+    }
+    player.stop();
+    soundingUs += player.takeSoundingUs();
+    double hostUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - hostStart).count();
+    hal::finish();
+
+    double simulated = (hal::nowUs() - start) / 1e6;
+    hal::Stats &s = hal::stats;
+    printf("%-6s %5zu changes, %.2f wakes/s, awake %.2f%%, sounding %.1f s, host %.1f us per second\n", melody.name,
+           hal::ledcLog().size(), s.wakes / simulated, 100.0 * s.awakeUs / (hal::nowUs() - start), soundingUs / 1e6,
+           hostUs / simulated);
+}
+
+int runMelodyBench(int seconds)
+{
+    for (const Melody &melody : MELODIES)
+        runMelody(melody, seconds);
+    return 0;
+}
@@ -0,0 +1,1282 @@
+#include "NativeHal.h"
+#include "Arduino.h"
+#include "esp_timer.h"
+#include "esp_pm.h"
+#include "driver/ledc.h"
+#include "hal/gpio_ll.h"
+#include "freertos/task.h"
+
+#include <map>
+#include <new>
+#include <stdlib.h>
+#include <sys/time.h>
+
+// Одноразовий таймер esp_timer (esp_timer_handle_t вказує на нього)
+struct esp_timer
+{
+    esp_timer_cb_t callback;
+    void *arg;
+    bool used;
+    bool armed;
+    uint64_t at; // Віртуальний час спрацювання
+};
+
+// Блокування керування живленням (esp_pm_lock_handle_t вказує на нього)
+struct esp_pm_lock
+{
+    esp_pm_lock_type_t type;
+    bool used;
+    int count; // Скільки разів взяте
+};
+
+namespace hal
+{
+    Stats stats;
+
+    void setPwm(uint8_t pin, int duty);
+
+    namespace
+    {
+        const int PIN_COUNT = 32;
+        const uint64_t NEVER = UINT64_MAX;
+
+        uint64_t now = 0;       // Віртуальний час
+        uint64_t bootAt = 0;    // Момент останнього старту (для millis)
+        uint64_t wakeStart = 0; // Момент останнього пробудження
+
+        int levels[PIN_COUNT];
+        int pwmDuty[PIN_COUNT];
+        uint64_t pwmSince[PIN_COUNT];
+        uint64_t pwmTotal[PIN_COUNT];
+
+        std::multimap<uint64_t, std::pair<uint8_t, int>> events;
+
+        // Таймери esp_timer: фіксований пул, щоб створення таймера не
+        // займало кучу
+        const int TIMER_COUNT = 8;
+        esp_timer timers[TIMER_COUNT];
+        bool inTimer = false;
+
+        // Керування живленням: чи esp_pm підтримується, чи налаштований
+        // (частоти та автоматичний легкий сон), блокування, частота CPU
+        // зараз та сповіщення єдиної задачі прошивки
+        const int PM_LOCK_COUNT = 8;
+        esp_pm_lock pmLocks[PM_LOCK_COUNT];
+        bool pmSupported = false;
+        bool pmConfigured = false;
+        bool pmAuto = false;
+        uint32_t pmMaxMhz = CPU_BOOT_MHZ;
+        uint32_t pmMinMhz = CPU_BOOT_MHZ;
+        uint32_t cpuMhz = CPU_BOOT_MHZ;
+        uint64_t cpuSince = 0;
+        bool taskNotified = false;
+
+        // LEDC: частота таймерів, пін, таймер та шпаринність каналів
+        // (записана ledc_set_duty() і та, що зараз на виході)
+        ledc_clk_cfg_t ledcClock[LEDC_TIMER_MAX];
+        uint32_t ledcFreq[LEDC_TIMER_MAX];
+        int ledcPin[LEDC_CHANNEL_MAX];
+        ledc_timer_t ledcTimer[LEDC_CHANNEL_MAX];
+        uint32_t ledcDuty[LEDC_CHANNEL_MAX];
+        uint32_t ledcOutput[LEDC_CHANNEL_MAX];
+        bool rtc8mOn = false;
+        bool ledcLogging = false;
+        std::vector<LedcChange> ledcChanges;
+
+        // Налаштування пробудження
+        bool timerWakeup = false;
+        uint64_t timerWakeupUs = 0;
+        bool gpioWakeup = false;
+
+        // Як і в GPIO ESP32, тип переривання піна - один регістр і для
+        // обробника, і для пробудження (gpio_wakeup_enable теж його змінює)
+        gpio_int_type_t gpioWakeType[PIN_COUNT];
+        bool gpioWakeEnabled[PIN_COUNT];
+
+        // Обробники переривань (attachInterrupt)
+        void (*isrHandler[PIN_COUNT])(void *);
+        void *isrArg[PIN_COUNT];
+        bool inIsr = false;
+
+        // Під час сну обробники не викликаються: зміни пінів запам'ятовуються
+        // і обробляються одразу після пробудження, як на справжньому чипі
+        bool asleep = false;
+        bool isrPending[PIN_COUNT];
+        int isrPendingLevel[PIN_COUNT];
+        uint64_t deepGpioMask = 0;
+        int deepGpioLevel = HIGH;
+        esp_sleep_wakeup_cause_t wakeupCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+
+        float batteryVoltage = 4.0;
+        uint16_t adcNoise = 0;
+        uint32_t noiseSeed = 1;
+        float temperature = 23.5;
+
+        std::string serialOut;
+        std::string serialIn;
+        bool serialEcho = false;
+
+        // Облік кучі: вимикається всередині HAL, бо на справжньому чипі
+        // події пінів та буфер Serial не займають кучу прошивки
+        bool heapCounting = false;
+        int heapQuiet = 0;
+
+        bool interruptMatches(uint8_t pin, int previous)
+        {
+            int level = levels[pin];
+            switch (gpioWakeType[pin])
+            {
+            case GPIO_INTR_POSEDGE:
+                return previous == LOW && level == HIGH;
+            case GPIO_INTR_NEGEDGE:
+                return previous == HIGH && level == LOW;
+            case GPIO_INTR_ANYEDGE:
+                return previous != level;
+            case GPIO_INTR_LOW_LEVEL:
+                return level == LOW;
+            case GPIO_INTR_HIGH_LEVEL:
+                return level == HIGH;
+            default:
+                return false;
+            }
+        }
+
+        // Викликати обробник, якщо спрацювало переривання. Переривання за
+        // рівнем спрацьовує знову, поки обробник не змінить тип.
+        void checkInterrupt(uint8_t pin, int previous)
+        {
+            if (inIsr || !isrHandler[pin])
+                return;
+
+            for (int guard = 0; guard < 8 && interruptMatches(pin, previous); guard++)
+            {
+                inIsr = true;
+                isrHandler[pin](isrArg[pin]);
+                inIsr = false;
+
+                stats.interrupts++;
+                previous = levels[pin];
+            }
+        }
+
+        void applyLevel(uint8_t pin, int level)
+        {
+            if (pin >= PIN_COUNT)
+                return;
+
+            int previous = levels[pin];
+            levels[pin] = level;
+            if (previous == level)
+                return;
+
+            if (asleep)
+            {
+                if (!isrPending[pin])
+                    isrPendingLevel[pin] = previous;
+                isrPending[pin] = true;
+            }
+            else
+                checkInterrupt(pin, previous);
+        }
+
+        void runPendingInterrupts()
+        {
+            for (int pin = 0; pin < PIN_COUNT; pin++)
+                if (isrPending[pin])
+                {
+                    isrPending[pin] = false;
+                    checkInterrupt(pin, isrPendingLevel[pin]);
+                }
+        }
+
+        void resetGpio()
+        {
+            for (int pin = 0; pin < PIN_COUNT; pin++)
+            {
+                gpioWakeType[pin] = GPIO_INTR_DISABLE;
+                gpioWakeEnabled[pin] = false;
+                isrHandler[pin] = nullptr;
+                isrArg[pin] = nullptr;
+                isrPending[pin] = false;
+            }
+            asleep = false;
+        }
+
+        // Застосувати всі заплановані зміни пінів до моменту until
+        void applyEvents(uint64_t until)
+        {
+            QuietHeap quiet;
+            while (!events.empty() && events.begin()->first <= until)
+            {
+                applyLevel(events.begin()->second.first, events.begin()->second.second);
+                events.erase(events.begin());
+            }
+        }
+
+        bool gpioTriggered(uint8_t pin)
+        {
+            if (!gpioWakeEnabled[pin])
+                return false;
+            if (gpioWakeType[pin] == GPIO_INTR_HIGH_LEVEL)
+                return levels[pin] == HIGH;
+            if (gpioWakeType[pin] == GPIO_INTR_LOW_LEVEL)
+                return levels[pin] == LOW;
+            return false;
+        }
+
+        bool anyGpioTriggered(bool deep)
+        {
+            for (int pin = 0; pin < PIN_COUNT; pin++)
+            {
+                if (deep && (deepGpioMask >> pin & 1) && levels[pin] == deepGpioLevel)
+                    return true;
+                if (!deep && gpioWakeup && gpioTriggered(pin))
+                    return true;
+            }
+            return false;
+        }
+
+        // Найраніший ввімкнений таймер, який настав до моменту until
+        esp_timer *dueTimer(uint64_t until)
+        {
+            esp_timer *first = nullptr;
+            for (esp_timer &timer : timers)
+                if (timer.armed && timer.at <= until && (!first || timer.at < first->at))
+                    first = &timer;
+            return first;
+        }
+
+        void resetTimers()
+        {
+            for (esp_timer &timer : timers)
+                timer = esp_timer();
+        }
+
+        void ledcOutputChanged(int channel)
+        {
+            setPwm(ledcPin[channel], ledcOutput[channel]);
+            if (ledcLogging)
+            {
+                QuietHeap quiet;
+                ledcChanges.push_back({now, (uint8_t)ledcPin[channel], ledcFreq[ledcTimer[channel]], ledcOutput[channel]});
+            }
+        }
+
+        // Чи працює канал в легкому сні: тільки від генератора RTC8M, який
+        // не вимикається на час сну
+        bool ledcRunsAsleep(int channel)
+        {
+            return ledcClock[ledcTimer[channel]] == LEDC_USE_RTC8M_CLK && rtc8mOn;
+        }
+
+        // На час легкого сну канали від інших генераторів замовкають
+        void pauseLedc(bool paused)
+        {
+            for (int channel = 0; channel < LEDC_CHANNEL_MAX; channel++)
+                if (ledcPin[channel] >= 0 && ledcOutput[channel] && !ledcRunsAsleep(channel))
+                    setPwm(ledcPin[channel], paused ? 0 : ledcOutput[channel]);
+        }
+
+        void resetLedc()
+        {
+            for (int channel = 0; channel < LEDC_CHANNEL_MAX; channel++)
+            {
+                if (ledcPin[channel] >= 0)
+                    setPwm(ledcPin[channel], 0);
+                ledcPin[channel] = -1;
+                ledcTimer[channel] = LEDC_TIMER_0;
+                ledcDuty[channel] = ledcOutput[channel] = 0;
+            }
+            for (int timer = 0; timer < LEDC_TIMER_MAX; timer++)
+            {
+                ledcClock[timer] = LEDC_AUTO_CLK;
+                ledcFreq[timer] = 0;
+            }
+            rtc8mOn = false;
+        }
+
+        void setCpu(uint32_t mhz)
+        {
+            if (cpuMhz > CPU_BOOT_MHZ)
+                stats.cpuBoostUs += now - cpuSince;
+            cpuMhz = mhz;
+            cpuSince = now;
+        }
+
+        bool pmHeld(esp_pm_lock_type_t type)
+        {
+            for (esp_pm_lock &lock : pmLocks)
+                if (lock.used && lock.type == type && lock.count)
+                    return true;
+            return false;
+        }
+
+        // З налаштованим esp_pm частота - найбільша, поки взяте блокування
+        // частоти, інакше найменша
+        void updatePmCpu()
+        {
+            if (pmConfigured)
+                setCpu(pmHeld(ESP_PM_CPU_FREQ_MAX) || pmHeld(ESP_PM_APB_FREQ_MAX) ? pmMaxMhz : pmMinMhz);
+        }
+
+        // Автоматичний легкий сон можливий, тільки коли не взяте жодне
+        // блокування
+        bool pmSleepAllowed()
+        {
+            return pmAuto && !pmHeld(ESP_PM_CPU_FREQ_MAX) && !pmHeld(ESP_PM_APB_FREQ_MAX) &&
+                   !pmHeld(ESP_PM_NO_LIGHT_SLEEP);
+        }
+
+        // Після старту чипа esp_pm не налаштований, а CPU на стартовій частоті
+        void resetPm()
+        {
+            for (esp_pm_lock &lock : pmLocks)
+                lock = esp_pm_lock();
+            pmConfigured = pmAuto = false;
+            pmMaxMhz = pmMinMhz = CPU_BOOT_MHZ;
+            cpuMhz = CPU_BOOT_MHZ;
+            cpuSince = now;
+            taskNotified = false;
+        }
+
+        // Перемотати час до найближчого джерела пробудження
+        void sleepUntilWakeup(bool deep, uint64_t &slept)
+        {
+            stats.awakeUs += now - wakeStart;
+            pauseLedc(true);
+
+            uint64_t start = now;
+            asleep = true;
+            uint64_t deadline = timerWakeup ? now + timerWakeupUs : NEVER;
+            bool byGpio = anyGpioTriggered(deep);
+
+            while (!byGpio && !events.empty() && events.begin()->first < deadline)
+            {
+                now = events.begin()->first;
+                applyEvents(now);
+                byGpio = anyGpioTriggered(deep);
+            }
+
+            if (!byGpio && deadline == NEVER)
+                throw Halt();
+
+            if (!byGpio)
+            {
+                now = deadline;
+                applyEvents(now);
+            }
+            asleep = false;
+            pauseLedc(false);
+
+            wakeupCause = byGpio ? ESP_SLEEP_WAKEUP_GPIO : ESP_SLEEP_WAKEUP_TIMER;
+            slept += now - start;
+
+            stats.wakes++;
+            if (byGpio)
+                stats.gpioWakes++;
+            else
+                stats.timerWakes++;
+
+            wakeStart = now;
+            advanceUs(WAKE_OVERHEAD_US);
+        }
+    }
+
+    QuietHeap::QuietHeap()
+    {
+        heapQuiet++;
+    }
+
+    QuietHeap::~QuietHeap()
+    {
+        heapQuiet--;
+    }
+
+    uint64_t nowUs()
+    {
+        return now;
+    }
+
+    void advanceUs(uint64_t us)
+    {
+        uint64_t until = now + us;
+
+        // Таймери, які настали за цей час, спрацьовують у свій момент (або
+        // одразу, якщо настали ще під час сну). Обробник таймера не
+        // переривається іншим таймером.
+        esp_timer *timer;
+        while (!inTimer && (timer = dueTimer(until)))
+        {
+            if (timer->at < now)
+                stats.lateTimerCallbacks++;
+            else
+                now = timer->at;
+            applyEvents(now);
+
+            timer->armed = false;
+            stats.timerCallbacks++;
+            inTimer = true;
+            timer->callback(timer->arg);
+            inTimer = false;
+        }
+
+        now = until;
+        applyEvents(now);
+    }
+
+    void begin()
+    {
+        stats = Stats();
+        now = bootAt = wakeStart = 0;
+        events.clear();
+
+        for (int pin = 0; pin < PIN_COUNT; pin++)
+        {
+            levels[pin] = LOW;
+            pwmDuty[pin] = 0;
+            pwmSince[pin] = 0;
+            pwmTotal[pin] = 0;
+        }
+        resetGpio();
+        resetTimers();
+        resetLedc();
+        resetPm();
+        ledcLogging = false;
+        ledcChanges.clear();
+
+        timerWakeup = false;
+        gpioWakeup = false;
+        deepGpioMask = 0;
+        wakeupCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+
+        serialOut.clear();
+        serialIn.clear();
+    }
+
+    void finish()
+    {
+        stats.awakeUs += now - wakeStart;
+        wakeStart = now;
+        setCpu(cpuMhz);
+
+        for (int pin = 0; pin < PIN_COUNT; pin++)
+        {
+            if (pwmDuty[pin] > 0)
+            {
+                pwmTotal[pin] += now - pwmSince[pin];
+                pwmSince[pin] = now;
+            }
+        }
+    }
+
+    void setPin(uint8_t pin, int level)
+    {
+        applyLevel(pin, level);
+    }
+
+    void schedulePin(uint64_t atUs, uint8_t pin, int level)
+    {
+        events.insert({atUs, {pin, level}});
+    }
+
+    void schedulePress(uint64_t atUs, uint8_t pin, uint32_t durationMs)
+    {
+        schedulePin(atUs, pin, HIGH);
+        schedulePin(atUs + (uint64_t)durationMs * 1000, pin, LOW);
+    }
+
+    uint64_t pwmOnUs(uint8_t pin)
+    {
+        if (pin >= PIN_COUNT)
+            return 0;
+        return pwmTotal[pin] + (pwmDuty[pin] > 0 ? now - pwmSince[pin] : 0);
+    }
+
+    void setLedcLogging(bool enabled)
+    {
+        ledcLogging = enabled;
+    }
+
+    std::vector<LedcChange> &ledcLog()
+    {
+        return ledcChanges;
+    }
+
+    void setBatteryVoltage(float volts)
+    {
+        batteryVoltage = volts;
+    }
+
+    float getBatteryVoltage()
+    {
+        return batteryVoltage;
+    }
+
+    void setAdcNoise(uint16_t lsb)
+    {
+        adcNoise = lsb;
+    }
+
+    void setTemperature(float celsius)
+    {
+        temperature = celsius;
+    }
+
+    float getTemperature()
+    {
+        return temperature;
+    }
+
+    std::string &serialOutput()
+    {
+        return serialOut;
+    }
+
+    void setSerialEcho(bool echo)
+    {
+        serialEcho = echo;
+    }
+
+    void serialInput(const std::string &text)
+    {
+        serialIn += text;
+    }
+
+    // Для esp_sleep.h та Arduino.h нижче
+    void lightSleep()
+    {
+        sleepUntilWakeup(false, stats.lightSleepUs);
+        runPendingInterrupts();
+    }
+
+    [[noreturn]] void deepSleep()
+    {
+        stats.deepSleeps++;
+        setCpu(CPU_BOOT_MHZ);
+        sleepUntilWakeup(true, stats.deepSleepUs);
+
+        // Після глибокого сну чип стартує заново з початковими налаштуваннями
+        bootAt = now;
+        timerWakeup = false;
+        gpioWakeup = false;
+        deepGpioMask = 0;
+        resetGpio();
+        resetTimers();
+        resetLedc();
+        resetPm();
+
+        throw Reset();
+    }
+
+    // Очікування задачі (ulTaskNotifyTake()) до сповіщення або кінця
+    // timeout. З автоматичним легким сном і без блокувань чип спить до
+    // найближчого таймера esp_timer (тому його обробник спрацьовує вчасно),
+    // кінця очікування або кнопки, як в простої FreeRTOS з esp_pm. Інакше
+    // CPU чекає без сну, а переривання та таймери спрацьовують одразу.
+    void waitNotify(uint64_t us)
+    {
+        uint64_t deadline = us == NEVER ? NEVER : now + us;
+        while (!taskNotified && now < deadline)
+        {
+            esp_timer *timer = dueTimer(NEVER);
+            uint64_t until = timer && timer->at < deadline ? max(timer->at, now) : deadline;
+
+            if (pmSleepAllowed())
+            {
+                bool wakeup = timerWakeup;
+                uint64_t wakeupUs = timerWakeupUs;
+                timerWakeup = until != NEVER;
+                timerWakeupUs = until - now;
+
+                sleepUntilWakeup(false, stats.lightSleepUs);
+                timerWakeup = wakeup;
+                timerWakeupUs = wakeupUs;
+                runPendingInterrupts();
+            }
+            else
+            {
+                if (!events.empty() && events.begin()->first < until)
+                    until = max(events.begin()->first, now);
+                if (until == NEVER)
+                    throw Halt();
+                advanceUs(until - now);
+            }
+        }
+    }
+
+    void notifyTask()
+    {
+        taskNotified = true;
+    }
+
+    uint32_t takeNotify(bool clear)
+    {
+        uint32_t value = taskNotified;
+        if (clear)
+            taskNotified = false;
+        return value;
+    }
+
+    void setPmSupported(bool supported)
+    {
+        pmSupported = supported;
+    }
+
+    bool pmAutoSleep()
+    {
+        return pmAuto;
+    }
+
+    esp_err_t configurePm(const esp_pm_config_esp32c3_t *config)
+    {
+        if (!pmSupported)
+            return ESP_ERR_NOT_SUPPORTED;
+        if (config->min_freq_mhz > config->max_freq_mhz)
+            return ESP_ERR_INVALID_ARG;
+
+        pmConfigured = true;
+        pmAuto = config->light_sleep_enable;
+        pmMaxMhz = config->max_freq_mhz;
+        pmMinMhz = config->min_freq_mhz;
+        updatePmCpu();
+        return ESP_OK;
+    }
+
+    esp_pm_lock *createPmLock(esp_pm_lock_type_t type)
+    {
+        for (esp_pm_lock &lock : pmLocks)
+            if (!lock.used)
+            {
+                lock = {type, true, 0};
+                return &lock;
+            }
+        return nullptr;
+    }
+
+    void changePmLock(esp_pm_lock *lock, int delta)
+    {
+        lock->count += delta;
+        updatePmCpu();
+    }
+
+    bool pmSupportedNow()
+    {
+        return pmSupported;
+    }
+
+    uint32_t cpuFrequency()
+    {
+        return cpuMhz;
+    }
+
+    void setCpuFrequency(uint32_t mhz)
+    {
+        setCpu(mhz);
+    }
+
+    uint64_t sinceBootUs()
+    {
+        return now - bootAt;
+    }
+
+    uint16_t batteryAdc()
+    {
+        // Зворотнє до формули в прошивці: дільник 1:2.02 та зміщення АЦП
+        float adc = ((batteryVoltage / 2.02) + 0.29) / 3.3 * 4095.0;
+
+        // Рівномірний шум ±adcNoise (детермінований, щоб запуски повторювались)
+        if (adcNoise)
+        {
+            noiseSeed = noiseSeed * 1103515245 + 12345;
+            adc += (int32_t)(noiseSeed >> 16) % (2 * adcNoise + 1) - adcNoise;
+        }
+        return (uint16_t)max(0.0f, min(4095.0f, adc));
+    }
+
+    int pinLevel(uint8_t pin)
+    {
+        return pin < PIN_COUNT ? levels[pin] : LOW;
+    }
+
+    void setPwm(uint8_t pin, int duty)
+    {
+        if (pin >= PIN_COUNT)
+            return;
+        if (pwmDuty[pin] > 0)
+            pwmTotal[pin] += now - pwmSince[pin];
+        pwmDuty[pin] = duty;
+        pwmSince[pin] = now;
+    }
+
+    esp_timer *createTimer(esp_timer_cb_t callback, void *arg)
+    {
+        for (esp_timer &timer : timers)
+            if (!timer.used)
+            {
+                timer = {callback, arg, true, false, 0};
+                return &timer;
+            }
+        return nullptr;
+    }
+
+    void startTimer(esp_timer *timer, uint64_t us)
+    {
+        timer->armed = true;
+        timer->at = now + us;
+    }
+
+    void setLedcTimer(ledc_timer_t timer, ledc_clk_cfg_t clock, uint32_t freq)
+    {
+        ledcClock[timer] = clock;
+        ledcFreq[timer] = freq;
+    }
+
+    void setLedcFreq(ledc_timer_t timer, uint32_t freq)
+    {
+        ledcFreq[timer] = freq;
+    }
+
+    void setLedcChannel(ledc_channel_t channel, int pin, ledc_timer_t timer, uint32_t duty)
+    {
+        ledcPin[channel] = pin;
+        ledcTimer[channel] = timer;
+        ledcDuty[channel] = ledcOutput[channel] = duty;
+        ledcOutputChanged(channel);
+    }
+
+    void setLedcDuty(ledc_channel_t channel, uint32_t duty)
+    {
+        ledcDuty[channel] = duty;
+    }
+
+    // Записана шпаринність (або duty, якщо канал зупиняється) йде на вихід
+    void updateLedc(ledc_channel_t channel, bool stop)
+    {
+        if (ledcPin[channel] < 0)
+            return;
+        ledcOutput[channel] = stop ? 0 : ledcDuty[channel];
+        ledcOutputChanged(channel);
+    }
+
+    void setRtc8m(bool on)
+    {
+        rtc8mOn = on;
+    }
+
+    void setTimerWakeup(uint64_t us)
+    {
+        timerWakeup = true;
+        timerWakeupUs = us;
+    }
+
+    void disableTimerWakeup()
+    {
+        timerWakeup = false;
+    }
+
+    void setGpioWakeup(bool enabled)
+    {
+        gpioWakeup = enabled;
+    }
+
+    void setInterruptType(uint8_t pin, gpio_int_type_t type)
+    {
+        if (pin >= PIN_COUNT)
+            return;
+
+        // Переривання за рівнем, який вже є на піні, спрацьовує одразу
+        gpioWakeType[pin] = type;
+        checkInterrupt(pin, levels[pin]);
+    }
+
+    void setGpioWakeType(uint8_t pin, gpio_int_type_t type)
+    {
+        if (pin >= PIN_COUNT)
+            return;
+
+        gpioWakeEnabled[pin] = type != GPIO_INTR_DISABLE;
+        setInterruptType(pin, type);
+    }
+
+    void disableGpioWake(uint8_t pin)
+    {
+        if (pin < PIN_COUNT)
+            gpioWakeEnabled[pin] = false;
+    }
+
+    void notInInterrupt(const char *function)
+    {
+        if (!inIsr)
+            return;
+
+        // На чипі код драйверів лежить у флеші, а під час запису флешу кеш
+        // вимкнений: виклик з переривання рано чи пізно закінчиться панікою
+        fprintf(stderr, "panic: %s() called from an interrupt handler\n", function);
+        abort();
+    }
+
+    void attachInterrupt(uint8_t pin, void (*handler)(void *), void *arg, int mode)
+    {
+        if (pin >= PIN_COUNT)
+            return;
+
+        isrHandler[pin] = handler;
+        isrArg[pin] = arg;
+
+        // Режими Arduino: молодші 3 біти - тип переривання, 0x08 - ще й
+        // пробудження (ONLOW_WE\ONHIGH_WE)
+        if (mode & 0x08)
+            setGpioWakeType(pin, (gpio_int_type_t)(mode & 0x07));
+        else
+            setInterruptType(pin, (gpio_int_type_t)(mode & 0x07));
+    }
+
+    void detachInterrupt(uint8_t pin)
+    {
+        if (pin >= PIN_COUNT)
+            return;
+
+        isrHandler[pin] = nullptr;
+        gpioWakeType[pin] = GPIO_INTR_DISABLE;
+    }
+
+    void setDeepGpioWakeup(uint64_t mask, int level)
+    {
+        deepGpioMask = mask;
+        deepGpioLevel = level;
+    }
+
+    esp_sleep_wakeup_cause_t cause()
+    {
+        return wakeupCause;
+    }
+
+    void serialWrite(uint8_t c)
+    {
+        QuietHeap quiet;
+        serialOut += (char)c;
+        if (serialEcho)
+            putchar(c);
+    }
+
+    void setHeapCounting(bool enabled)
+    {
+        heapCounting = enabled;
+    }
+
+    bool countHeap()
+    {
+        return heapCounting && heapQuiet == 0;
+    }
+
+    int serialAvailable()
+    {
+        return serialIn.size();
+    }
+
+    int serialRead()
+    {
+        if (serialIn.empty())
+            return -1;
+        QuietHeap quiet;
+        int c = (uint8_t)serialIn[0];
+        serialIn.erase(0, 1);
+        return c;
+    }
+}
+
+// ---- Куча ----
+
+void *operator new(size_t size)
+{
+    if (hal::countHeap())
+        hal::stats.heapAllocs++;
+
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    if (p && hal::countHeap())
+        hal::stats.heapFrees++;
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+// ---- Arduino API ----
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    (void)pin;
+    (void)mode;
+}
+
+int digitalRead(uint8_t pin)
+{
+    return hal::pinLevel(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    hal::setPwm(pin, 0);
+    hal::setPin(pin, value);
+}
+
+uint16_t analogRead(uint8_t pin)
+{
+    hal::stats.adcReads++;
+    hal::advanceUs(hal::ADC_READ_US);
+    return pin == 4 ? hal::batteryAdc() : 0;
+}
+
+void analogWrite(uint8_t pin, int value)
+{
+    hal::setPwm(pin, value);
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode)
+{
+    hal::attachInterrupt(pin, (void (*)(void *))handler, nullptr, mode);
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void *arg, int mode)
+{
+    hal::attachInterrupt(pin, handler, arg, mode);
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    hal::detachInterrupt(pin);
+}
+
+unsigned long millis()
+{
+    // Як і на ESP32, лічильник 32-бітний і переповнюється через ~49.7 днів
+    return (uint32_t)(hal::sinceBootUs() / 1000);
+}
+
+unsigned long micros()
+{
+    return (uint32_t)hal::sinceBootUs();
+}
+
+// Системний час ESP32 йде від RTC таймера і не скидається глибоким сном,
+// тому тут він рахується від початку симуляції, а не від старту прошивки
+extern "C" int gettimeofday(struct timeval *tv, void *tz)
+{
+    (void)tz;
+    tv->tv_sec = hal::nowUs() / 1000000;
+    tv->tv_usec = hal::nowUs() % 1000000;
+    return 0;
+}
+
+bool setCpuFrequencyMhz(uint32_t cpu_freq_mhz)
+{
+    // Частоти ESP32-C3: від PLL (160, 80) або дільники XTAL 40 МГц
+    switch (cpu_freq_mhz)
+    {
+    case 160:
+    case 80:
+    case 40:
+    case 20:
+    case 10:
+        hal::setCpuFrequency(cpu_freq_mhz);
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint32_t getCpuFrequencyMhz()
+{
+    return hal::cpuFrequency();
+}
+
+void delay(uint32_t ms)
+{
+    hal::advanceUs((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    hal::advanceUs(us);
+}
+
+// ---- Serial ----
+
+HardwareSerial Serial;
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    hal::serialWrite(c);
+    return 1;
+}
+
+int HardwareSerial::available()
+{
+    return hal::serialAvailable();
+}
+
+int HardwareSerial::read()
+{
+    return hal::serialRead();
+}
+
+// ---- esp_sleep ----
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us)
+{
+    hal::setTimerWakeup(time_in_us);
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup()
+{
+    hal::setGpioWakeup(true);
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source)
+{
+    if (source == ESP_SLEEP_WAKEUP_TIMER || source == ESP_SLEEP_WAKEUP_ALL)
+        hal::disableTimerWakeup();
+    if (source == ESP_SLEEP_WAKEUP_GPIO || source == ESP_SLEEP_WAKEUP_ALL)
+        hal::setGpioWakeup(false);
+    return ESP_OK;
+}
+
+esp_err_t esp_deep_sleep_enable_gpio_wakeup(uint64_t gpio_pin_mask, esp_deepsleep_gpio_wake_up_mode_t mode)
+{
+    hal::setDeepGpioWakeup(gpio_pin_mask, mode == ESP_GPIO_WAKEUP_GPIO_HIGH ? HIGH : LOW);
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    hal::notInInterrupt("gpio_wakeup_enable");
+    hal::setGpioWakeType(gpio_num, intr_type);
+    return ESP_OK;
+}
+
+// ---- hal/gpio_ll.h ----
+
+struct gpio_dev_s
+{
+};
+
+gpio_dev_t GPIO;
+
+void gpio_ll_wakeup_enable(gpio_dev_t *hw, gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    (void)hw;
+    hal::setGpioWakeType(gpio_num, intr_type);
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio_num)
+{
+    hal::disableGpioWake(gpio_num);
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_pd_config(esp_sleep_pd_domain_t domain, esp_sleep_pd_option_t option)
+{
+    if (domain == ESP_PD_DOMAIN_RTC8M)
+        hal::setRtc8m(option == ESP_PD_OPTION_ON);
+    return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start()
+{
+    hal::lightSleep();
+    return ESP_OK;
+}
+
+void esp_deep_sleep_start()
+{
+    hal::deepSleep();
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause()
+{
+    return hal::cause();
+}
+
+// ---- esp_timer ----
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+    *out_handle = hal::createTimer(create_args->callback, create_args->arg);
+    return *out_handle ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    if (!timer || timer->armed)
+        return ESP_ERR_INVALID_STATE;
+    hal::startTimer(timer, timeout_us);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (!timer || !timer->armed)
+        return ESP_ERR_INVALID_STATE;
+    timer->armed = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    if (!timer || timer->armed)
+        return ESP_ERR_INVALID_STATE;
+    timer->used = false;
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time()
+{
+    return hal::sinceBootUs();
+}
+
+// ---- esp_pm ----
+
+esp_err_t esp_pm_configure(const void *config)
+{
+    return hal::configurePm((const esp_pm_config_esp32c3_t *)config);
+}
+
+esp_err_t esp_pm_lock_create(esp_pm_lock_type_t lock_type, int arg, const char *name, esp_pm_lock_handle_t *out_handle)
+{
+    (void)arg;
+    (void)name;
+    if (!hal::pmSupportedNow())
+        return ESP_ERR_NOT_SUPPORTED;
+    *out_handle = hal::createPmLock(lock_type);
+    return *out_handle ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t handle)
+{
+    if (!handle || !handle->used)
+        return ESP_ERR_INVALID_ARG;
+    hal::changePmLock(handle, 1);
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t handle)
+{
+    if (!handle || !handle->used)
+        return ESP_ERR_INVALID_ARG;
+    if (!handle->count)
+        return ESP_ERR_INVALID_STATE;
+    hal::changePmLock(handle, -1);
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_delete(esp_pm_lock_handle_t handle)
+{
+    if (!handle || !handle->used || handle->count)
+        return ESP_ERR_INVALID_STATE;
+    handle->used = false;
+    return ESP_OK;
+}
+
+// ---- FreeRTOS ----
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    // Прошивка має одну задачу (loop())
+    static int loopTask;
+    return &loopTask;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait)
+{
+    hal::waitNotify(ticksToWait == portMAX_DELAY ? UINT64_MAX : (uint64_t)ticksToWait * 1000 * portTICK_PERIOD_MS);
+    return hal::takeNotify(clearCountOnExit);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken)
+{
+    (void)task;
+    hal::notifyTask();
+    if (higherPriorityTaskWoken)
+        *higherPriorityTaskWoken = pdTRUE;
+}
+
+// ---- LEDC ----
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *timer_conf)
+{
+    if (timer_conf->timer_num >= LEDC_TIMER_MAX)
+        return ESP_ERR_INVALID_ARG;
+    hal::setLedcTimer(timer_conf->timer_num, timer_conf->clk_cfg, timer_conf->freq_hz);
+    return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *ledc_conf)
+{
+    if (ledc_conf->channel >= LEDC_CHANNEL_MAX || ledc_conf->timer_sel >= LEDC_TIMER_MAX)
+        return ESP_ERR_INVALID_ARG;
+    hal::setLedcChannel(ledc_conf->channel, ledc_conf->gpio_num, ledc_conf->timer_sel, ledc_conf->duty);
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_freq(ledc_mode_t speed_mode, ledc_timer_t timer_num, uint32_t freq_hz)
+{
+    (void)speed_mode;
+    if (timer_num >= LEDC_TIMER_MAX || !freq_hz)
+        return ESP_ERR_INVALID_ARG;
+    hal::setLedcFreq(timer_num, freq_hz);
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t duty)
+{
+    (void)speed_mode;
+    if (channel >= LEDC_CHANNEL_MAX)
+        return ESP_ERR_INVALID_ARG;
+    hal::setLedcDuty(channel, duty);
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    (void)speed_mode;
+    if (channel >= LEDC_CHANNEL_MAX)
+        return ESP_ERR_INVALID_ARG;
+    hal::updateLedc(channel, false);
+    return ESP_OK;
+}
+
+esp_err_t ledc_stop(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t idle_level)
+{
+    (void)speed_mode;
+    (void)idle_level;
+    if (channel >= LEDC_CHANNEL_MAX)
+        return ESP_ERR_INVALID_ARG;
+    hal::updateLedc(channel, true);
+    return ESP_OK;
+}
@@ -0,0 +1,146 @@
+// Ядро нативного HAL: віртуальний час, стан пінів, сон та лічильники.
+//
+// Прошивка бачить тільки Arduino\ESP-IDF API, а драйвер (NativeMain.cpp)
+// керує віртуальним часом, подає сигнали на кнопки і читає лічильники.
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "esp_sleep.h"
+
+namespace hal
+{
+    // Кидається з esp_deep_sleep_start(): після пробудження чип починає
+    // з setup(), тому драйвер ловить це і запускає прошивку спочатку
+    struct Reset
+    {
+    };
+
+    // Кидається, якщо чип заснув без жодного джерела пробудження
+    struct Halt
+    {
+    };
+
+    // Оцінка часу роботи CPU на одне пробудження (старт після сну,
+    // оновлення кнопок та логіка) на частоті 10 МГц
+    const uint32_t WAKE_OVERHEAD_US = 1200;
+
+    // Частота CPU після старту (board_build.f_cpu)
+    const uint32_t CPU_BOOT_MHZ = 10;
+
+    // Час одного перетворення АЦП
+    const uint32_t ADC_READ_US = 60;
+
+    // Флеш NVS: запис одного запису (32 байти) та стирання сторінки (4 КБ)
+    const uint32_t FLASH_ENTRY_WRITE_US = 100;
+    const uint32_t FLASH_PAGE_ERASE_US = 45000;
+
+    struct Stats
+    {
+        uint32_t boots = 0;
+        uint32_t wakes = 0;
+        uint32_t timerWakes = 0;
+        uint32_t gpioWakes = 0;
+        uint32_t deepSleeps = 0;
+
+        uint64_t awakeUs = 0;
+        uint64_t lightSleepUs = 0;
+        uint64_t deepSleepUs = 0;
+
+        uint32_t interrupts = 0; // Виклики обробників attachInterrupt
+
+        uint32_t adcReads = 0;
+        uint32_t temperatureReads = 0;
+        uint64_t piezoOnUs = 0;
+
+        // Час, коли CPU працював на частоті вище стартової
+        // (setCpuFrequencyMhz() або блокування ESP_PM_CPU_FREQ_MAX)
+        uint64_t cpuBoostUs = 0;
+
+        // Виклики обробників esp_timer та ті з них, які запізнились, бо
+        // таймер настав, поки чип спав
+        uint32_t timerCallbacks = 0;
+        uint32_t lateTimerCallbacks = 0;
+
+        // Операції з кучею прошивки (new\delete), поки ввімкнено їх облік.
+        // Внутрішні контейнери HAL сюди не входять.
+        uint64_t heapAllocs = 0;
+        uint64_t heapFrees = 0;
+
+        // Флеш NVS (Preferences)
+        uint32_t nvsWrites = 0;        // Записані значення (put*)
+        uint32_t flashEntryWrites = 0; // Записані 32-байтні записи NVS
+        uint32_t flashErases = 0;      // Стирання сторінок
+        uint32_t flashMaxPageErases = 0; // Найбільше стирань однієї сторінки
+    };
+
+    extern Stats stats;
+
+    // Віртуальний час від старту симуляції
+    uint64_t nowUs();
+    // Час, витрачений на роботу (шина, АЦП тощо)
+    void advanceUs(uint64_t us);
+
+    // Початок симуляції: скидання часу, пінів і лічильників
+    void begin();
+    // Фіксує час роботи до цього моменту (для звіту)
+    void finish();
+
+    // Рівень на цифровому піні зараз або у заданий момент
+    void setPin(uint8_t pin, int level);
+    void schedulePin(uint64_t atUs, uint8_t pin, int level);
+    // Натиснути кнопку (HIGH) у момент atUs і відпустити через durationMs
+    void schedulePress(uint64_t atUs, uint8_t pin, uint32_t durationMs);
+
+    // Скільки часу на піні був ненульовий ШІМ (analogWrite або LEDC)
+    uint64_t pwmOnUs(uint8_t pin);
+
+    // Зміна виходу каналу LEDC (ledc_update_duty() або ledc_stop())
+    struct LedcChange
+    {
+        uint64_t atUs; // Віртуальний час
+        uint8_t pin;
+        uint32_t freqHz;
+        uint32_t duty;
+    };
+
+    // Журнал змін LEDC (ведеться, тільки поки ввімкнений)
+    void setLedcLogging(bool enabled);
+    std::vector<LedcChange> &ledcLog();
+
+    // Напруга акумулятора, яку побачить АЦП через дільник
+    void setBatteryVoltage(float volts);
+    float getBatteryVoltage();
+    // Шум АЦП батареї: ±lsb одиниць на кожне читання
+    void setAdcNoise(uint16_t lsb);
+
+    // Температура, яку поверне датчик
+    void setTemperature(float celsius);
+    float getTemperature();
+
+    // Все, що прошивка надрукувала в Serial
+    std::string &serialOutput();
+    // Друкувати Serial одразу в stdout
+    void setSerialEcho(bool echo);
+    // Дані, які "прийдуть" з комп'ютера по Serial
+    void serialInput(const std::string &text);
+
+    // Чи підтримує esp_pm_configure() автоматичний легкий сон (ESP-IDF з
+    // CONFIG_PM_ENABLE). За замовчуванням ні, як в Arduino-ESP32
+    void setPmSupported(bool supported);
+    // Чи прошивка ввімкнула автоматичний легкий сон
+    bool pmAutoSleep();
+
+    // Ввімкнути облік операцій з кучею (stats.heapAllocs\heapFrees)
+    void setHeapCounting(bool enabled);
+
+    // Операції з кучею, поки існує цей об'єкт, не рахуються (для
+    // внутрішніх контейнерів HAL)
+    struct QuietHeap
+    {
+        QuietHeap();
+        ~QuietHeap();
+    };
+}
@@ -0,0 +1,326 @@
+// Драйвер нативної збірки: запускає справжні setup()\loop() прошивки на
+// віртуальному часі і друкує, скільки коштувала симуляція (пробудження,
+// час роботи, трафік I2C, звертання до датчиків).
+//
+// Приклад:
+//   .pio/build/native/program --days 1 --press 1@30:1500
+//   .pio/build/native/program --days 1 --pm-auto
+//   .pio/build/native/program --days 365 --script year.txt
+//   .pio/build/native/program --days 3 --dump-trace trace.txt
+//   .pio/build/native/program --replay-trace serial.log
+//   .pio/build/native/program --bench-face 20
+//   .pio/build/native/program --bench-drift 26
+//   .pio/build/native/program --bench-calendar 100
+//   .pio/build/native/program --bench-melody 60
+//   .pio/build/native/program --baseline bench.txt --bench-loop 2000
+//
+// В тестах (pio test -e native) main() дає тест, тому драйвер не збирається.
+#ifndef PIO_UNIT_TESTING
+
+#include "Arduino.h"
+#include "Adafruit_SSD1306.h"
+#include "EnergyMeter.h"
+#include "NativeHal.h"
+#include "Wire.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void setup();
+void loop();
+int runFaceBench(int rounds);
+int runDriftBench(int weeks);
+int runCalendarBench(int rounds);
+int runMelodyBench(int seconds);
+int runLoopBench(int rounds, const char *baselinePath, const char *savePath, double margin);
+bool loadTraceReplay(const char *path, double &days);
+void applyTraceReplay();
+int reportTraceReplay();
+bool saveTrace(const char *path);
+bool loadSimScript(const char *path);
+void applySimScript();
+int reportSimScript();
+void startSimChecks();
+void checkSimStep(FakePanel &left, FakePanel &right);
+int reportSimChecks();
+
+// Оцінка споживання самої прошивки (main.cpp)
+extern EnergyMeter energy;
+
+// Ємність акумулятора за замовчуванням (README), мА·год
+#define BATTERY_CAPACITY_MAH 2000
+
+// Моделі панелей на шині (адреси як у прошивці)
+static FakePanel leftPanelModel;
+static FakePanel rightPanelModel;
+
+static void usage(const char *program)
+{
+    printf("Usage: %s [--days N] [--press PIN@SECONDS[:MS]] [--temp C] [--battery V] [--adc-noise LSB] [--pm-auto] [--echo]\n", program);
+    printf("       %*s [--script FILE] [--capacity MAH] [--dump-trace FILE] [--replay-trace FILE]\n",
+           (int)strlen(program), "");
+    printf("       %s --bench-face ROUNDS\n", program);
+    printf("       %s --bench-drift WEEKS\n", program);
+    printf("       %s --bench-calendar ROUNDS\n", program);
+    printf("       %s --bench-melody SECONDS\n", program);
+    printf("       %s --bench-loop ROUNDS [--baseline FILE] [--save-baseline FILE] [--margin PERCENT]\n", program);
+}
+
+// Середній струм за моделлю EnergyMeter.h з лічильників HAL та моделей
+// панелей (незалежно від обліку, який веде прошивка), мА
+static double averageMa()
+{
+    hal::Stats &s = hal::stats;
+    double totalUs = hal::nowUs();
+    if (totalUs <= 0)
+        return 0;
+
+    // Заряд в мА·мкс (заряд вимірювань задається в мкА·с)
+    double cpuUs = s.awakeUs > Wire.busUs ? s.awakeUs - Wire.busUs : 0;
+    double charge = CURRENT_CPU_AWAKE_MA * cpuUs + CURRENT_CPU_BOOST_MA * s.cpuBoostUs +
+                    CURRENT_CPU_SLEEP_MA * s.lightSleepUs + CURRENT_CPU_DEEP_MA * s.deepSleepUs +
+                    (CURRENT_CPU_AWAKE_MA + CURRENT_I2C_MA) * Wire.busUs + CURRENT_PIEZO_MA * hal::pwmOnUs(3) +
+                    1000 * (CHARGE_TEMPERATURE_READ_UAS * s.temperatureReads + CHARGE_BATTERY_READ_UAS * s.adcReads);
+
+    return charge / totalUs + CURRENT_BASELINE_MA + leftPanelModel.averageMa() + rightPanelModel.averageMa();
+}
+
+static void report(double days, double capacityMah)
+{
+    hal::Stats &s = hal::stats;
+    double seconds = hal::nowUs() / 1e6;
+
+    printf("simulated:        %.1f s (%.2f days)\n", seconds, days);
+    printf("boots:            %u\n", s.boots);
+    printf("wakes:            %u (timer %u, gpio %u), %.2f per second\n", s.wakes, s.timerWakes, s.gpioWakes,
+           seconds > 0 ? s.wakes / seconds : 0);
+    printf("deep sleeps:      %u\n", s.deepSleeps);
+    printf("gpio interrupts:  %u\n", s.interrupts);
+    printf("awake:            %.3f s (%.3f%%), %.2f ms per wake\n", s.awakeUs / 1e6,
+           seconds > 0 ? 100.0 * s.awakeUs / hal::nowUs() : 0, s.wakes ? s.awakeUs / 1e3 / s.wakes : 0);
+    printf("i2c written:      %llu bytes in %u transactions (bus busy %.3f s)\n",
+           (unsigned long long)Wire.bytesWritten, Wire.transactions, Wire.busUs / 1e6);
+    printf("i2c clock:        %lu Hz, %u changes, longest transaction %u us\n", (unsigned long)Wire.getClock(),
+           Wire.clockChanges, Wire.longestUs);
+    printf("i2c left oled:    %llu bytes\n", (unsigned long long)Wire.bytesTo[0x3D]);
+    printf("i2c right oled:   %llu bytes\n", (unsigned long long)Wire.bytesTo[0x3C]);
+    printf("i2c bmp280:       %llu bytes written, %llu read\n", (unsigned long long)Wire.bytesTo[0x76],
+           (unsigned long long)Wire.bytesRead);
+    printf("heap in loop():   %llu allocs, %llu frees, %.2f per wake\n", (unsigned long long)s.heapAllocs,
+           (unsigned long long)s.heapFrees, s.wakes ? (double)(s.heapAllocs + s.heapFrees) / s.wakes : 0);
+    printf("temperature reads: %u\n", s.temperatureReads);
+    printf("adc reads:        %u\n", s.adcReads);
+    printf("piezo on:         %.1f s\n", hal::pwmOnUs(3) / 1e6);
+    printf("power:            %s, cpu above %u MHz %.3f s\n",
+           hal::pmAutoSleep() ? "esp_pm automatic light sleep" : "manual light sleep", hal::CPU_BOOT_MHZ,
+           s.cpuBoostUs / 1e6);
+    printf("esp_timer:        %u callbacks, %u late\n", s.timerCallbacks, s.lateTimerCallbacks);
+    printf("nvs writes:       %u (%u entries, %u page erases, at most %u per page)\n", s.nvsWrites,
+           s.flashEntryWrites, s.flashErases, s.flashMaxPageErases);
+    printf("oled lit:         left %.1f s, right %.1f s\n", leftPanelModel.litTimeUs() / 1e6,
+           rightPanelModel.litTimeUs() / 1e6);
+    printf("oled current:     left %.3f mA, right %.3f mA\n", leftPanelModel.averageMa(), rightPanelModel.averageMa());
+
+    double ma = averageMa();
+    printf("battery:          %.3f mA average, %.1f days on %.0f mAh (clock's own estimate %.3f mA)\n", ma,
+           ma > 0 ? capacityMah / ma / 24 : 0, capacityMah, energy.estimate().total / 24);
+}
+
+int main(int argc, char **argv)
+{
+    double days = 1;
+
+    // --bench-loop запускається після розбору всіх параметрів, бо його
+    // налаштування можуть йти після нього
+    int loopRounds = 0;
+    const char *baselinePath = nullptr;
+    const char *savePath = nullptr;
+    double margin = 50;
+
+    const char *dumpPath = nullptr;
+    const char *replayPath = nullptr;
+    double capacityMah = BATTERY_CAPACITY_MAH;
+
+    hal::begin();
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (!strcmp(arg, "--days") && value)
+        {
+            days = atof(value);
+            i++;
+        }
+        else if (!strcmp(arg, "--press") && value)
+        {
+            // PIN@SECONDS[:MS]
+            unsigned pin = 0, ms = 200;
+            double at = 0;
+            if (sscanf(value, "%u@%lf:%u", &pin, &at, &ms) < 2)
+            {
+                usage(argv[0]);
+                return 2;
+            }
+            hal::schedulePress((uint64_t)(at * 1e6), pin, ms);
+            i++;
+        }
+        else if (!strcmp(arg, "--temp") && value)
+        {
+            hal::setTemperature(atof(value));
+            i++;
+        }
+        else if (!strcmp(arg, "--battery") && value)
+        {
+            hal::setBatteryVoltage(atof(value));
+            i++;
+        }
+        else if (!strcmp(arg, "--bench-face") && value)
+        {
+            return runFaceBench(atoi(value));
+        }
+        else if (!strcmp(arg, "--bench-drift") && value)
+        {
+            return runDriftBench(atoi(value));
+        }
+        else if (!strcmp(arg, "--bench-calendar") && value)
+        {
+            return runCalendarBench(atoi(value));
+        }
+        else if (!strcmp(arg, "--bench-melody") && value)
+        {
+            return runMelodyBench(atoi(value));
+        }
+        else if (!strcmp(arg, "--bench-loop") && value)
+        {
+            loopRounds = atoi(value);
+            i++;
+        }
+        else if (!strcmp(arg, "--baseline") && value)
+        {
+            baselinePath = value;
+            i++;
+        }
+        else if (!strcmp(arg, "--save-baseline") && value)
+        {
+            savePath = value;
+            i++;
+        }
+        else if (!strcmp(arg, "--margin") && value)
+        {
+            margin = atof(value);
+            i++;
+        }
+        else if (!strcmp(arg, "--adc-noise") && value)
+        {
+            hal::setAdcNoise(atoi(value));
+            i++;
+        }
+        else if (!strcmp(arg, "--dump-trace") && value)
+        {
+            dumpPath = value;
+            i++;
+        }
+        else if (!strcmp(arg, "--replay-trace") && value)
+        {
+            replayPath = value;
+            i++;
+        }
+        else if (!strcmp(arg, "--script") && value)
+        {
+            // Налаштування зі сценарію - до старту прошивки
+            if (!loadSimScript(value))
+                return 2;
+            i++;
+        }
+        else if (!strcmp(arg, "--capacity") && value)
+        {
+            capacityMah = atof(value);
+            i++;
+        }
+        else if (!strcmp(arg, "--pm-auto"))
+        {
+            // ESP-IDF з CONFIG_PM_ENABLE (esp_pm_configure() працює)
+            hal::setPmSupported(true);
+        }
+        else if (!strcmp(arg, "--echo"))
+        {
+            hal::setSerialEcho(true);
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (loopRounds > 0)
+        return runLoopBench(loopRounds, baselinePath, savePath, margin);
+
+    // Відтворення задає входи та тривалість симуляції
+    if (replayPath && !loadTraceReplay(replayPath, days))
+        return 2;
+
+    Wire.attach(0x3D, &leftPanelModel);
+    Wire.attach(0x3C, &rightPanelModel);
+
+    uint64_t endUs = (uint64_t)(days * 86400e6);
+    bool booted = false;
+    auto hostStart = std::chrono::steady_clock::now();
+
+    while (hal::nowUs() < endUs)
+    {
+        try
+        {
+            if (!booted)
+            {
+                hal::stats.boots++;
+                booted = true;
+                setup();
+                startSimChecks();
+            }
+
+            if (replayPath)
+                applyTraceReplay();
+            applySimScript();
+
+            hal::setHeapCounting(true);
+            loop();
+            hal::setHeapCounting(false);
+
+            checkSimStep(leftPanelModel, rightPanelModel);
+        }
+        catch (hal::Reset &)
+        {
+            hal::setHeapCounting(false);
+
+            // Пробудження з глибокого сну: прошивка стартує з setup()
+            booted = false;
+        }
+        catch (hal::Halt &)
+        {
+            hal::setHeapCounting(false);
+            printf("halted: chip went to sleep without a wakeup source\n");
+            break;
+        }
+    }
+
+    hal::finish();
+    double hostSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - hostStart).count();
+    report(days, capacityMah);
+    printf("host time:        %.2f s (%.0fx real time)\n", hostSeconds,
+           hostSeconds > 0 ? hal::nowUs() / 1e6 / hostSeconds : 0);
+
+    int failed = reportSimChecks();
+    failed |= reportSimScript();
+
+    if (dumpPath && !saveTrace(dumpPath))
+        printf("trace:            can't write %s\n", dumpPath);
+    if (replayPath)
+        failed |= reportTraceReplay();
+    return failed;
+}
+#endif
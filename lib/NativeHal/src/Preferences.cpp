@@ -0,0 +1,186 @@
+#include "Preferences.h"
+#include "NativeHal.h"
+
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+namespace
+{
+    // Розділ nvs за замовчуванням: 0x5000 байт = 5 сторінок по 4 КБ,
+    // на сторінці 126 записів по 32 байти (решта - заголовок та бітова мапа)
+    const int NVS_PAGES = 5;
+    const int NVS_PAGE_ENTRIES = 126;
+    const int NVS_ENTRY_SIZE = 32;
+
+    struct Page
+    {
+        int used = 0;        // Записані записи (і живі, і стерті)
+        int live = 0;        // Живі записи
+        uint32_t erases = 0; // Скільки разів сторінку стирали
+    };
+
+    struct Value
+    {
+        std::vector<uint8_t> data;
+        int page = 0;    // Сторінка, на якій лежить значення
+        int entries = 0; // Скільки записів воно займає
+    };
+
+    Page pages[NVS_PAGES];
+    int active = 0; // Сторінка, на яку зараз пишуться записи
+    std::map<std::string, Value> values;
+
+    // Записи одного блобу: індекс, заголовок даних та самі дані
+    int blobEntries(size_t length)
+    {
+        return 2 + (int)((length + NVS_ENTRY_SIZE - 1) / NVS_ENTRY_SIZE);
+    }
+
+    void writeEntries(int count)
+    {
+        hal::stats.flashEntryWrites += count;
+        hal::advanceUs((uint64_t)count * hal::FLASH_ENTRY_WRITE_US);
+    }
+
+    // Перейти на наступну сторінку. Якщо вона вже використана, її живі
+    // записи переносяться (спрощено - назад на ту ж сторінку після
+    // стирання, як і в NVS вони займають нове місце) і сторінка стирається
+    void nextPage()
+    {
+        active = (active + 1) % NVS_PAGES;
+        Page &page = pages[active];
+        if (page.used == 0)
+            return;
+
+        page.erases++;
+        hal::stats.flashErases++;
+        if (page.erases > hal::stats.flashMaxPageErases)
+            hal::stats.flashMaxPageErases = page.erases;
+        hal::advanceUs(hal::FLASH_PAGE_ERASE_US);
+
+        page.used = page.live;
+        writeEntries(page.live);
+    }
+
+    void store(const std::string &key, const void *data, size_t length)
+    {
+        hal::QuietHeap quiet;
+        int entries = blobEntries(length);
+
+        // Старе значення стає стертими записами
+        auto old = values.find(key);
+        if (old != values.end())
+            pages[old->second.page].live -= old->second.entries;
+
+        if (pages[active].used + entries > NVS_PAGE_ENTRIES)
+            nextPage();
+
+        pages[active].used += entries;
+        pages[active].live += entries;
+        writeEntries(entries);
+
+        Value &value = values[key];
+        value.data.assign((const uint8_t *)data, (const uint8_t *)data + length);
+        value.page = active;
+        value.entries = entries;
+        hal::stats.nvsWrites++;
+    }
+}
+
+std::string Preferences::fullKey(const char *key)
+{
+    hal::QuietHeap quiet;
+    return name + "/" + key;
+}
+
+bool Preferences::begin(const char *name, bool readOnly, const char *partitionLabel)
+{
+    (void)partitionLabel;
+    hal::QuietHeap quiet;
+
+    this->name = name;
+    this->readOnly = readOnly;
+    opened = true;
+    return true;
+}
+
+void Preferences::end()
+{
+    opened = false;
+}
+
+bool Preferences::clear()
+{
+    if (!opened || readOnly)
+        return false;
+
+    hal::QuietHeap quiet;
+    std::string prefix = name + "/";
+    for (auto it = values.begin(); it != values.end();)
+    {
+        if (it->first.compare(0, prefix.size(), prefix) == 0)
+        {
+            pages[it->second.page].live -= it->second.entries;
+            it = values.erase(it);
+        }
+        else
+            it++;
+    }
+    return true;
+}
+
+bool Preferences::remove(const char *key)
+{
+    if (!opened || readOnly)
+        return false;
+
+    hal::QuietHeap quiet;
+    auto it = values.find(fullKey(key));
+    if (it == values.end())
+        return false;
+
+    pages[it->second.page].live -= it->second.entries;
+    values.erase(it);
+    return true;
+}
+
+bool Preferences::isKey(const char *key)
+{
+    hal::QuietHeap quiet;
+    return opened && values.count(fullKey(key));
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t length)
+{
+    if (!opened || readOnly || !key || !value || !length)
+        return 0;
+
+    hal::QuietHeap quiet;
+    store(fullKey(key), value, length);
+    return length;
+}
+
+size_t Preferences::getBytesLength(const char *key)
+{
+    hal::QuietHeap quiet;
+    auto it = values.find(fullKey(key));
+    return opened && it != values.end() ? it->second.data.size() : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *buffer, size_t maxLength)
+{
+    hal::QuietHeap quiet;
+    auto it = values.find(fullKey(key));
+    if (!opened || it == values.end())
+        return 0;
+
+    // Як і справжня бібліотека: якщо буфер замалий, нічого не копіюється
+    size_t length = it->second.data.size();
+    if (length > maxLength)
+        return 0;
+
+    memcpy(buffer, it->second.data.data(), length);
+    return length;
+}
@@ -0,0 +1,35 @@
+// Заглушка Preferences (NVS) з моделлю зносу флешу.
+//
+// Значення зберігаються в пам'яті процесу, тому переживають глибокий сон
+// та перезапуск прошивки. Кожен запис рахується так, як його робить NVS:
+// значення займає кілька 32-байтних записів на поточній сторінці, старе
+// значення лише позначається стертим, а коли сторінки закінчуються, найстаріша
+// стирається (живі записи з неї переносяться). Лічильники - в hal::stats.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+class Preferences
+{
+private:
+    std::string name;
+    bool opened = false;
+    bool readOnly = false;
+
+    std::string fullKey(const char *key);
+
+public:
+    bool begin(const char *name, bool readOnly = false, const char *partitionLabel = nullptr);
+    void end();
+
+    bool clear();
+    bool remove(const char *key);
+    bool isKey(const char *key);
+
+    size_t putBytes(const char *key, const void *value, size_t length);
+    size_t getBytesLength(const char *key);
+    size_t getBytes(const char *key, void *buffer, size_t maxLength);
+};
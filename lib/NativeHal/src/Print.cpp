@@ -0,0 +1,108 @@
+#include "Print.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+size_t Print::write(const uint8_t *data, size_t size)
+{
+    size_t written = 0;
+    while (size--)
+        written += write(*data++);
+    return written;
+}
+
+size_t Print::write(const char *text)
+{
+    return write((const uint8_t *)text, strlen(text));
+}
+
+size_t Print::print(const char *text)
+{
+    return write(text);
+}
+
+size_t Print::print(const String &text)
+{
+    return write(text.c_str());
+}
+
+size_t Print::print(char c)
+{
+    return write((uint8_t)c);
+}
+
+size_t Print::print(int value)
+{
+    char text[16];
+    snprintf(text, sizeof(text), "%d", value);
+    return write(text);
+}
+
+size_t Print::print(unsigned int value)
+{
+    char text[16];
+    snprintf(text, sizeof(text), "%u", value);
+    return write(text);
+}
+
+size_t Print::print(long value)
+{
+    char text[24];
+    snprintf(text, sizeof(text), "%ld", value);
+    return write(text);
+}
+
+size_t Print::print(unsigned long value)
+{
+    char text[24];
+    snprintf(text, sizeof(text), "%lu", value);
+    return write(text);
+}
+
+size_t Print::print(double value, int decimals)
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%.*f", decimals, value);
+    return write(text);
+}
+
+size_t Print::println()
+{
+    return write("\r\n");
+}
+
+size_t Print::println(const char *text)
+{
+    return print(text) + println();
+}
+
+size_t Print::println(const String &text)
+{
+    return print(text) + println();
+}
+
+size_t Print::println(int value)
+{
+    return print(value) + println();
+}
+
+size_t Print::println(unsigned long value)
+{
+    return print(value) + println();
+}
+
+size_t Print::println(double value, int decimals)
+{
+    return print(value, decimals) + println();
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    return write(text);
+}
@@ -0,0 +1,35 @@
+// Спрощений клас Print з Arduino
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "WString.h"
+
+class Print
+{
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *data, size_t size);
+    size_t write(const char *text);
+
+    size_t print(const char *text);
+    size_t print(const String &text);
+    size_t print(char c);
+    size_t print(int value);
+    size_t print(unsigned int value);
+    size_t print(long value);
+    size_t print(unsigned long value);
+    size_t print(double value, int decimals = 2);
+
+    size_t println();
+    size_t println(const char *text);
+    size_t println(const String &text);
+    size_t println(int value);
+    size_t println(unsigned long value);
+    size_t println(double value, int decimals = 2);
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
@@ -0,0 +1,288 @@
+// Перевірки довгої симуляції після кожного loop(): календар, межі режиму сну
+// та будильники.
+//
+// Очікуване рахується тут незалежно від прошивки (дата - gmtime_r() з libc,
+// вікно сну та дні будильників - своїми формулами) з ядра годинника, а
+// порівнюється з тим, що годинник показує: змінні часу та дати, стан панелей
+// на шині та спрацювання будильників. Поки годинник в меню, користувач може
+// змінювати час, тому перевірки чекають повернення на екран годинника і
+// перераховують очікуване з нового часу.
+#include "Adafruit_SSD1306.h"
+#include "Arduino.h"
+#include "AlarmEngine.h"
+#include "ClockCore.h"
+#include "DriftCalibrator.h"
+#include "NativeHal.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Стан прошивки (main.cpp)
+extern ClockCore clockCore;
+extern DriftCalibrator calibrator;
+extern AlarmEngine alarms;
+extern uint32_t previousTime;
+extern int mode, ringing_alarm;
+extern bool alarm_playing;
+extern int hours, minutes, seconds, date, month, year;
+extern bool sleep_on;
+extern int sleep_start_hours, sleep_start_minutes, sleep_start_seconds;
+extern int sleep_end_hours, sleep_end_minutes, sleep_end_seconds;
+
+bool sleepShowing();
+
+// Запізнення будильника, яке ще вважається вчасним (пробудження - на
+// початку секунди будильника), с
+#define ALARM_LATE_TOLERANCE_S 1
+
+// Скільки годинник може піти від віртуального часу понад поправки
+// калібровки, мкс. Момент кроку відомий з точністю millis(), тому кожен
+// крок може відрізнятись ще на CLOCK_STEP_JITTER_US
+#define CLOCK_TOLERANCE_US 1000000
+#define CLOCK_STEP_JITTER_US 2000
+
+struct CheckCounter
+{
+    uint32_t checked = 0;
+    uint32_t wrong = 0;
+    char first[96] = ""; // Перша помилка
+};
+
+static CheckCounter calendar, window, alarmCheck;
+
+static bool started = false;
+static uint64_t lastClockUs = 0;   // Годинник та віртуальний час на
+static uint64_t lastVirtualUs = 0; // минулій перевірці
+static double clockOffUs = 0;      // Відхід понад поправки калібровки
+static double worstOffUs = 0;
+
+static int32_t firstDay = -1, lastDay = -1;
+static uint32_t dayChanges = 0;
+static uint32_t windowWakes = 0;
+
+static uint64_t lastNext = UINT64_MAX; // alarms.next() на минулій перевірці
+static uint64_t expectedAt[ALARM_SLOTS];
+static uint32_t alarmsFired = 0, alarmsLate = 0, alarmsMissed = 0;
+
+// Показ годинника зараз: ядро просунуте до моменту previousTime
+uint64_t clockNowUs()
+{
+    return clockCore.getEpochUs() + (uint64_t)(uint32_t)(millis() - previousTime) * 1000;
+}
+
+static void fail(CheckCounter &counter, const char *what, uint64_t epochSeconds)
+{
+    if (!counter.wrong++)
+    {
+        time_t t = (time_t)epochSeconds;
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        snprintf(counter.first, sizeof(counter.first), "%02d.%02d.%04d %02d:%02d:%02d %s", tm.tm_mday, tm.tm_mon + 1,
+                 tm.tm_year + 1900, tm.tm_hour, tm.tm_min, tm.tm_sec, what);
+    }
+}
+
+// Перше спрацювання будильника slot пізніше секунди after (UINT64_MAX -
+// будильник вимкнений)
+static uint64_t expectedFire(int slot, uint64_t after)
+{
+    const Alarm &alarm = alarms.get(slot);
+    if (alarm.mode == ALARM_OFF)
+        return UINT64_MAX;
+
+    uint32_t timeOfDay = alarm.hours * 3600 + alarm.minutes * 60 + alarm.seconds;
+    for (uint64_t day = after / SECONDS_PER_DAY; day <= after / SECONDS_PER_DAY + 7; day++)
+    {
+        uint64_t at = day * SECONDS_PER_DAY + timeOfDay;
+        time_t t = (time_t)at;
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        if (at > after && (alarm.days >> ((tm.tm_wday + 6) % 7) & 1))
+            return at;
+    }
+    return UINT64_MAX;
+}
+
+// Початок перевірок або повернення з меню: годинник міг бути встановлений
+static void rebase(uint64_t nowS)
+{
+    lastClockUs = clockCore.getEpochUs();
+    lastVirtualUs = hal::nowUs() - (uint64_t)(uint32_t)(millis() - previousTime) * 1000;
+    lastNext = alarms.next();
+    lastDay = -1;
+    for (int slot = 0; slot < ALARM_SLOTS; slot++)
+        expectedAt[slot] = expectedFire(slot, nowS - 1);
+}
+
+static void checkCalendar(uint64_t nowS)
+{
+    // Дата з gmtime_r() тільки при зміні дня, час доби - арифметикою
+    static int32_t cachedDay = -1;
+    static struct tm tm;
+    int32_t today = nowS / SECONDS_PER_DAY;
+    if (today != cachedDay)
+    {
+        time_t t = (time_t)nowS;
+        gmtime_r(&t, &tm);
+        cachedDay = today;
+    }
+    uint32_t timeOfDay = nowS % SECONDS_PER_DAY;
+    tm.tm_hour = timeOfDay / 3600;
+    tm.tm_min = timeOfDay / 60 % 60;
+    tm.tm_sec = timeOfDay % 60;
+
+    calendar.checked++;
+    if (hours != tm.tm_hour || minutes != tm.tm_min || seconds != tm.tm_sec || date != tm.tm_mday ||
+        month != tm.tm_mon + 1 || year != tm.tm_year + 1900)
+    {
+        char shown[48];
+        snprintf(shown, sizeof(shown), "shown as %02d.%02d.%04d %02d:%02d:%02d", date, month, year, hours, minutes,
+                 seconds);
+        fail(calendar, shown, nowS);
+    }
+
+    if (firstDay < 0)
+        firstDay = today;
+    if (lastDay >= 0 && today != lastDay)
+        dayChanges++;
+    lastDay = today;
+
+    // Годинник йде разом з віртуальним часом: крок ядра годинника має бути
+    // в межах поправок калібровки (вдень чи вночі) від кроку віртуального
+    // часу до того ж моменту (previousTime, з точністю millis()), а все, що
+    // поза ними, накопичується
+    uint64_t clockUs = clockCore.getEpochUs();
+    uint64_t virtualUs = hal::nowUs() - (uint64_t)(uint32_t)(millis() - previousTime) * 1000;
+    double step = (double)virtualUs - lastVirtualUs, ticked = (double)clockUs - lastClockUs;
+    int32_t day = calibrator.getPpb(false), night = calibrator.getPpb(true);
+    double low = step * (1 + min(day, night) / 1e9) - CLOCK_STEP_JITTER_US;
+    double high = step * (1 + max(day, night) / 1e9) + CLOCK_STEP_JITTER_US;
+    clockOffUs += ticked < low ? ticked - low : ticked > high ? ticked - high : 0;
+    lastClockUs = clockUs;
+    lastVirtualUs = virtualUs;
+
+    if (fabs(clockOffUs) > fabs(worstOffUs))
+        worstOffUs = clockOffUs;
+    if (fabs(clockOffUs) > CLOCK_TOLERANCE_US)
+        fail(calendar, "clock ran away from simulated time", nowS);
+}
+
+// В межах режиму сну панелі темні, якщо час не показується після SET і
+// будильник не грає.
+// sleeping в прошивці рахується до оновлення годинника, тому в першу секунду
+// після межі панелі ще можуть бути в старому стані
+static void checkWindow(uint64_t nowS, FakePanel &left, FakePanel &right)
+{
+    if (!sleep_on)
+        return;
+
+    const int32_t day = SECONDS_PER_DAY;
+    int32_t start = sleep_start_hours * 3600 + sleep_start_minutes * 60 + sleep_start_seconds;
+    int32_t end = sleep_end_hours * 3600 + sleep_end_minutes * 60 + sleep_end_seconds;
+    int32_t now = nowS % day;
+
+    // Секунди від початку вікна (кінець включно, як в timeInRange())
+    int32_t intoWindow = (now - start + day) % day;
+    bool inside = intoWindow <= (end - start + day) % day;
+    bool edge = intoWindow == 0 || (now - end - 1 + day) % day == 0;
+    if (edge)
+        return;
+
+    windowWakes += inside;
+    window.checked++;
+    bool lit = !inside || sleepShowing() || alarm_playing;
+    if (left.on != lit || right.on != lit)
+        fail(window, lit ? "panels dark outside the sleep window" : "panels lit in the sleep window", nowS);
+}
+
+// Спрацювання видно з того, що найближчий будильник в прошивці змінився, а
+// його момент вже настав
+static void checkAlarms(uint64_t nowS)
+{
+    uint64_t next = alarms.next();
+    if (next != lastNext && lastNext <= nowS)
+    {
+        int slot = ringing_alarm;
+        alarmsFired++;
+        alarmCheck.checked++;
+        bool late = nowS > lastNext + ALARM_LATE_TOLERANCE_S;
+        alarmsLate += late;
+        if (late || expectedAt[slot] != lastNext)
+            fail(alarmCheck, late ? "alarm fired late" : "alarm fired at the wrong time", nowS);
+        expectedAt[slot] = expectedFire(slot, nowS);
+    }
+    lastNext = next;
+
+    // Будильник, який так і не спрацював
+    for (int slot = 0; slot < ALARM_SLOTS; slot++)
+        if (expectedAt[slot] != UINT64_MAX && nowS > expectedAt[slot] + ALARM_MAX_LATE_S)
+        {
+            alarmsMissed++;
+            alarmCheck.checked++;
+            fail(alarmCheck, "alarm missed", expectedAt[slot]);
+            expectedAt[slot] = expectedFire(slot, nowS);
+        }
+}
+
+// Після setup(): перший loop() може одразу заснути глибоким сном (а після
+// пробудження - спрацювати будильник), тому відлік починається ще до нього
+void startSimChecks()
+{
+    if (!started && mode == 0)
+    {
+        started = true;
+        rebase(clockCore.getEpochSeconds());
+    }
+}
+
+// Після кожного loop(), який не закінчився глибоким сном. loop() вже
+// заснув до наступного пробудження, тому показ та панелі порівнюються з
+// годинником на момент їх оновлення (ядро не йде уві сні)
+void checkSimStep(FakePanel &left, FakePanel &right)
+{
+    uint64_t nowS = clockCore.getEpochSeconds();
+
+    // В меню та налаштуваннях показ не годинника, а час може змінюватись
+    if (mode != 0)
+    {
+        started = false;
+        return;
+    }
+    startSimChecks();
+
+    checkCalendar(nowS);
+    checkWindow(nowS, left, right);
+    checkAlarms(nowS);
+}
+
+static void printFirst(const CheckCounter &counter)
+{
+    if (counter.wrong)
+        printf("                  first: %s\n", counter.first);
+}
+
+// Звіт перевірок. Повертає 1, якщо щось не так
+int reportSimChecks()
+{
+    char first[16] = "", last[16] = "";
+    if (firstDay >= 0)
+    {
+        time_t t = (time_t)firstDay * SECONDS_PER_DAY;
+        strftime(first, sizeof(first), "%d.%m.%Y", gmtime(&t));
+        t = (time_t)lastDay * SECONDS_PER_DAY;
+        strftime(last, sizeof(last), "%d.%m.%Y", gmtime(&t));
+    }
+
+    printf("calendar:         %u checks, %u day changes (%s - %s), %u wrong\n", calendar.checked, dayChanges, first,
+           last, calendar.wrong);
+    printFirst(calendar);
+    printf("clock:            %+.3f s against simulated time beyond drift correction at most\n", worstOffUs / 1e6);
+    printf("sleep window:     %u checks (%u inside), %u wrong\n", window.checked, windowWakes, window.wrong);
+    printFirst(window);
+    printf("alarms:           %u fired, %u late, %u missed\n", alarmsFired, alarmsLate, alarmsMissed);
+    printFirst(alarmCheck);
+
+    return calendar.wrong || window.wrong || alarmCheck.wrong ? 1 : 0;
+}
@@ -0,0 +1,393 @@
+// Сценарій входів для довгих симуляцій: натиски кнопок, температура та
+// напруга акумулятора в заданий час годинника (щодня або в заданий день) та
+// налаштування, з якими годинник ввімкнули.
+//
+// Рядок сценарію - подія або налаштування ("#" - коментар до кінця рядка):
+//   daily 07:30:05 press 1 300   щодня о 07:30:05 натиснути SET на 300 мс
+//   daily 04:00 temp 17.5        щодня о 04:00 датчик показує 17.5 °C
+//   day 90 12:00 battery 3.55    на 90-й день (0 - день ввімкнення) о 12:00
+//   date 28.02.2028              дата та час, з яких годинник стартує
+//   time 23:59:00
+//   sleep 23:00 07:00            режим сну (або "sleep off")
+//   alarm 2 06:45 MTWTF..        будильник 2 по буднях (або "alarm 2 off")
+//   seconds on                   показ секунд
+//
+// Час подій - час на годиннику, а не від старту симуляції: подія
+// перераховується в віртуальний час з ядра годинника, тому йде разом з ним
+// і після налаштування часу. Годинник йде швидше за millis() на поправку
+// калібровки (вночі - на нічну), тому натиски, які передаються HAL
+// заздалегідь, перераховуються з тими ж поправками. Поки відкрите меню,
+// ядро стоїть (а на екрані часу показує час, який редагують), тому час
+// сценарію йде далі від віртуального часу і знову бере час з годинника
+// після повернення на його екран.
+#include "AlarmEngine.h"
+#include "ClockCore.h"
+#include "DriftCalibrator.h"
+#include "NativeHal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// Стан та налаштування прошивки (main.cpp)
+extern ClockCore clockCore;
+extern int mode;
+extern DriftCalibrator calibrator;
+extern AlarmEngine alarms;
+extern int hours, minutes, seconds, date, month, year;
+extern bool sleep_on, display_seconds;
+extern int sleep_start_hours, sleep_start_minutes, sleep_start_seconds;
+extern int sleep_end_hours, sleep_end_minutes, sleep_end_seconds;
+
+// Показ годинника зараз (SimChecks.cpp)
+uint64_t clockNowUs();
+
+#define US_PER_DAY 86400000000ULL
+
+// За скільки часу годинника до натиску він передається HAL (чип прокидається
+// хоча б раз за добу, навіть в режимі сну)
+#define SCRIPT_PRESS_LEAD_US US_PER_DAY
+
+// На скільки разова подія може не встигнути до кінця симуляції (годинник
+// відходить від віртуального часу на поправку калібровки та налаштування)
+#define SCRIPT_LATE_US 60000000ULL
+
+enum ScriptAction
+{
+    SCRIPT_PRESS,
+    SCRIPT_TEMPERATURE,
+    SCRIPT_BATTERY
+};
+
+struct ScriptEvent
+{
+    ScriptAction action;
+    bool daily;
+    int day;            // День від ввімкнення (для нещоденних)
+    uint64_t timeOfDay; // Мкс від початку доби годинника
+    float value;        // Пін, °C або В
+    uint32_t pressMs;
+
+    uint64_t atUs;  // Наступний момент на годиннику (0 - ще не рахувався)
+    bool scheduled; // Натиск вже переданий HAL
+    bool done;
+};
+
+static std::vector<ScriptEvent> events;
+static uint64_t firstDayUs = 0; // Початок доби ввімкнення на годиннику
+static uint64_t startUs = 0;    // Годинник та віртуальний час на першій
+static uint64_t startVirtualUs; // події сценарію
+static uint32_t applied = 0;
+
+static uint64_t scriptUs = 0;        // Час сценарію на годиннику та
+static uint64_t scriptVirtualUs = 0; // віртуальний час, коли він рахувався
+
+// Час доби "ГГ:ХХ[:СС]" в мкс (false - не час)
+static bool parseTime(const char *text, uint64_t &us, int parts[3] = nullptr)
+{
+    int h = 0, m = 0, s = 0;
+    if (sscanf(text, "%d:%d:%d", &h, &m, &s) < 2 || h < 0 || h > 23 || m < 0 || m > 59 || s < 0 || s > 59)
+        return false;
+
+    us = ((uint64_t)h * 3600 + m * 60 + s) * 1000000;
+    if (parts)
+    {
+        parts[0] = h;
+        parts[1] = m;
+        parts[2] = s;
+    }
+    return true;
+}
+
+// Дні тижня "MTWTFSS" ("." або "-" - вихідний) в біти AlarmEngine.h
+static bool parseDays(const char *text, uint8_t &days)
+{
+    if (strlen(text) != 7)
+        return false;
+
+    days = 0;
+    for (int i = 0; i < 7; i++)
+        if (text[i] != '.' && text[i] != '-')
+            days |= 1 << i;
+    return true;
+}
+
+// Подія після часу: "press PIN [MS]", "temp C" або "battery V"
+static bool parseEvent(char *words[], int count, ScriptEvent &event)
+{
+    if (count < 2)
+        return false;
+
+    event.value = atof(words[1]);
+    event.pressMs = 200;
+    if (!strcmp(words[0], "press"))
+    {
+        event.action = SCRIPT_PRESS;
+        if (count > 2)
+            event.pressMs = atoi(words[2]);
+    }
+    else if (!strcmp(words[0], "temp"))
+        event.action = SCRIPT_TEMPERATURE;
+    else if (!strcmp(words[0], "battery"))
+        event.action = SCRIPT_BATTERY;
+    else
+        return false;
+    return true;
+}
+
+// Налаштування встановлюються в змінні прошивки до setup(), як початкові
+// значення: після ввімкнення флеш порожній, і setup() бере саме їх
+static bool parseSetting(char *words[], int count)
+{
+    int parts[3];
+    uint64_t us;
+
+    if (!strcmp(words[0], "date") && count == 2)
+        return sscanf(words[1], "%d.%d.%d", &date, &month, &year) == 3;
+
+    if (!strcmp(words[0], "time") && count == 2 && parseTime(words[1], us, parts))
+    {
+        hours = parts[0];
+        minutes = parts[1];
+        seconds = parts[2];
+        return true;
+    }
+
+    if (!strcmp(words[0], "sleep") && count == 2 && !strcmp(words[1], "off"))
+    {
+        sleep_on = false;
+        return true;
+    }
+
+    if (!strcmp(words[0], "sleep") && count == 3 && parseTime(words[1], us, parts))
+    {
+        sleep_start_hours = parts[0];
+        sleep_start_minutes = parts[1];
+        sleep_start_seconds = parts[2];
+        if (!parseTime(words[2], us, parts))
+            return false;
+        sleep_end_hours = parts[0];
+        sleep_end_minutes = parts[1];
+        sleep_end_seconds = parts[2];
+        sleep_on = true;
+        return true;
+    }
+
+    if (!strcmp(words[0], "seconds") && count == 2)
+    {
+        display_seconds = !strcmp(words[1], "on");
+        return true;
+    }
+
+    if (!strcmp(words[0], "alarm") && (count == 3 || count == 4))
+    {
+        int slot = atoi(words[1]) - 1;
+        if (slot < 0 || slot >= ALARM_SLOTS)
+            return false;
+
+        Alarm alarm = alarms.get(slot);
+        if (!strcmp(words[2], "off"))
+            alarm.mode = ALARM_OFF;
+        else if (parseTime(words[2], us, parts))
+        {
+            alarm.mode = ALARM_REPEAT;
+            alarm.days = ALARM_EVERY_DAY;
+            alarm.hours = parts[0];
+            alarm.minutes = parts[1];
+            alarm.seconds = parts[2];
+            if (count == 4 && !parseDays(words[3], alarm.days))
+                return false;
+        }
+        else
+            return false;
+
+        alarms.set(slot, alarm, 0);
+        return true;
+    }
+
+    return false;
+}
+
+bool loadSimScript(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        printf("script:           can't read %s\n", path);
+        return false;
+    }
+
+    char line[160];
+    int number = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file))
+    {
+        number++;
+        char *comment = strchr(line, '#');
+        if (comment)
+            *comment = 0;
+
+        char *words[8];
+        int count = 0;
+        for (char *word = strtok(line, " \t\r\n"); word && count < 8; word = strtok(nullptr, " \t\r\n"))
+            words[count++] = word;
+        if (count == 0)
+            continue;
+
+        ScriptEvent event = {};
+        if (!strcmp(words[0], "daily") && count >= 4)
+        {
+            event.daily = true;
+            ok = parseTime(words[1], event.timeOfDay) && parseEvent(words + 2, count - 2, event);
+        }
+        else if (!strcmp(words[0], "day") && count >= 5)
+        {
+            event.day = atoi(words[1]);
+            ok = event.day >= 0 && parseTime(words[2], event.timeOfDay) && parseEvent(words + 3, count - 3, event);
+        }
+        else
+        {
+            ok = parseSetting(words, count);
+            continue;
+        }
+
+        if (ok)
+            events.push_back(event);
+    }
+    fclose(file);
+
+    if (!ok)
+        printf("script:           can't parse line %d of %s\n", number, path);
+    else
+        printf("script:           %zu events\n", events.size());
+    return ok;
+}
+
+// Наступний момент події на годиннику після now
+static uint64_t nextAtUs(const ScriptEvent &event, uint64_t now)
+{
+    if (!event.daily)
+        return firstDayUs + event.day * US_PER_DAY + event.timeOfDay;
+
+    uint64_t at = now / US_PER_DAY * US_PER_DAY + event.timeOfDay;
+    return at < now ? at + US_PER_DAY : at;
+}
+
+// Скільки віртуального часу пройде, поки годинник пройде від from до to:
+// в межах режиму сну він йде з нічною поправкою, поза ними - з денною
+static uint64_t virtualUsBetween(uint64_t from, uint64_t to)
+{
+    double day = 1 + calibrator.getPpb(false) / 1e9, night = 1 + calibrator.getPpb(true) / 1e9;
+    if (!sleep_on)
+        return (to - from) / day;
+
+    // Межі вікна сну в мкс доби (кінець включно до кінця його секунди)
+    uint64_t start = ((uint64_t)sleep_start_hours * 3600 + sleep_start_minutes * 60 + sleep_start_seconds) * 1000000;
+    uint64_t end = ((uint64_t)sleep_end_hours * 3600 + sleep_end_minutes * 60 + sleep_end_seconds + 1) * 1000000;
+    uint64_t length = (end + US_PER_DAY - start) % US_PER_DAY;
+
+    double virtualUs = 0;
+    for (uint64_t at = from; at < to;)
+    {
+        uint64_t timeOfDay = at % US_PER_DAY;
+        bool inside = (timeOfDay + US_PER_DAY - start) % US_PER_DAY < length;
+
+        // До наступної межі вікна
+        uint64_t boundary = inside ? end : start;
+        uint64_t step = (boundary + US_PER_DAY - timeOfDay) % US_PER_DAY;
+        if (step == 0 || step > to - at)
+            step = to - at;
+
+        virtualUs += step / (inside ? night : day);
+        at += step;
+    }
+    return virtualUs;
+}
+
+// Час сценарію: на екрані годинника - показ годинника, в меню - далі від
+// останнього показу з денною поправкою
+static uint64_t scriptNowUs()
+{
+    uint64_t virtualNow = hal::nowUs();
+    if (mode == 0 || !scriptUs)
+        scriptUs = clockNowUs();
+    else
+        scriptUs += (virtualNow - scriptVirtualUs) * (1 + calibrator.getPpb(false) / 1e9);
+    scriptVirtualUs = virtualNow;
+    return scriptUs;
+}
+
+// Перед кожним loop(): натиски передаються HAL заздалегідь (вони будять
+// чип), а значення датчиків подаються, коли їх час настав
+void applySimScript()
+{
+    if (events.empty())
+        return;
+
+    uint64_t now = scriptNowUs();
+    if (!firstDayUs)
+    {
+        firstDayUs = now / US_PER_DAY * US_PER_DAY;
+        startUs = now;
+        startVirtualUs = hal::nowUs();
+    }
+
+    for (ScriptEvent &event : events)
+    {
+        if (event.done)
+            continue;
+        if (!event.atUs)
+            event.atUs = nextAtUs(event, now);
+
+        if (event.action == SCRIPT_PRESS && !event.scheduled && event.atUs <= now + SCRIPT_PRESS_LEAD_US)
+        {
+            uint64_t inUs = event.atUs > now ? virtualUsBetween(now, event.atUs) : 0;
+            hal::schedulePress(hal::nowUs() + inUs, (uint8_t)event.value, event.pressMs);
+            event.scheduled = true;
+        }
+
+        if (event.atUs > now)
+            continue;
+
+        if (event.action == SCRIPT_TEMPERATURE)
+            hal::setTemperature(event.value);
+        else if (event.action == SCRIPT_BATTERY)
+            hal::setBatteryVoltage(event.value);
+
+        applied++;
+
+        // Щоденна подія - наступного дня, інша - тільки раз
+        event.scheduled = false;
+        event.done = !event.daily;
+        event.atUs = event.daily ? event.atUs + US_PER_DAY : 0;
+    }
+}
+
+// Звіт сценарію. Повертає 1, якщо разова подія, час якої минув за
+// віртуальним часом, так і не відбулась (годинник до неї не дійшов)
+int reportSimScript()
+{
+    if (events.empty())
+        return 0;
+
+    uint64_t expectedUs = startUs + (hal::nowUs() - startVirtualUs);
+    uint32_t pending = 0;
+    const ScriptEvent *first = nullptr;
+    for (const ScriptEvent &event : events)
+    {
+        uint64_t at = firstDayUs + event.day * US_PER_DAY + event.timeOfDay;
+        if (event.daily || event.done || at + SCRIPT_LATE_US > expectedUs)
+            continue;
+        if (!pending++)
+            first = &event;
+    }
+
+    printf("script:           %u events applied, %u never came\n", applied, pending);
+    if (first)
+    {
+        uint32_t s = first->timeOfDay / 1000000;
+        printf("                  first: day %d %02u:%02u:%02u\n", first->day, s / 3600, s / 60 % 60, s % 60);
+    }
+    return pending ? 1 : 0;
+}
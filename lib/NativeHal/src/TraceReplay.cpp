@@ -0,0 +1,192 @@
+// Відтворення журналу подій годинника (TraceRing.h) на нативній збірці.
+//
+// Журнал читається з файлу: виводу команди "t" в Serial (інші рядки логу
+// пропускаються) або --dump-trace. Він друкується по подіях, а його входи -
+// фронти кнопок, температура та напруга акумулятора - подаються прошивці в
+// ті самі моменти від ввімкнення живлення. Виходи (старти, режими, режим
+// сну, будильник) порівнюються з журналом, який прошивка веде під час
+// відтворення, тому видно, з якої події її поведінка розійшлась з годинником.
+#include "NativeHal.h"
+#include "TraceRing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// Журнал прошивки (main.cpp)
+extern TraceRing trace;
+
+// На скільки раніше запису подавати значення датчика: запис зроблений під
+// час вимірювання, а значення має бути на датчику вже до нього
+#define SENSOR_LEAD_MS 1000
+
+// Скільки симулювати після останнього запису
+#define REPLAY_TAIL_MS 60000
+
+// Різниця в часі, з якою вихід ще збігається
+#define OUTPUT_TOLERANCE_MS 1500
+
+// Журнал з файлу та значення датчиків, ще не подані прошивці
+static TraceRing recorded;
+static std::vector<TraceRecord> sensors;
+static size_t nextSensor = 0;
+
+// Вихід прошивки, а не вхід від користувача чи датчиків
+static bool isOutput(uint8_t type)
+{
+    return type == TRACE_BOOT || type == TRACE_MODE || type == TRACE_SLEEPING || type == TRACE_ALARM_START ||
+           type == TRACE_ALARM_STOP;
+}
+
+static void applySensor(const TraceRecord &record)
+{
+    if (record.type == TRACE_TEMPERATURE)
+        hal::setTemperature(record.value / 10.0f);
+    else
+        hal::setBatteryVoltage(record.value / 100.0f);
+}
+
+static void printRecord(const TraceRecord &record)
+{
+    uint32_t ms = record.timeMs;
+    printf("  %3lud %02lu:%02lu:%02lu.%03lu  %-12s", (unsigned long)(ms / 86400000), (unsigned long)(ms / 3600000 % 24),
+           (unsigned long)(ms / 60000 % 60), (unsigned long)(ms / 1000 % 60), (unsigned long)(ms % 1000),
+           TraceRing::eventName(record.type));
+
+    switch (record.type)
+    {
+    case TRACE_BUTTON:
+        printf("pin %ld %s\n", (long)record.value / 2, record.value & 1 ? "HIGH" : "LOW");
+        break;
+    case TRACE_TEMPERATURE:
+        printf("%.1f C\n", record.value / 10.0);
+        break;
+    case TRACE_BATTERY:
+        printf("%.2f V\n", record.value / 100.0);
+        break;
+    default:
+        printf("%ld\n", (long)record.value);
+        break;
+    }
+}
+
+bool loadTraceReplay(const char *path, double &days)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        printf("replay:           can't read %s\n", path);
+        return false;
+    }
+
+    char line[256];
+    bool loaded = false;
+    while (!loaded && fgets(line, sizeof(line), file))
+        loaded = recorded.load(line);
+    fclose(file);
+
+    if (!loaded)
+    {
+        printf("replay:           no complete trace in %s\n", path);
+        return false;
+    }
+
+    printf("trace:            %u bytes, %lu events evicted\n", recorded.size(), (unsigned long)recorded.getEvicted());
+
+    TraceCursor cursor;
+    TraceRecord record;
+    uint32_t lastMs = 0;
+    bool initial[TRACE_EVENT_COUNT] = {};
+
+    recorded.rewind(cursor);
+    while (recorded.next(cursor, record))
+    {
+        printRecord(record);
+        lastMs = record.timeMs;
+
+        if (record.type == TRACE_BUTTON)
+            hal::schedulePin((uint64_t)record.timeMs * 1000, record.value / 2, record.value & 1);
+        else if (record.type == TRACE_TEMPERATURE || record.type == TRACE_BATTERY)
+        {
+            // Перше значення кожного датчика діє з самого початку
+            if (!initial[record.type])
+                applySensor(record);
+            initial[record.type] = true;
+            sensors.push_back(record);
+        }
+    }
+
+    days = (lastMs + REPLAY_TAIL_MS) / 86400e3;
+    return true;
+}
+
+// Подати значення датчиків, час яких настав
+void applyTraceReplay()
+{
+    uint64_t nowMs = hal::nowUs() / 1000;
+    while (nextSensor < sensors.size() && sensors[nextSensor].timeMs <= nowMs + SENSOR_LEAD_MS)
+        applySensor(sensors[nextSensor++]);
+}
+
+// Порівняти виходи записаного журналу та журналу відтворення
+int reportTraceReplay()
+{
+    std::vector<TraceRecord> expected, replayed;
+    TraceCursor cursor;
+    TraceRecord record;
+
+    recorded.rewind(cursor);
+    while (recorded.next(cursor, record))
+        if (isOutput(record.type))
+            expected.push_back(record);
+
+    uint32_t firstMs = expected.empty() ? 0 : expected.front().timeMs;
+    trace.rewind(cursor);
+    while (trace.next(cursor, record))
+        if (isOutput(record.type) && record.timeMs + OUTPUT_TOLERANCE_MS >= firstMs)
+            replayed.push_back(record);
+
+    size_t matched = 0;
+    while (matched < expected.size() && matched < replayed.size())
+    {
+        const TraceRecord &a = expected[matched], &b = replayed[matched];
+        if (a.type != b.type || a.value != b.value || llabs((int64_t)a.timeMs - b.timeMs) > OUTPUT_TOLERANCE_MS)
+            break;
+        matched++;
+    }
+
+    printf("replay:           %zu of %zu outputs matched\n", matched, expected.size());
+    if (matched == expected.size())
+        return 0;
+
+    printf("first divergence:\n  expected\n");
+    printRecord(expected[matched]);
+    printf("  replayed\n");
+    if (matched < replayed.size())
+        printRecord(replayed[matched]);
+    else
+        printf("  nothing\n");
+    return 1;
+}
+
+// Журнал прошивки в файл (той самий вивід, що й команда "t")
+bool saveTrace(const char *path)
+{
+    class FilePrint : public Print
+    {
+    public:
+        FILE *file;
+        using Print::write;
+        size_t write(uint8_t c) override
+        {
+            return fputc(c, file) == EOF ? 0 : 1;
+        }
+    } out;
+
+    out.file = fopen(path, "w");
+    if (!out.file)
+        return false;
+    trace.dump(out);
+    fclose(out.file);
+    return true;
+}
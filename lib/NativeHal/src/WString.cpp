@@ -0,0 +1,177 @@
+#include "WString.h"
+
+#include <stdio.h>
+#include <string.h>
+
+void String::assign(const char *text, size_t length)
+{
+    char *fresh = new char[length + 1];
+    memcpy(fresh, text, length);
+    fresh[length] = '\0';
+
+    delete[] buffer;
+    buffer = fresh;
+    len = length;
+}
+
+String::String(const char *text)
+{
+    assign(text ? text : "", text ? strlen(text) : 0);
+}
+
+String::String(const String &other)
+{
+    assign(other.c_str(), other.len);
+}
+
+String::String(char c)
+{
+    assign(&c, 1);
+}
+
+String::String(int value)
+{
+    char text[16];
+    assign(text, snprintf(text, sizeof(text), "%d", value));
+}
+
+String::String(unsigned int value)
+{
+    char text[16];
+    assign(text, snprintf(text, sizeof(text), "%u", value));
+}
+
+String::String(long value)
+{
+    char text[24];
+    assign(text, snprintf(text, sizeof(text), "%ld", value));
+}
+
+String::String(unsigned long value)
+{
+    char text[24];
+    assign(text, snprintf(text, sizeof(text), "%lu", value));
+}
+
+String::String(float value, unsigned int decimals)
+{
+    char text[32];
+    assign(text, snprintf(text, sizeof(text), "%.*f", decimals, (double)value));
+}
+
+String::String(double value, unsigned int decimals)
+{
+    char text[32];
+    assign(text, snprintf(text, sizeof(text), "%.*f", decimals, value));
+}
+
+String::~String()
+{
+    delete[] buffer;
+}
+
+String &String::operator=(const String &other)
+{
+    if (this != &other)
+        assign(other.c_str(), other.len);
+    return *this;
+}
+
+String &String::operator+=(const String &other)
+{
+    return *this += other.c_str();
+}
+
+String &String::operator+=(const char *text)
+{
+    size_t extra = strlen(text);
+    char *joined = new char[len + extra + 1];
+    memcpy(joined, c_str(), len);
+    memcpy(joined + len, text, extra + 1);
+
+    delete[] buffer;
+    buffer = joined;
+    len += extra;
+    return *this;
+}
+
+String &String::operator+=(char c)
+{
+    char text[2] = {c, '\0'};
+    return *this += text;
+}
+
+char String::operator[](size_t index) const
+{
+    return index < len ? buffer[index] : '\0';
+}
+
+char &String::operator[](size_t index)
+{
+    static char dummy;
+    if (index >= len)
+    {
+        dummy = '\0';
+        return dummy;
+    }
+    return buffer[index];
+}
+
+bool String::operator==(const String &other) const
+{
+    return len == other.len && strcmp(c_str(), other.c_str()) == 0;
+}
+
+void String::remove(size_t index)
+{
+    if (index < len)
+    {
+        buffer[index] = '\0';
+        len = index;
+    }
+}
+
+void String::remove(size_t index, size_t count)
+{
+    if (index >= len)
+        return;
+    if (count > len - index)
+        count = len - index;
+    memmove(buffer + index, buffer + index + count, len - index - count + 1);
+    len -= count;
+}
+
+String operator+(const String &lhs, const String &rhs)
+{
+    String result(lhs);
+    result += rhs;
+    return result;
+}
+
+String operator+(const String &lhs, const char *rhs)
+{
+    String result(lhs);
+    result += rhs;
+    return result;
+}
+
+String operator+(const char *lhs, const String &rhs)
+{
+    String result(lhs);
+    result += rhs;
+    return result;
+}
+
+String operator+(char lhs, const String &rhs)
+{
+    String result(lhs);
+    result += rhs;
+    return result;
+}
+
+String operator+(const String &lhs, char rhs)
+{
+    String result(lhs);
+    result += rhs;
+    return result;
+}
@@ -0,0 +1,49 @@
+// Спрощений клас String з Arduino. Як і на мікроконтролері, кожен рядок
+// зберігається в окремому блоці в купі, тому лічильник виділень пам'яті
+// (NativeHal.h) бачить усі тимчасові рядки прошивки.
+#pragma once
+
+#include <stddef.h>
+
+class String
+{
+private:
+    char *buffer = nullptr;
+    size_t len = 0;
+
+    void assign(const char *text, size_t length);
+
+public:
+    String(const char *text = "");
+    String(const String &other);
+    String(char c);
+    String(int value);
+    String(unsigned int value);
+    String(long value);
+    String(unsigned long value);
+    String(float value, unsigned int decimals = 2);
+    String(double value, unsigned int decimals = 2);
+    ~String();
+
+    String &operator=(const String &other);
+    String &operator+=(const String &other);
+    String &operator+=(const char *text);
+    String &operator+=(char c);
+
+    char operator[](size_t index) const;
+    char &operator[](size_t index);
+    bool operator==(const String &other) const;
+    bool operator!=(const String &other) const { return !(*this == other); }
+
+    size_t length() const { return len; }
+    const char *c_str() const { return buffer ? buffer : ""; }
+
+    void remove(size_t index);
+    void remove(size_t index, size_t count);
+};
+
+String operator+(const String &lhs, const String &rhs);
+String operator+(const String &lhs, const char *rhs);
+String operator+(const char *lhs, const String &rhs);
+String operator+(char lhs, const String &rhs);
+String operator+(const String &lhs, char rhs);
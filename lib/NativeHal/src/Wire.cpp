@@ -0,0 +1,120 @@
+#include "Wire.h"
+#include "NativeHal.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+TwoWire Wire;
+
+void TwoWire::busTime(size_t length)
+{
+    // 9 тактів на байт (8 біт + ACK), ще байт на адресу та старт\стоп
+    uint64_t bits = (uint64_t)(length + 1) * 9 + 2;
+    uint64_t us = (bits * 1000000 + frequency - 1) / frequency;
+    busUs += us;
+    if (us > longestUs)
+        longestUs = us;
+    hal::advanceUs(us);
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency)
+{
+    (void)sda;
+    (void)scl;
+    if (frequency)
+        this->frequency = frequency;
+    return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency)
+{
+    if (frequency != this->frequency)
+        clockChanges++;
+    this->frequency = frequency;
+    return true;
+}
+
+uint32_t TwoWire::getClock()
+{
+    return frequency;
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    txAddress = address;
+    txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+    if (txLength >= I2C_BUFFER_LENGTH)
+        return 0;
+    txBuffer[txLength++] = data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t length)
+{
+    size_t written = 0;
+    while (length-- && write(*data++))
+        written++;
+    return written;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+    (void)sendStop;
+
+    transactions++;
+    bytesWritten += txLength;
+    bytesTo[txAddress & 0x7F] += txLength;
+    busTime(txLength);
+
+    I2CDevice *device = devices[txAddress & 0x7F];
+    if (!device)
+        return 2; // Немає ACK на адресу
+
+    device->receive(txBuffer, txLength);
+    txLength = 0;
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, bool sendStop)
+{
+    (void)sendStop;
+
+    rxIndex = 0;
+    rxLength = 0;
+    transactions++;
+
+    I2CDevice *device = devices[address & 0x7F];
+    if (device)
+        rxLength = device->transmit(rxBuffer, std::min((size_t)quantity, (size_t)I2C_BUFFER_LENGTH));
+
+    bytesRead += rxLength;
+    busTime(rxLength);
+    return rxLength;
+}
+
+int TwoWire::available()
+{
+    return rxLength - rxIndex;
+}
+
+int TwoWire::read()
+{
+    return rxIndex < rxLength ? rxBuffer[rxIndex++] : -1;
+}
+
+void TwoWire::attach(uint8_t address, I2CDevice *device)
+{
+    devices[address & 0x7F] = device;
+}
+
+void TwoWire::resetCounters()
+{
+    bytesWritten = bytesRead = busUs = 0;
+    transactions = longestUs = clockChanges = 0;
+    memset(bytesTo, 0, sizeof(bytesTo));
+}
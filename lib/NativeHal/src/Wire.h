@@ -0,0 +1,73 @@
+// Записуюча заглушка шини I2C.
+//
+// Кожна передача рахується (байти по адресах, кількість транзакцій) і
+// додає до віртуального часу стільки, скільки вона зайняла б на шині
+// з поточною частотою. Пристрої (панелі, датчик) підключаються через attach().
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define I2C_BUFFER_LENGTH 128
+
+// Пристрій на шині, який отримує та віддає байти
+class I2CDevice
+{
+public:
+    virtual ~I2CDevice() {}
+    virtual void receive(const uint8_t *data, size_t length) = 0;
+    virtual size_t transmit(uint8_t *data, size_t length)
+    {
+        (void)data;
+        (void)length;
+        return 0;
+    }
+};
+
+class TwoWire
+{
+private:
+    uint32_t frequency = 100000;
+
+    uint8_t txAddress = 0;
+    uint8_t txBuffer[I2C_BUFFER_LENGTH];
+    size_t txLength = 0;
+
+    uint8_t rxBuffer[I2C_BUFFER_LENGTH];
+    size_t rxLength = 0;
+    size_t rxIndex = 0;
+
+    I2CDevice *devices[128] = {};
+
+    // Час на шині для length байтів (плюс адреса, старт та стоп)
+    void busTime(size_t length);
+
+public:
+    // Лічильники
+    uint64_t bytesWritten = 0;           // Байти даних (без адресного байта)
+    uint64_t bytesRead = 0;              // Прочитані байти
+    uint32_t transactions = 0;           // Кількість передач
+    uint64_t bytesTo[128] = {};          // Байти даних по адресах
+    uint64_t busUs = 0;                  // Час зайнятості шини
+    uint32_t longestUs = 0;              // Найдовша передача
+    uint32_t clockChanges = 0;           // Зміни частоти (setClock() з іншою частотою)
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    bool setClock(uint32_t frequency);
+    uint32_t getClock();
+
+    void beginTransmission(uint8_t address);
+    void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+    size_t write(uint8_t data);
+    size_t write(const uint8_t *data, size_t length);
+    uint8_t endTransmission(bool sendStop = true);
+
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true);
+    int available();
+    int read();
+
+    void attach(uint8_t address, I2CDevice *device);
+    void resetCounters();
+};
+
+extern TwoWire Wire;
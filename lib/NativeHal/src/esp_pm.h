@@ -0,0 +1,34 @@
+// Заглушка керування живленням ESP-IDF.
+//
+// Як і в Arduino-ESP32, де ESP-IDF зібраний без CONFIG_PM_ENABLE,
+// esp_pm_configure() за замовчуванням повертає ESP_ERR_NOT_SUPPORTED.
+// hal::setPmSupported(true) (--pm-auto) вмикає автоматичний режим: поки
+// задача чекає (ulTaskNotifyTake()) і жодне блокування не взяте, чип спить
+// легким сном до найближчого таймера, а CPU_FREQ_MAX підіймає частоту.
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_sleep.h"
+
+typedef struct
+{
+    int max_freq_mhz;
+    int min_freq_mhz;
+    bool light_sleep_enable;
+} esp_pm_config_esp32c3_t;
+
+typedef enum
+{
+    ESP_PM_CPU_FREQ_MAX,
+    ESP_PM_APB_FREQ_MAX,
+    ESP_PM_NO_LIGHT_SLEEP,
+} esp_pm_lock_type_t;
+
+typedef struct esp_pm_lock *esp_pm_lock_handle_t;
+
+esp_err_t esp_pm_configure(const void *config);
+esp_err_t esp_pm_lock_create(esp_pm_lock_type_t lock_type, int arg, const char *name, esp_pm_lock_handle_t *out_handle);
+esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t handle);
+esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t handle);
+esp_err_t esp_pm_lock_delete(esp_pm_lock_handle_t handle);
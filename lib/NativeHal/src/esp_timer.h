@@ -0,0 +1,37 @@
+// Заглушка esp_timer з ESP-IDF.
+//
+// Одноразові таймери спрацьовують у свій момент віртуального часу, поки CPU
+// працює. Як і на справжньому чипі, легкий сон таймери не перериває: таймер,
+// який настав під час сну, спрацює одразу після пробудження (із запізненням).
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_sleep.h"
+
+typedef struct esp_timer *esp_timer_handle_t;
+
+typedef void (*esp_timer_cb_t)(void *arg);
+
+typedef enum
+{
+    ESP_TIMER_TASK,
+    ESP_TIMER_ISR
+} esp_timer_dispatch_t;
+
+typedef struct
+{
+    esp_timer_cb_t callback;
+    void *arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char *name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
+
+// Мікросекунди від старту чипа
+int64_t esp_timer_get_time();
@@ -0,0 +1,10 @@
+// Заглушка сповіщень задач FreeRTOS. Прошивка має одну задачу (loop()),
+// тому сповіщення одне на всю симуляцію. Поки задача чекає, віртуальний
+// час іде як в простої FreeRTOS (див. esp_pm.h).
+#pragma once
+
+#include "FreeRTOS.h"
+
+TaskHandle_t xTaskGetCurrentTaskHandle();
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken);
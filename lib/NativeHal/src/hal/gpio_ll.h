@@ -0,0 +1,15 @@
+// Заглушка hal/gpio_ll.h з ESP-IDF: прямий запис в регістри GPIO.
+//
+// На чипі це inline функції без блокувань, тому їх можна викликати з
+// переривання в IRAM, навіть поки кеш флешу вимкнений (на відміну від
+// gpio_wakeup_enable() з драйвера: заглушка драйвера в перериванні панікує).
+#pragma once
+
+#include "../esp_sleep.h"
+
+typedef struct gpio_dev_s gpio_dev_t;
+extern gpio_dev_t GPIO;
+
+// Тип переривання піна (той самий регістр задає і пробудження) та дозвіл
+// будити чип з легкого сну
+void gpio_ll_wakeup_enable(gpio_dev_t *hw, gpio_num_t gpio_num, gpio_int_type_t intr_type);
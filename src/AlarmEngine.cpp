@@ -0,0 +1,119 @@
+#include "AlarmEngine.h"
+#include "Calendar.h"
+#include "ClockCore.h"
+
+uint64_t AlarmEngine::nextFire(const Alarm &alarm, uint64_t after)
+{
+    if (alarm.mode == ALARM_OFF || !(alarm.days & ALARM_EVERY_DAY))
+        return UINT64_MAX;
+
+    uint32_t secondOfDay = alarm.hours * 3600 + alarm.minutes * 60 + alarm.seconds;
+    uint64_t day = after / SECONDS_PER_DAY;
+
+    // Сьогодні, якщо час ще не минув, або один з наступних семи днів
+    for (int i = 0; i <= 7; i++, day++)
+    {
+        uint64_t at = day * SECONDS_PER_DAY + secondOfDay;
+        if (at > after && (alarm.days >> weekdayFromDays(day) & 1))
+            return at;
+    }
+    return UINT64_MAX;
+}
+
+void AlarmEngine::push(uint8_t slot)
+{
+    // Просіювання вгору
+    int i = heapSize++;
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (fireAt[heap[parent]] <= fireAt[slot])
+            break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = slot;
+}
+
+void AlarmEngine::pop()
+{
+    // Останній елемент займає місце вершини і просіюється вниз
+    uint8_t slot = heap[--heapSize];
+    int i = 0;
+    while (true)
+    {
+        int child = 2 * i + 1;
+        if (child >= heapSize)
+            break;
+        if (child + 1 < heapSize && fireAt[heap[child + 1]] < fireAt[heap[child]])
+            child++;
+        if (fireAt[slot] <= fireAt[heap[child]])
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = slot;
+}
+
+const Alarm &AlarmEngine::get(int slot)
+{
+    return alarms[slot];
+}
+
+void AlarmEngine::set(int slot, const Alarm &alarm, uint64_t now)
+{
+    alarms[slot] = alarm;
+    rebuild(now);
+}
+
+void AlarmEngine::rebuild(uint64_t now)
+{
+    heapSize = 0;
+    for (uint8_t slot = 0; slot < ALARM_SLOTS; slot++)
+    {
+        fireAt[slot] = nextFire(alarms[slot], now);
+        if (fireAt[slot] != UINT64_MAX)
+            push(slot);
+    }
+}
+
+uint64_t AlarmEngine::next()
+{
+    return heapSize ? fireAt[heap[0]] : UINT64_MAX;
+}
+
+bool AlarmEngine::due(uint64_t now)
+{
+    return heapSize && fireAt[heap[0]] <= now;
+}
+
+int AlarmEngine::poll(uint64_t now)
+{
+    while (due(now))
+    {
+        uint8_t slot = heap[0];
+        bool late = now - fireAt[slot] > ALARM_MAX_LATE_S;
+        pop();
+
+        if (alarms[slot].mode == ALARM_ONCE)
+        {
+            alarms[slot].mode = ALARM_OFF;
+            disarmed = true;
+        }
+
+        fireAt[slot] = nextFire(alarms[slot], now);
+        if (fireAt[slot] != UINT64_MAX)
+            push(slot);
+
+        if (!late)
+            return slot;
+    }
+    return -1;
+}
+
+bool AlarmEngine::takeDisarmed()
+{
+    bool result = disarmed;
+    disarmed = false;
+    return result;
+}
@@ -0,0 +1,111 @@
+#include "BatteryMonitor.h"
+
+// Напруга розімкненого кола типового Li-ion елемента при розряді малим
+// струмом. 0% та 100% відповідають тим самим 3.3 В та 4.1 В, що і раніше
+static const BatteryPoint DISCHARGE_CURVE[] = {
+    {3300, 0},
+    {3600, 5},
+    {3690, 10},
+    {3730, 20},
+    {3770, 30},
+    {3790, 40},
+    {3820, 50},
+    {3870, 60},
+    {3920, 70},
+    {3980, 80},
+    {4040, 90},
+    {4100, 100},
+};
+
+static const int CURVE_POINTS = sizeof(DISCHARGE_CURVE) / sizeof(DISCHARGE_CURVE[0]);
+
+void BatteryMonitor::resume(uint32_t now)
+{
+    lastSample = now - period;
+}
+
+int32_t BatteryMonitor::sample()
+{
+    uint32_t sum = 0;
+    for (int i = 0; i < BATTERY_OVERSAMPLING; i++)
+        sum += analogRead(pin);
+
+    // Децимація: сума 4^n читань, зсунута на n, - це одне читання з n
+    // додатковими бітами
+    uint32_t raw = sum >> BATTERY_EXTRA_BITS;
+    const uint32_t full = 4095UL << BATTERY_EXTRA_BITS;
+
+    // Та ж формула, що і для одного читання: 3.3 В шкала АЦП, поправка
+    // 0.29 В та дільник напруги 1:2.02
+    int32_t adcMicrovolts = (int64_t)raw * 3300000 / full - 290000;
+    return (int64_t)adcMicrovolts * 202 / 100;
+}
+
+bool BatteryMonitor::update(uint32_t now)
+{
+    if (sampled && now - lastSample < period)
+        return false;
+
+    int32_t microvolts = sample();
+    lastSample = now;
+
+    // Перше вимірювання береться як є, далі - експоненційне середнє
+    if (!sampled)
+        filtered = microvolts;
+    else
+        filtered += (microvolts - filtered) >> BATTERY_EMA_SHIFT;
+
+    // Гістерезис: показаний заряд не тремтить навколо одного значення,
+    // але крайні 0% та 100% показуються одразу
+    int fresh = chargeFromMillivolts(filtered / 1000);
+    if (!sampled || abs(fresh - charge) >= BATTERY_HYSTERESIS || fresh == 0 || fresh == 100)
+        charge = fresh;
+
+    if (fresh > 0)
+        emptyReadings = 0;
+    else if (emptyReadings < BATTERY_EMPTY_READINGS)
+        emptyReadings++;
+
+    sampled = true;
+    return true;
+}
+
+uint32_t BatteryMonitor::nextWakeMs(uint32_t now)
+{
+    uint32_t elapsed = now - lastSample;
+    return elapsed < period ? period - elapsed : 0;
+}
+
+float BatteryMonitor::getVoltage()
+{
+    return filtered / 1e6;
+}
+
+int BatteryMonitor::getCharge()
+{
+    return charge;
+}
+
+bool BatteryMonitor::isEmpty()
+{
+    return emptyReadings >= BATTERY_EMPTY_READINGS;
+}
+
+int BatteryMonitor::chargeFromMillivolts(int32_t millivolts)
+{
+    if (millivolts <= DISCHARGE_CURVE[0].millivolts)
+        return 0;
+
+    for (int i = 1; i < CURVE_POINTS; i++)
+    {
+        const BatteryPoint &low = DISCHARGE_CURVE[i - 1];
+        const BatteryPoint &high = DISCHARGE_CURVE[i];
+
+        // Лінійна інтерполяція між сусідніми точками
+        if (millivolts < high.millivolts)
+            return low.percent + (millivolts - low.millivolts) * (high.percent - low.percent) /
+                                     (high.millivolts - low.millivolts);
+    }
+
+    return 100;
+}
@@ -0,0 +1,115 @@
+#include "ClockCore.h"
+#include "Calendar.h"
+
+void ClockCore::advance(uint64_t deltaUs, int32_t correctionPpb)
+{
+    // Поправка = deltaUs * ppb / 10^9. Ціла частина додається до часу,
+    // а дробова залишається на наступний раз.
+    int64_t scaled = (int64_t)deltaUs * correctionPpb + remainder;
+    int64_t whole = scaled / PPB;
+    remainder = scaled - whole * PPB;
+
+    epochUs += deltaUs + whole;
+}
+
+void ClockCore::setTime(int hours, int minutes, int seconds)
+{
+    uint64_t day = epochUs / (SECONDS_PER_DAY * MICROS_PER_SECOND);
+    uint32_t secondOfDay = hours * 3600 + minutes * 60 + seconds;
+
+    epochUs = (day * SECONDS_PER_DAY + secondOfDay) * MICROS_PER_SECOND;
+    remainder = 0;
+}
+
+void ClockCore::setDate(int date, int month, int year)
+{
+    if (year < CLOCK_MIN_YEAR)
+        year = CLOCK_MIN_YEAR;
+    else if (year > CLOCK_MAX_YEAR)
+        year = CLOCK_MAX_YEAR;
+
+    uint32_t day = daysFromCivil(year, month, date);
+
+    uint64_t timeOfDay = epochUs % (SECONDS_PER_DAY * MICROS_PER_SECOND);
+    epochUs = (uint64_t)day * SECONDS_PER_DAY * MICROS_PER_SECOND + timeOfDay;
+}
+
+void ClockCore::refresh()
+{
+    uint64_t second = epochUs / MICROS_PER_SECOND;
+    if (second == cachedSecond)
+        return;
+    cachedSecond = second;
+
+    uint32_t secondOfDay = second % SECONDS_PER_DAY;
+    hours = secondOfDay / 3600;
+    minutes = secondOfDay / 60 % 60;
+    seconds = secondOfDay % 60;
+
+    // Дата перераховується тільки раз на добу
+    uint32_t day = second / SECONDS_PER_DAY;
+    if (day == cachedDay)
+        return;
+    cachedDay = day;
+
+    CivilDate civil = civilFromDays(day);
+    year = civil.year;
+    month = civil.month;
+    date = civil.date;
+}
+
+int ClockCore::getHours()
+{
+    refresh();
+    return hours;
+}
+
+int ClockCore::getMinutes()
+{
+    refresh();
+    return minutes;
+}
+
+int ClockCore::getSeconds()
+{
+    refresh();
+    return seconds;
+}
+
+int ClockCore::getDate()
+{
+    refresh();
+    return date;
+}
+
+int ClockCore::getMonth()
+{
+    refresh();
+    return month;
+}
+
+int ClockCore::getYear()
+{
+    refresh();
+    return year;
+}
+
+uint32_t ClockCore::getSecondOfDay()
+{
+    return epochUs / MICROS_PER_SECOND % SECONDS_PER_DAY;
+}
+
+uint32_t ClockCore::getMicrosOfSecond()
+{
+    return epochUs % MICROS_PER_SECOND;
+}
+
+uint64_t ClockCore::getEpochSeconds()
+{
+    return epochUs / MICROS_PER_SECOND;
+}
+
+uint64_t ClockCore::getEpochUs()
+{
+    return epochUs;
+}
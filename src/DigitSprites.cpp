@@ -0,0 +1,97 @@
+#include "DigitSprites.h"
+
+// Індекс символу в кеші або -1, якщо його там немає
+static int spriteIndex(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c == ':')
+        return 10;
+    return -1;
+}
+
+// Скопіювати спрайт в буфер (колонки з кешу накладаються через OR, як
+// прозорий фон в drawChar())
+static void blitSprite(uint8_t *buffer, int16_t bufferWidth, int16_t bufferPages, int16_t x, int16_t y,
+                       const uint8_t *sprite, const SpriteFont &font)
+{
+    // Обрізання по горизонталі
+    int16_t from = x < 0 ? -x : 0;
+    int16_t to = x + font.width > bufferWidth ? bufferWidth - x : font.width;
+    if (from >= to)
+        return;
+
+    int16_t page = y >> 3;
+    uint8_t shift = y & 7;
+
+    for (int p = 0; p < font.pages; p++, page++)
+    {
+        const uint8_t *row = sprite + p * font.width;
+
+        if (shift == 0)
+        {
+            // Вирівняний по сторінках рядок копіюється як є
+            if (page < 0 || page >= bufferPages)
+                continue;
+
+            uint8_t *dst = buffer + page * bufferWidth + x;
+            for (int16_t i = from; i < to; i++)
+                dst[i] |= row[i];
+        }
+        else
+        {
+            // Інакше кожен рядок спрайта лягає на дві сторінки буфера
+            if (page >= 0 && page < bufferPages)
+            {
+                uint8_t *dst = buffer + page * bufferWidth + x;
+                for (int16_t i = from; i < to; i++)
+                    dst[i] |= row[i] << shift;
+            }
+            if (page + 1 >= 0 && page + 1 < bufferPages)
+            {
+                uint8_t *dst = buffer + (page + 1) * bufferWidth + x;
+                for (int16_t i = from; i < to; i++)
+                    dst[i] |= row[i] >> (8 - shift);
+            }
+        }
+    }
+}
+
+int16_t drawSpriteText(Adafruit_SSD1306 &display, int16_t x, int16_t y, const char *text, const SpriteFont &font)
+{
+    uint8_t *buffer = display.getBuffer();
+    int16_t pages = display.height() / 8;
+    bool bold = font.width > 5 * font.scale;
+
+    for (; *text; text++)
+    {
+        int index = spriteIndex(*text);
+        if (index >= 0)
+        {
+            const uint8_t *sprite = font.data + index * font.pages * font.width;
+            blitSprite(buffer, display.width(), pages, x, y, sprite, font);
+        }
+        else
+        {
+            display.drawChar(x, y, *text, WHITE, WHITE, font.scale, font.scale);
+            if (bold)
+                display.drawChar(x + 1, y, *text, WHITE, WHITE, font.scale, font.scale);
+        }
+
+        x += 6 * font.scale;
+    }
+
+    return x;
+}
+
+uint16_t spriteTextPixels(const char *text, const SpriteFont &font)
+{
+    uint16_t lit = 0;
+    for (; *text; text++)
+    {
+        int index = spriteIndex(*text);
+        if (index >= 0)
+            lit += font.lit[index];
+    }
+    return lit;
+}
@@ -0,0 +1,161 @@
+#include "DriftCalibrator.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define US_PER_DAY (86400LL * 1000000LL)
+
+// Заводські значення, до яких тягне регуляризація
+static const double PRIOR_PPB[DRIFT_PARAMS] = {DRIFT_DAY_PPB, DRIFT_NIGHT_PPB, 0};
+static const double PRIOR_WEIGHT[DRIFT_PARAMS] = {DRIFT_PRIOR_S2, DRIFT_PRIOR_S2, DRIFT_PRIOR_Q2};
+
+static double square(double value)
+{
+    return value * value;
+}
+
+// Температурний член поправки на один ppb/°C^2 (нуль при кімнатній
+// температурі)
+static double thermal(float celsius)
+{
+    return square(celsius - DRIFT_TURNOVER_C) - square(DRIFT_ROOM_C - DRIFT_TURNOVER_C);
+}
+
+int32_t DriftCalibrator::getPpb(bool night)
+{
+    double ppb = fit.ppb[night ? 1 : 0] + fit.ppb[2] * thermal(celsius);
+
+    // Поправка більша за 10% - точно не дрифт кварцу
+    if (ppb > 100000000)
+        ppb = 100000000;
+    else if (ppb < -100000000)
+        ppb = -100000000;
+    return (int32_t)lround(ppb);
+}
+
+int32_t DriftCalibrator::correction(uint64_t deltaUs, bool night)
+{
+    int32_t ppb = getPpb(night);
+    double seconds = deltaUs / 1e6;
+
+    x[night ? 1 : 0] += seconds;
+    x[2] += thermal(celsius) * seconds;
+    appliedNs += ppb * seconds;
+
+    return ppb;
+}
+
+void DriftCalibrator::setTemperature(float celsius)
+{
+    if (!isnan(celsius))
+        this->celsius = celsius;
+}
+
+bool DriftCalibrator::userCorrection(int64_t errorUs)
+{
+    // Встановлення часу змінює тільки час доби, тому виправлення через
+    // північ (23:59:59 -> 00:00:01) виглядає як майже доба
+    errorUs %= US_PER_DAY;
+    if (errorUs > US_PER_DAY / 2)
+        errorUs -= US_PER_DAY;
+    else if (errorUs < -US_PER_DAY / 2)
+        errorUs += US_PER_DAY;
+
+    double interval = x[0] + x[1];
+    bool sample = synced && interval >= DRIFT_MIN_INTERVAL_S && llabs(errorUs) <= DRIFT_MAX_PPM * interval;
+
+    if (sample)
+    {
+        // Потрібна за проміжок поправка = вже додана + виправлення
+        // користувача
+        double y = appliedNs + errorUs * 1000.0;
+
+        for (int i = 0; i < DRIFT_PARAMS; i++)
+        {
+            for (int j = 0; j < DRIFT_PARAMS; j++)
+                fit.xtx[i][j] = fit.xtx[i][j] * DRIFT_FORGET + x[i] * x[j];
+            fit.xty[i] = fit.xty[i] * DRIFT_FORGET + x[i] * y;
+        }
+        if (fit.samples < UINT16_MAX)
+            fit.samples++;
+
+        solve();
+    }
+
+    // Новий проміжок починається від встановленого часу
+    synced = true;
+    x[0] = x[1] = x[2] = 0;
+    appliedNs = 0;
+    return sample;
+}
+
+void DriftCalibrator::solve()
+{
+    // (X^T X + W) ppb = X^T y + W prior, метод Гауса з вибором головного
+    // елемента (матриця 3x3, рахується тільки після виправлення часу)
+    double a[DRIFT_PARAMS][DRIFT_PARAMS + 1];
+    for (int i = 0; i < DRIFT_PARAMS; i++)
+    {
+        for (int j = 0; j < DRIFT_PARAMS; j++)
+            a[i][j] = fit.xtx[i][j];
+        a[i][i] += PRIOR_WEIGHT[i];
+        a[i][DRIFT_PARAMS] = fit.xty[i] + PRIOR_WEIGHT[i] * PRIOR_PPB[i];
+    }
+
+    for (int col = 0; col < DRIFT_PARAMS; col++)
+    {
+        int pivot = col;
+        for (int row = col + 1; row < DRIFT_PARAMS; row++)
+            if (fabs(a[row][col]) > fabs(a[pivot][col]))
+                pivot = row;
+        if (pivot != col)
+            for (int j = 0; j <= DRIFT_PARAMS; j++)
+            {
+                double swap = a[col][j];
+                a[col][j] = a[pivot][j];
+                a[pivot][j] = swap;
+            }
+
+        for (int row = col + 1; row < DRIFT_PARAMS; row++)
+        {
+            double factor = a[row][col] / a[col][col];
+            for (int j = col; j <= DRIFT_PARAMS; j++)
+                a[row][j] -= factor * a[col][j];
+        }
+    }
+
+    for (int i = DRIFT_PARAMS - 1; i >= 0; i--)
+    {
+        double sum = a[i][DRIFT_PARAMS];
+        for (int j = i + 1; j < DRIFT_PARAMS; j++)
+            sum -= a[i][j] * fit.ppb[j];
+        fit.ppb[i] = sum / a[i][i];
+    }
+}
+
+void DriftCalibrator::desync()
+{
+    synced = false;
+    x[0] = x[1] = x[2] = 0;
+    appliedNs = 0;
+}
+
+const DriftFit &DriftCalibrator::getFit()
+{
+    return fit;
+}
+
+void DriftCalibrator::restore(const DriftFit &fit)
+{
+    // Пошкоджений запис не повинен зламати хід годинника
+    for (int i = 0; i < DRIFT_PARAMS; i++)
+        if (!isfinite(fit.ppb[i]))
+            return;
+
+    this->fit = fit;
+}
+
+uint16_t DriftCalibrator::getSamples()
+{
+    return fit.samples;
+}
@@ -0,0 +1,163 @@
+#include "EnergyMeter.h"
+
+#define US_PER_HOUR 3600e6
+#define US_PER_DAY 86400e6
+
+void EnergyMeter::accumulate()
+{
+    uint32_t now = micros();
+    uint32_t delta = now - markUs;
+    markUs = now;
+
+    totalUs += delta;
+    if (displayOn)
+    {
+        displayOnUs += delta;
+        oledPixelsUas += oledPixelsUa * delta / 1e6;
+    }
+}
+
+void EnergyMeter::boot()
+{
+    markUs = wakeUs = micros();
+}
+
+void EnergyMeter::wake(esp_sleep_wakeup_cause_t cause)
+{
+    accumulate();
+    wakeUs = markUs;
+
+    if (cause == ESP_SLEEP_WAKEUP_TIMER)
+        timerWakes++;
+    else if (cause == ESP_SLEEP_WAKEUP_GPIO)
+        gpioWakes++;
+    else
+        otherWakes++;
+}
+
+void EnergyMeter::sleep()
+{
+    accumulate();
+    awakeUs += markUs - wakeUs;
+}
+
+void EnergyMeter::resume(uint64_t sleptUs)
+{
+    totalUs += sleptUs;
+    deepSleepUs += sleptUs;
+}
+
+void EnergyMeter::setDisplayOn(bool on)
+{
+    accumulate();
+    displayOn = on;
+}
+
+void EnergyMeter::setOledLoad(int panel, uint16_t litPixels, uint8_t contrast)
+{
+    if (oledPixels[panel] == litPixels && oledContrast == contrast)
+        return;
+
+    accumulate();
+    oledPixels[panel] = litPixels;
+    oledContrast = contrast;
+    oledPixelsUa = (oledPixels[0] + oledPixels[1]) * (CURRENT_OLED_PIXEL_UA + CURRENT_OLED_CONTRAST_UA * contrast);
+}
+
+void EnergyMeter::countPiezoUs(uint32_t us)
+{
+    piezoOnUs += us;
+}
+
+void EnergyMeter::countOledBytes(int panel, uint32_t bytes)
+{
+    oledBytes[panel] += bytes;
+}
+
+void EnergyMeter::countI2CUs(uint32_t us)
+{
+    i2cUs += us;
+}
+
+void EnergyMeter::countBoostUs(uint32_t us)
+{
+    boostUs += us;
+}
+
+void EnergyMeter::countTemperatureRead()
+{
+    temperatureReads++;
+}
+
+void EnergyMeter::countBatteryRead(uint32_t samples)
+{
+    batteryReads += samples;
+}
+
+void EnergyMeter::reset()
+{
+    timerWakes = gpioWakes = otherWakes = 0;
+    totalUs = awakeUs = deepSleepUs = displayOnUs = piezoOnUs = i2cUs = boostUs = 0;
+    oledPixelsUas = 0;
+    oledBytes[0] = oledBytes[1] = 0;
+    temperatureReads = batteryReads = 0;
+    markUs = wakeUs = micros();
+}
+
+EnergyEstimate EnergyMeter::estimate()
+{
+    EnergyEstimate e = {};
+
+    accumulate();
+    float days = totalUs / US_PER_DAY;
+    if (days <= 0)
+        return e;
+
+    // Час передачі по I2C входить в час роботи CPU, тому рахується окремо
+    // від решти роботи
+    float cpuUs = max(0.0f, (float)awakeUs - i2cUs);
+
+    e.cpu = (CURRENT_CPU_AWAKE_MA * cpuUs + CURRENT_CPU_BOOST_MA * boostUs) / US_PER_HOUR / days;
+    e.sleep = (CURRENT_CPU_SLEEP_MA * (totalUs - awakeUs - deepSleepUs) + CURRENT_CPU_DEEP_MA * deepSleepUs) /
+              US_PER_HOUR / days;
+    e.oled = (2 * CURRENT_OLED_IDLE_MA * displayOnUs / US_PER_HOUR + oledPixelsUas / 3600e3) / days;
+    e.i2c = (CURRENT_CPU_AWAKE_MA + CURRENT_I2C_MA) * i2cUs / US_PER_HOUR / days;
+    e.temperature = CHARGE_TEMPERATURE_READ_UAS * temperatureReads / 3600e3 / days;
+    e.battery = CHARGE_BATTERY_READ_UAS * batteryReads / 3600e3 / days;
+    e.piezo = CURRENT_PIEZO_MA * piezoOnUs / US_PER_HOUR / days;
+    e.baseline = CURRENT_BASELINE_MA * 24;
+
+    e.total = e.cpu + e.sleep + e.oled + e.i2c + e.temperature + e.battery + e.piezo + e.baseline;
+    return e;
+}
+
+void EnergyMeter::print(Print &out)
+{
+    EnergyEstimate e = estimate();
+
+    out.println("energy: counters");
+    out.printf("  time        %.1f s\r\n", totalUs / 1e6);
+    out.printf("  awake       %.3f s\r\n", awakeUs / 1e6);
+    out.printf("  deep sleep  %.1f s\r\n", deepSleepUs / 1e6);
+    out.printf("  wakes       timer %lu, gpio %lu, other %lu\r\n", (unsigned long)timerWakes,
+               (unsigned long)gpioWakes, (unsigned long)otherWakes);
+    out.printf("  oled bytes  left %lu, right %lu\r\n", (unsigned long)oledBytes[0], (unsigned long)oledBytes[1]);
+    out.printf("  i2c busy    %.3f s\r\n", i2cUs / 1e6);
+    out.printf("  cpu boost   %.3f s\r\n", boostUs / 1e6);
+    out.printf("  temp reads  %lu\r\n", (unsigned long)temperatureReads);
+    out.printf("  adc reads   %lu\r\n", (unsigned long)batteryReads);
+    out.printf("  display on  %.1f s\r\n", displayOnUs / 1e6);
+    out.printf("  oled pixels left %u, right %u, contrast %u\r\n", oledPixels[0], oledPixels[1], oledContrast);
+    out.printf("  piezo on    %.1f s\r\n", piezoOnUs / 1e6);
+
+    out.println("energy: mAh/day");
+    out.printf("  cpu         %.3f\r\n", e.cpu);
+    out.printf("  sleep       %.3f\r\n", e.sleep);
+    out.printf("  oled        %.3f\r\n", e.oled);
+    out.printf("  i2c         %.3f\r\n", e.i2c);
+    out.printf("  temperature %.3f\r\n", e.temperature);
+    out.printf("  battery adc %.3f\r\n", e.battery);
+    out.printf("  piezo       %.3f\r\n", e.piezo);
+    out.printf("  baseline    %.3f\r\n", e.baseline);
+    out.printf("  total       %.3f\r\n", e.total);
+}
@@ -0,0 +1,68 @@
+#include "Format.h"
+
+#include <math.h>
+#include <string.h>
+
+char *formatNumber(char *out, int32_t value, uint8_t digits, char pad)
+{
+    uint32_t rest = value > 0 ? value : 0;
+
+    // Цифри пишуться з кінця, а на місці старших нулів стоїть pad
+    for (int i = digits - 1; i >= 0; i--)
+    {
+        out[i] = (rest > 0 || i == digits - 1 || pad == '0') ? '0' + rest % 10 : pad;
+        rest /= 10;
+    }
+
+    out[digits] = '\0';
+    return out + digits;
+}
+
+char *formatHoursMinutes(char *out, int hours, int minutes)
+{
+    out = formatNumber(out, hours, 2);
+    *out++ = ':';
+    return formatNumber(out, minutes, 2);
+}
+
+char *formatTime(char *out, int hours, int minutes, int seconds)
+{
+    out = formatHoursMinutes(out, hours, minutes);
+    *out++ = ':';
+    return formatNumber(out, seconds, 2);
+}
+
+char *formatDate(char *out, int date, int month, int year)
+{
+    out = formatNumber(out, date, 2);
+    *out++ = '.';
+    out = formatNumber(out, month, 2);
+    *out++ = '.';
+    return formatNumber(out, year, 4);
+}
+
+char *formatTemperature(char *out, float celsius)
+{
+    // Датчик ще нічого не показав (NAN) або показав нісенітницю: lroundf()
+    // таких значень не визначений
+    if (!(fabsf(celsius) < 10000))
+    {
+        strcpy(out, "--.-");
+        return out + 4;
+    }
+
+    // String(float) округлює до сотих, а на екрані сота відкидається
+    int32_t hundredths = lroundf(fabsf(celsius) * 100);
+    int32_t whole = hundredths / 100;
+
+    if (celsius < 0 && hundredths >= 10)
+        *out++ = '-';
+
+    uint8_t digits = 1;
+    for (int32_t rest = whole / 10; rest > 0 && digits < 4; rest /= 10)
+        digits++;
+
+    out = formatNumber(out, whole, digits);
+    *out++ = '.';
+    return formatNumber(out, hundredths / 10 % 10, 1);
+}
@@ -0,0 +1,34 @@
+#include "I2CBus.h"
+
+void I2CTiming::count(uint32_t started)
+{
+    uint32_t us = micros() - started;
+
+    transactions++;
+    totalUs += us;
+    untakenUs += us;
+    if (us > maxUs)
+        maxUs = us;
+}
+
+uint32_t I2CTiming::take()
+{
+    uint32_t us = untakenUs;
+    untakenUs = 0;
+    return us;
+}
+
+void I2CTiming::print(Print &out, const char *name)
+{
+    out.printf("i2c: %-6s %lu transactions, %.3f s, average %lu us, longest %lu us\r\n", name,
+               (unsigned long)transactions, totalUs / 1e6,
+               (unsigned long)(transactions ? totalUs / transactions : 0), (unsigned long)maxUs);
+}
+
+uint8_t timedEndTransmission(TwoWire *wire, I2CTiming *timing)
+{
+    uint32_t started = micros();
+    uint8_t result = wire->endTransmission();
+    timing->count(started);
+    return result;
+}
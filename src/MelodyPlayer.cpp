@@ -0,0 +1,126 @@
+#include "MelodyPlayer.h"
+
+#include <esp_sleep.h>
+
+void MelodyPlayer::onTimer(void *arg)
+{
+    MelodyPlayer *player = (MelodyPlayer *)arg;
+    if (!player->playing)
+        return;
+
+    const Melody &melody = *player->melody;
+    const MelodyStep &ended = melody.steps[player->step];
+    if (melodyDuty(melody, ended, player->loop))
+        player->soundingUs += ended.us;
+
+    if (player->step + 1 < melody.count)
+        player->step++;
+    else
+    {
+        player->step = 0;
+        if (player->loop < UINT32_MAX)
+            player->loop++;
+    }
+
+    // Наступний крок починається там, де мав закінчитись цей, а не коли
+    // спрацював таймер, тому запізнення не накопичуються
+    player->apply(player->nextChangeAt);
+}
+
+void MelodyPlayer::apply(int64_t at)
+{
+    const MelodyStep &current = melody->steps[step];
+
+    if (current.hz)
+        ledc_set_freq(LEDC_LOW_SPEED_MODE, MELODY_LEDC_TIMER, current.hz);
+    ledc_set_duty(LEDC_LOW_SPEED_MODE, MELODY_LEDC_CHANNEL, melodyDuty(*melody, current, loop));
+    ledc_update_duty(LEDC_LOW_SPEED_MODE, MELODY_LEDC_CHANNEL);
+
+    nextChangeAt = at + current.us;
+    int64_t wait = nextChangeAt - esp_timer_get_time();
+    esp_timer_start_once(timer, wait > 0 ? wait : 0);
+}
+
+void MelodyPlayer::begin(uint8_t pin)
+{
+    // Таймер LEDC від RTC8M, щоб звук не переривався легким сном
+    ledc_timer_config_t timerConfig = {};
+    timerConfig.speed_mode = LEDC_LOW_SPEED_MODE;
+    timerConfig.duty_resolution = LEDC_TIMER_8_BIT;
+    timerConfig.timer_num = MELODY_LEDC_TIMER;
+    timerConfig.freq_hz = MELODIES[0].steps[0].hz;
+    timerConfig.clk_cfg = LEDC_USE_RTC8M_CLK;
+    ledc_timer_config(&timerConfig);
+
+    ledc_channel_config_t channelConfig = {};
+    channelConfig.gpio_num = pin;
+    channelConfig.speed_mode = LEDC_LOW_SPEED_MODE;
+    channelConfig.channel = MELODY_LEDC_CHANNEL;
+    channelConfig.intr_type = LEDC_INTR_DISABLE;
+    channelConfig.timer_sel = MELODY_LEDC_TIMER;
+    channelConfig.duty = 0;
+    ledc_channel_config(&channelConfig);
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = &MelodyPlayer::onTimer;
+    timerArgs.arg = this;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "melody";
+    esp_timer_create(&timerArgs, &timer);
+
+    melody = nullptr;
+    playing = false;
+    soundingUs = 0;
+}
+
+void MelodyPlayer::play(const Melody &melody)
+{
+    stop();
+
+    this->melody = &melody;
+    step = 0;
+    loop = 0;
+
+    // Генератор RTC8M не вимикається на час легкого сну, поки грає мелодія
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC8M, ESP_PD_OPTION_ON);
+
+    playing = true;
+    apply(esp_timer_get_time());
+}
+
+void MelodyPlayer::stop()
+{
+    if (!playing)
+        return;
+
+    playing = false;
+    esp_timer_stop(timer);
+
+    // Частина кроку, яка встигла прозвучати
+    const MelodyStep &current = melody->steps[step];
+    int64_t left = nextChangeAt - esp_timer_get_time();
+    if (melodyDuty(*melody, current, loop) && left < (int64_t)current.us)
+        soundingUs += current.us - (left > 0 ? left : 0);
+
+    ledc_stop(LEDC_LOW_SPEED_MODE, MELODY_LEDC_CHANNEL, 0);
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC8M, ESP_PD_OPTION_AUTO);
+}
+
+bool MelodyPlayer::isPlaying()
+{
+    return playing;
+}
+
+uint64_t MelodyPlayer::nextWakeUs()
+{
+    if (!playing)
+        return UINT64_MAX;
+
+    int64_t wait = nextChangeAt - MELODY_WAKE_LEAD_US - esp_timer_get_time();
+    return wait > 0 ? wait : 0;
+}
+
+uint32_t MelodyPlayer::takeSoundingUs()
+{
+    return soundingUs.exchange(0);
+}
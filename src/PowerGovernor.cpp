@@ -0,0 +1,81 @@
+#include "PowerGovernor.h"
+
+void PowerGovernor::begin()
+{
+    for (int lock = 0; lock < POWER_LOCK_COUNT; lock++)
+        counts[lock] = 0;
+    boostUs = 0;
+
+    esp_pm_config_esp32c3_t config = {POWER_MAX_FREQ_MHZ, POWER_MIN_FREQ_MHZ, true};
+    automatic = esp_pm_configure(&config) == ESP_OK &&
+                esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "cpu_max", &locks[POWER_LOCK_CPU_MAX]) == ESP_OK &&
+                esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "no_sleep", &locks[POWER_LOCK_NO_SLEEP]) == ESP_OK;
+    task = xTaskGetCurrentTaskHandle();
+
+    if (!automatic)
+        setCpuFrequencyMhz(POWER_MIN_FREQ_MHZ);
+}
+
+bool PowerGovernor::isAutomatic()
+{
+    return automatic;
+}
+
+void PowerGovernor::acquire(PowerLock lock)
+{
+    if (counts[lock]++)
+        return;
+
+    if (lock == POWER_LOCK_CPU_MAX)
+        boostSince = micros();
+
+    if (automatic)
+        esp_pm_lock_acquire(locks[lock]);
+    else if (lock == POWER_LOCK_CPU_MAX)
+        setCpuFrequencyMhz(POWER_MAX_FREQ_MHZ);
+}
+
+void PowerGovernor::release(PowerLock lock)
+{
+    if (!counts[lock] || --counts[lock])
+        return;
+
+    if (lock == POWER_LOCK_CPU_MAX)
+        boostUs += micros() - boostSince;
+
+    if (automatic)
+        esp_pm_lock_release(locks[lock]);
+    else if (lock == POWER_LOCK_CPU_MAX)
+        setCpuFrequencyMhz(POWER_MIN_FREQ_MHZ);
+}
+
+void PowerGovernor::idle(uint64_t us)
+{
+    if (automatic)
+    {
+        // Задача блокується, а легкий сон настає сам в простої FreeRTOS.
+        // Тік - 1 мс, тому очікування округлюється вгору.
+        ulTaskNotifyTake(pdTRUE, (TickType_t)((us + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000)));
+        return;
+    }
+
+    esp_sleep_enable_timer_wakeup(us);
+    esp_light_sleep_start();
+}
+
+void IRAM_ATTR PowerGovernor::wakeFromISR()
+{
+    if (!automatic)
+        return;
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+uint32_t PowerGovernor::takeBoostUs()
+{
+    uint32_t us = boostUs;
+    boostUs = 0;
+    return us;
+}
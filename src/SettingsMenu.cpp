@@ -0,0 +1,30 @@
+#include "SettingsMenu.h"
+
+void stepMenuField(const MenuField &field, int delta)
+{
+    switch (field.type)
+    {
+    case FIELD_TOGGLE:
+        *field.flag = !*field.flag;
+        break;
+
+    case FIELD_BIT:
+        *field.value ^= 1 << field.min;
+        break;
+
+    default:
+    {
+        int max = field.limit ? field.limit() : field.max;
+        int value = *field.value + delta;
+        if (value > max)
+            value = field.wrap ? field.min : max;
+        else if (value < field.min)
+            value = field.wrap ? max : field.min;
+        *field.value = value;
+        break;
+    }
+    }
+
+    if (field.changed)
+        field.changed();
+}
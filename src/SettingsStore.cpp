@@ -0,0 +1,72 @@
+#include "SettingsStore.h"
+
+bool SettingsStore::load(Settings &settings)
+{
+    Settings stored;
+
+    preferences.begin(SETTINGS_NAMESPACE, true);
+    size_t length = preferences.getBytes(SETTINGS_KEY, &stored, sizeof(stored));
+    preferences.end();
+
+    if (length != sizeof(stored) || stored.version != SETTINGS_VERSION)
+        return false;
+
+    settings = stored;
+    return true;
+}
+
+void SettingsStore::mark()
+{
+    dirty = true;
+}
+
+void SettingsStore::queue()
+{
+    if (dirty)
+        queued = true;
+}
+
+bool SettingsStore::pending()
+{
+    return queued && dirty;
+}
+
+bool SettingsStore::commit(uint32_t now, const Settings &settings, bool force)
+{
+    if (!pending())
+        return false;
+    if (!force && committed && now - lastCommit < SETTINGS_COMMIT_INTERVAL)
+        return false;
+
+    Settings record = settings;
+    record.version = SETTINGS_VERSION;
+
+    preferences.begin(SETTINGS_NAMESPACE, false);
+    size_t written = preferences.putBytes(SETTINGS_KEY, &record, sizeof(record));
+    preferences.end();
+
+    // Якщо запис не вдався, зміни чекають наступної спроби
+    committed = true;
+    lastCommit = now;
+    if (written != sizeof(record))
+        return false;
+
+    dirty = false;
+    queued = false;
+    commits++;
+    return true;
+}
+
+uint32_t SettingsStore::nextCommitMs(uint32_t now)
+{
+    if (!pending())
+        return UINT32_MAX;
+    if (!committed || now - lastCommit >= SETTINGS_COMMIT_INTERVAL)
+        return 0;
+    return SETTINGS_COMMIT_INTERVAL - (now - lastCommit);
+}
+
+uint32_t SettingsStore::getCommits()
+{
+    return commits;
+}
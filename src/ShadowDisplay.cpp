@@ -0,0 +1,132 @@
+#include "ShadowDisplay.h"
+
+#include <string.h>
+
+// Контрольні байти SSD1306 для I2C: далі йдуть команди або дані
+#define OLED_CONTROL_COMMAND 0x00
+#define OLED_CONTROL_DATA 0x40
+
+// Кількість світних пікселів в length байтах кадру
+static uint16_t countLit(const uint8_t *data, uint16_t length)
+{
+    uint16_t lit = 0;
+    while (length--)
+        lit += __builtin_popcount(*data++);
+    return lit;
+}
+
+ShadowDisplay::ShadowDisplay(Adafruit_SSD1306 *display, TwoWire *wire, uint8_t address, ShadowMemory *shadow,
+                             I2CTiming *timing)
+{
+    this->display = display;
+    this->wire = wire;
+    this->address = address;
+    this->shadow = shadow;
+    this->timing = timing;
+}
+
+void ShadowDisplay::invalidate()
+{
+    shadow->valid = false;
+}
+
+uint16_t ShadowDisplay::sendRun(uint8_t page, uint8_t first, uint8_t last, const uint8_t *data)
+{
+    uint16_t sent = 0;
+
+    // Вікно адрес: одна сторінка та колонки first..last. Панель працює в
+    // горизонтальному режимі адресації, тому дані ляжуть саме в це вікно.
+    wire->beginTransmission(address);
+    wire->write(OLED_CONTROL_COMMAND);
+    wire->write(SSD1306_PAGEADDR);
+    wire->write(page);
+    wire->write(page);
+    wire->write(SSD1306_COLUMNADDR);
+    wire->write(first);
+    wire->write(last);
+    timedEndTransmission(wire, timing);
+    sent += 7;
+
+    // Дані частинами, які вміщаються в буфер шини
+    uint16_t count = last - first + 1;
+    while (count > 0)
+    {
+        uint16_t chunk = min(count, (uint16_t)(OLED_I2C_CHUNK - 1));
+
+        wire->beginTransmission(address);
+        wire->write(OLED_CONTROL_DATA);
+        wire->write(data, chunk);
+        timedEndTransmission(wire, timing);
+
+        sent += chunk + 1;
+        data += chunk;
+        count -= chunk;
+    }
+
+    return sent;
+}
+
+uint16_t ShadowDisplay::flush()
+{
+    uint8_t *buffer = display->getBuffer();
+    uint16_t sent = 0;
+    bool recount = !shadow->valid; // Світні пікселі старої копії невідомі
+
+    for (uint8_t page = 0; page < OLED_PAGES; page++)
+    {
+        const uint8_t *row = buffer + page * OLED_WIDTH;
+        uint8_t *old = shadow->data + page * OLED_WIDTH;
+
+        int column = 0;
+        while (column < OLED_WIDTH)
+        {
+            // Пропускаємо байти, які вже є на панелі
+            if (shadow->valid && row[column] == old[column])
+            {
+                column++;
+                continue;
+            }
+
+            // Шукаємо кінець зміненого відрізку, поглинаючи короткі
+            // проміжки незмінених байтів
+            int first = column;
+            int last = column;
+            int gap = 0;
+            for (column = first + 1; column < OLED_WIDTH && gap < OLED_RUN_MERGE_GAP; column++)
+            {
+                if (!shadow->valid || row[column] != old[column])
+                {
+                    last = column;
+                    gap = 0;
+                }
+                else
+                {
+                    gap++;
+                }
+            }
+
+            sent += sendRun(page, first, last, row + first);
+            if (!recount)
+                shadow->lit += countLit(row + first, last - first + 1) - countLit(old + first, last - first + 1);
+            memcpy(old + first, row + first, last - first + 1);
+            column = last + 1;
+        }
+    }
+
+    if (recount)
+        shadow->lit = countLit(shadow->data, OLED_BUFFER_SIZE);
+
+    shadow->valid = true;
+    bytesSent += sent;
+    return sent;
+}
+
+uint32_t ShadowDisplay::getBytesSent()
+{
+    return this->bytesSent;
+}
+
+uint16_t ShadowDisplay::getLitPixels()
+{
+    return shadow->lit;
+}
@@ -0,0 +1,123 @@
+#include "TemperatureSampler.h"
+
+TemperatureSampler::TemperatureSampler(Adafruit_BMP280 *bmp, I2CTiming *timing) : bmp(bmp), timing(timing)
+{
+}
+
+void TemperatureSampler::trigger()
+{
+    // Запис примусового режиму в регістр керування запускає одне
+    // перетворення, після якого датчик сам повертається в сон
+    uint32_t started = micros();
+    bmp->setSampling(
+        Adafruit_BMP280::MODE_FORCED,
+        Adafruit_BMP280::SAMPLING_X16,
+        Adafruit_BMP280::SAMPLING_NONE,
+        Adafruit_BMP280::FILTER_OFF,
+        Adafruit_BMP280::STANDBY_MS_1);
+    timing->count(started);
+}
+
+float TemperatureSampler::read()
+{
+    uint32_t started = micros();
+    float value = bmp->readTemperature();
+    timing->count(started);
+    return value;
+}
+
+uint8_t TemperatureSampler::status()
+{
+    uint32_t started = micros();
+    uint8_t value = bmp->getStatus();
+    timing->count(started);
+    return value;
+}
+
+void TemperatureSampler::publish(float value, uint32_t now)
+{
+    celsius = value;
+    formatTemperature(text, value);
+    lastSample = now;
+    measuring = false;
+}
+
+void TemperatureSampler::begin(uint32_t now)
+{
+    // Чекаємо саме на запущене перетворення: takeForcedMeasurement() записав
+    // би примусовий режим ще раз і запустив друге
+    trigger();
+    while (status() & BMP280_STATUS_MEASURING)
+        delay(1);
+    publish(read(), now);
+}
+
+void TemperatureSampler::resume(uint32_t now, float cached)
+{
+    publish(cached, now - period);
+
+    trigger();
+    triggeredAt = now;
+    measuring = true;
+}
+
+void TemperatureSampler::setPeriod(uint32_t periodMs)
+{
+    period = periodMs;
+}
+
+bool TemperatureSampler::update(uint32_t now)
+{
+    if (!measuring || now - triggeredAt < TEMPERATURE_CONVERSION_MS)
+        return false;
+    if (status() & BMP280_STATUS_MEASURING)
+        return false;
+
+    publish(read(), now);
+    return true;
+}
+
+uint64_t TemperatureSampler::schedule(uint32_t now, uint64_t plannedUs)
+{
+    // Вікно, в якому можна взяти нове значення (мкс від now)
+    uint64_t elapsed = (uint64_t)(now - lastSample) * 1000;
+    uint64_t target = (uint64_t)period * 1000;
+    uint64_t tolerance = target / 4;
+    uint64_t due = elapsed < target ? target - elapsed : 0;
+    uint64_t earliest = elapsed + tolerance < target ? target - tolerance - elapsed : 0;
+    uint64_t latest = elapsed < target + tolerance ? target + tolerance - elapsed : 0;
+
+    // Поки йде перетворення, результат забирається на будь-якому
+    // пробудженні після його завершення, але не пізніше кінця вікна
+    if (measuring)
+    {
+        uint32_t converting = now - triggeredAt;
+        uint64_t ready = (uint64_t)(converting < TEMPERATURE_CONVERSION_MS ? TEMPERATURE_CONVERSION_MS - converting : TEMPERATURE_RETRY_MS) * 1000;
+        return min(plannedUs, max(ready, latest));
+    }
+
+    // Якщо інших пробуджень у вікні немає, прокидаємось саме для датчика
+    uint64_t sleepUs = plannedUs;
+    if (sleepUs > latest)
+        sleepUs = max(due, (uint64_t)TEMPERATURE_CONVERSION_MS * 1000);
+
+    // Наступне пробудження вже по нове значення
+    if (sleepUs >= earliest)
+    {
+        trigger();
+        triggeredAt = now;
+        measuring = true;
+    }
+
+    return sleepUs;
+}
+
+float TemperatureSampler::getCelsius()
+{
+    return celsius;
+}
+
+const char *TemperatureSampler::getText()
+{
+    return text;
+}
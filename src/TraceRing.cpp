@@ -0,0 +1,218 @@
+#include "TraceRing.h"
+
+// Позначка дійсного вмісту (і версія формату)
+#define TRACE_MAGIC 0x54524301
+
+// Найдовший запис: заголовок та два varint по 5 байтів
+#define TRACE_MAX_RECORD 11
+
+// Байтів журналу в одному рядку dump()
+#define TRACE_DUMP_LINE 32
+
+static const char *const EVENT_NAMES[TRACE_EVENT_COUNT] = {
+    "boot", "wake", "mode", "button", "sleeping", "alarm start", "alarm stop", "temperature", "battery",
+};
+
+static uint8_t putVarint(uint8_t *out, uint32_t value)
+{
+    uint8_t length = 0;
+    do
+    {
+        out[length] = (value & 0x7F) | (value > 0x7F ? 0x80 : 0);
+        value >>= 7;
+        length++;
+    } while (value);
+    return length;
+}
+
+void TraceRing::begin()
+{
+    if (magic != TRACE_MAGIC || tail >= TRACE_RING_BYTES || used > TRACE_RING_BYTES)
+        clear();
+}
+
+void TraceRing::clear()
+{
+    magic = TRACE_MAGIC;
+    tail = used = loading = 0;
+    firstMs = lastMs = 0;
+    evicted = 0;
+    changed = 0;
+}
+
+uint8_t TraceRing::at(uint16_t offset)
+{
+    return bytes[(tail + offset) % TRACE_RING_BYTES];
+}
+
+uint16_t TraceRing::decode(uint16_t offset, TraceRecord &record, uint32_t &deltaMs)
+{
+    uint16_t start = offset;
+    uint8_t header = at(offset++);
+    record.type = header & 0x0F;
+    record.value = header >> 4;
+
+    // Час від попереднього запису, потім значення (zigzag), якщо воно
+    // не вмістилось в заголовок
+    uint32_t fields[2] = {0, 0};
+    int count = record.value == TRACE_WIDE ? 2 : 1;
+    for (int field = 0; field < count; field++)
+    {
+        uint8_t b;
+        int shift = 0;
+        do
+        {
+            b = at(offset++);
+            fields[field] |= (uint32_t)(b & 0x7F) << shift;
+            shift += 7;
+        } while ((b & 0x80) && shift < 35);
+    }
+
+    deltaMs = fields[0];
+    if (record.value == TRACE_WIDE)
+        record.value = (int32_t)(fields[1] >> 1) ^ -(int32_t)(fields[1] & 1);
+    return offset - start;
+}
+
+void TraceRing::evict()
+{
+    TraceRecord record;
+    uint32_t deltaMs;
+    uint16_t length = decode(0, record, deltaMs);
+
+    tail = (tail + length) % TRACE_RING_BYTES;
+    used -= length;
+    evicted++;
+
+    // Час нового найстарішого запису - через його відстань від витісненого
+    if (used)
+    {
+        decode(0, record, deltaMs);
+        firstMs += deltaMs;
+    }
+}
+
+void TraceRing::record(TraceEvent type, int32_t value, uint32_t timeMs)
+{
+    uint8_t encoded[TRACE_MAX_RECORD];
+    bool wide = value < 0 || value >= TRACE_WIDE;
+    encoded[0] = type | (wide ? TRACE_WIDE : value) << 4;
+
+    // Час не йде назад (фронт кнопки може мати час раніше за попередній
+    // запис)
+    uint32_t deltaMs = used && (int32_t)(timeMs - lastMs) > 0 ? timeMs - lastMs : 0;
+    uint8_t length = 1 + putVarint(encoded + 1, deltaMs);
+    if (wide)
+        length += putVarint(encoded + length, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+
+    while (used + length > TRACE_RING_BYTES)
+        evict();
+
+    if (!used)
+        firstMs = lastMs = timeMs;
+    lastMs += deltaMs;
+
+    for (uint8_t i = 0; i < length; i++)
+        bytes[(tail + used + i) % TRACE_RING_BYTES] = encoded[i];
+    used += length;
+}
+
+void TraceRing::recordChange(TraceEvent type, int32_t value, uint32_t timeMs)
+{
+    if ((changed >> type & 1) && last[type] == value)
+        return;
+
+    last[type] = value;
+    changed |= 1 << type;
+    record(type, value, timeMs);
+}
+
+uint16_t TraceRing::size()
+{
+    return used;
+}
+
+uint32_t TraceRing::getEvicted()
+{
+    return evicted;
+}
+
+void TraceRing::rewind(TraceCursor &cursor)
+{
+    cursor.offset = 0;
+    cursor.timeMs = firstMs;
+}
+
+bool TraceRing::next(TraceCursor &cursor, TraceRecord &record)
+{
+    if (cursor.offset >= used)
+        return false;
+
+    uint32_t deltaMs;
+    bool first = cursor.offset == 0;
+    cursor.offset += decode(cursor.offset, record, deltaMs);
+    if (!first)
+        cursor.timeMs += deltaMs;
+    record.timeMs = cursor.timeMs;
+    return true;
+}
+
+void TraceRing::dump(Print &out)
+{
+    out.printf("trace: begin %lu %u %lu\r\n", (unsigned long)firstMs, used, (unsigned long)evicted);
+    for (uint16_t offset = 0; offset < used; offset += TRACE_DUMP_LINE)
+    {
+        out.print("trace: ");
+        for (uint16_t i = offset; i < used && i < offset + TRACE_DUMP_LINE; i++)
+            out.printf("%02x", at(i));
+        out.print("\r\n");
+    }
+    out.print("trace: end\r\n");
+}
+
+bool TraceRing::load(const char *line)
+{
+    const char *text = strstr(line, "trace: ");
+    if (!text)
+        return false;
+    text += 7;
+
+    unsigned long first, dropped;
+    unsigned length;
+    if (sscanf(text, "begin %lu %u %lu", &first, &length, &dropped) == 3)
+    {
+        clear();
+        firstMs = first;
+        evicted = dropped;
+        loading = min(length, (unsigned)TRACE_RING_BYTES);
+        return false;
+    }
+
+    if (!strncmp(text, "end", 3))
+    {
+        if (loading)
+            return false;
+
+        // Час найновішого запису
+        TraceCursor cursor;
+        TraceRecord record;
+        rewind(cursor);
+        while (next(cursor, record))
+            lastMs = record.timeMs;
+        return true;
+    }
+
+    unsigned byte;
+    while (loading && sscanf(text, "%2x", &byte) == 1)
+    {
+        bytes[used++] = byte;
+        loading--;
+        text += 2;
+    }
+    return false;
+}
+
+const char *TraceRing::eventName(uint8_t type)
+{
+    return type < TRACE_EVENT_COUNT ? EVENT_NAMES[type] : "?";
+}
@@ -0,0 +1,12 @@
+#include "WarmSSD1306.h"
+
+bool WarmSSD1306::resume(uint8_t switchvcc, uint8_t address)
+{
+    if (!buffer && !(buffer = (uint8_t *)malloc(WIDTH * ((HEIGHT + 7) / 8))))
+        return false;
+
+    clearDisplay();
+    vccstate = switchvcc;
+    i2caddr = address;
+    return true;
+}
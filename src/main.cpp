@@ -34,108 +34,319 @@
 #include <Adafruit_SSD1306.h>
 #include <Adafruit_BMP280.h>
 #include <Wire.h>
-#include <esp_pm.h>
-
-// Змінні для відстеження зміни часу
-long currentTime, previousTime;
-
-// Мілісекунд в секунді
-#define MILLI_TO_SECOND 1000.0
-#define MICRO_TO_SECOND 1000000.0
+#include <hal/gpio_ll.h>
+#include <sys/time.h>
+
+#include "AlarmEngine.h"
+#include "BatteryMonitor.h"
+#include "Calendar.h"
+#include "ClockCore.h"
+#include "DigitSprites.h"
+#include "DriftCalibrator.h"
+#include "EnergyMeter.h"
+#include "Format.h"
+#include "I2CBus.h"
+#include "InputQueue.h"
+#include "MelodyPlayer.h"
+#include "PowerGovernor.h"
+#include "SettingsMenu.h"
+#include "SettingsStore.h"
+#include "ShadowDisplay.h"
+#include "TemperatureSampler.h"
+#include "TraceRing.h"
+#include "ViewVersions.h"
+#include "WakeScheduler.h"
+#include "WarmSSD1306.h"
+
+// Змінні для відстеження зміни часу (беззнакові, щоб різниця була
+// правильною і після переповнення millis() через ~49 днів)
+uint32_t currentTime, previousTime;
 
 // Через шуми та неідеальності в кварцовому резонаторі, функція millis()
 // дуже відстає від реального часу. Тому в випадку використання
-// годинника без зовнішього RTC модуля використовуються мултіплаєри щоб
-// приблизно отримати реальний час. На жаль, дрифт буде присутнім завжди.
-// При цих налаштувань годинник відстає на 1 хвилину через 4.5 днів.
-// Використовувався алгоритм двійкового пошуку для знаходження оффсетів.
-#define TIME_OFFSET 1.002181676275
-#define SLEEP_TIME_OFFSET 1.00268167625
+// годинника без зовнішього RTC модуля використовуються поправки, щоб
+// приблизно отримати реальний час. На жаль, дрифт буде присутнім завжди,
+// а ще він залежить від температури. Тому поправки уточнюються за кожним
+// виправленням часу користувачем та історією температури (див.
+// DriftCalibrator.h).
+
+// Все, що має пережити глибокий сон (налаштування, ядро годинника,
+// калібровка), позначене RTC_DATA_ATTR: ці змінні знаходяться в RTC пам'яті,
+// ініціалізуються тільки при ввімкненні живлення і не скидаються при
+// пробудженні з глибокого сну.
+
+// Калібровка годинника
+RTC_DATA_ATTR DriftCalibrator calibrator;
 
-// Заряд батареї та її напруга (приблизна)
-float voltage = 0;
-int charge = 0;
+// Як часто (в мілісекундах) вимірювати заряд батареї
+#define BATTERY_SAMPLE_PERIOD 60000
+#define BATTERY_PIN 4
 
-#define DISCHARGED_BATTERY_VOLTAGE 3.3
-#define CHARGED_BATTERY_VOLTAGE 4.1
+// Заряд батареї (відфільтрований, див. BatteryMonitor.h). Фільтр та
+// показаний заряд переживають глибокий сон
+RTC_DATA_ATTR BatteryMonitor battery(BATTERY_PIN, BATTERY_SAMPLE_PERIOD);
+RTC_DATA_ATTR int charge = 0;
 
 // Режим (годинник + будильник, вибір налаштування, меню налаштування)
 int mode;
 
-// Поточна температура
-String temperature;
-
-// Налаштування будильника
-bool alarm_on = true;
+// Будильники (AlarmEngine.h)
+RTC_DATA_ATTR AlarmEngine alarms;
 bool alarm_playing = false;
+int ringing_alarm = 0; // Будильник, який грає
+
+// Назви режимів будильника та днів тижня (з понеділка) на екранах
+const char *ALARM_MODE_NAMES[] = {"OFF", "ONCE", "REPEAT"};
+const char WEEKDAY_LETTERS[] = "MTWTFSS";
+
+// Будильник на екранах налаштувань та копія його полів для редагування
+int alarm_slot = 0;
+int alarm_mode = ALARM_REPEAT, alarm_days = ALARM_EVERY_DAY, alarm_melody = 0;
 int alarm_hours = 7, alarm_minutes = 30, alarm_seconds = 0;
 
 // Налаштування часу відключення
-bool sleep_on = true;
+RTC_DATA_ATTR bool sleep_on = true;
 bool sleeping = false;
-int sleep_start_hours = 12, sleep_start_minutes = 0, sleep_start_seconds = 5;
-int sleep_end_hours = 12, sleep_end_minutes = 0, sleep_end_seconds = 30; 
-
-// Налаштування поточного часу годинника
-float hours = 12, minutes = 0, seconds = 0;
+RTC_DATA_ATTR bool displays_on = true; // Чи ввімкнені дисплеї зараз
+uint32_t sleep_show_until = 0;   // До якого моменту показувати час в режимі сну
+#define SLEEP_SHOW_TIME 10000    // Скільки мілісекунд показувати час після натиску SET
+RTC_DATA_ATTR int sleep_start_hours = 12, sleep_start_minutes = 0, sleep_start_seconds = 5;
+RTC_DATA_ATTR int sleep_end_hours = 12, sleep_end_minutes = 0, sleep_end_seconds = 30;
+
+// Контраст панелей вдень та вночі: з CONTRAST_DIM_LEAD секунд до початку
+// режиму сну і до його кінця (вночі годинник видно тільки після натиску SET)
+#define CONTRAST_DAY 1
+#define CONTRAST_NIGHT 0
+#define CONTRAST_DIM_LEAD 3600
+RTC_DATA_ATTR uint8_t panel_contrast = CONTRAST_DAY; // Контраст, виставлений на панелях
+bool dimmed = false;
+
+// Бюджет світних пікселів цифр годинника вдень та вночі: якщо жирні цифри
+// його перевищують, малюються тонкі (жирні - від 792 до 1464 пікселів)
+#define CLOCK_PIXEL_BUDGET_DAY 1200
+#define CLOCK_PIXEL_BUDGET_NIGHT 0
+
+// Глибокий сон в режимі сну: чи чип заснув ним та показ RTC таймера
+// (gettimeofday(), мкс) в момент, до якого ядро годинника вже просунуте
+RTC_DATA_ATTR bool night_sleep = false;
+RTC_DATA_ATTR int64_t night_sleep_start = 0;
+
+// Ядро годинника (лічильник мікросекунд, з якого рахуються час та дата)
+RTC_DATA_ATTR ClockCore clockCore;
+
+// Поточний час годинника (копія з ядра для відображення та налаштування).
+// Початкові значення встановлюються в ядро в setup().
+int hours = 12, minutes = 0, seconds = 0;
 
 // Налаштування для відображення секунд
-bool display_seconds = false;
+RTC_DATA_ATTR bool display_seconds = false;
 
 // Налаштування поточної дати
 int date = 17, month = 7, year = 2025;
 
-// Список днів в кожному місяці (для лютого йде перевірка в коді)
-int monthDays[] = {
-    31, // Січень
-    28, // Лютий
-    31, // Березень
-    30, // Квітень
-    31, // Травень
-    30, // Червень
-    31, // Липень
-    31, // Серпень
-    30, // Вересень
-    31, // Жовтень
-    30, // Листопад
-    31  // Грудень
+// Індекси дій в меню (в тому ж порядку, що і екрани в SCREENS[])
+enum MenuOption
+{
+    OPTION_ENERGY,
+    OPTION_BATTERY,
+    OPTION_SECONDS,
+    OPTION_SLEEP_END,
+    OPTION_SLEEP_START,
+    OPTION_SLEEP_STATUS,
+    OPTION_ALARM_TIME,
+    OPTION_ALARM_STATUS,
+    OPTION_DATE,
+    OPTION_TIME,
+    OPTION_EXIT,
+    OPTION_COUNT
 };
 
-// Список налаштувань та дій для меню вибору налаштування
-String options[] = {
-    "Battery", "Display Seconds", "Sleep End", "Sleep Start", "Sleep Status", "Alarm Time", "Alarm Status", "Date", "Time", "Exit"};
-int options_count = sizeof(options) / sizeof(String);
-int menu_option = options_count - 1; // Поточний вибір
-int option_cursor = options_count - 1; // Індекс найвищої опції на екрані
-
-// Список полів для кожного меню налаштування
-float *timeFields[] = {&hours, &minutes, &seconds};
-int *dateFields[] = {&date, &month, &year};
-int *alarmFields[] = {&alarm_hours, &alarm_minutes, &alarm_seconds};
-int *sleepStartFields[] = {&sleep_start_hours, &sleep_start_minutes, &sleep_start_seconds};
-int *sleepEndFields[] = {&sleep_end_hours, &sleep_end_minutes, &sleep_end_seconds};
-
-int fieldCount[] = {0, 1, 3, 3, 1, 3, 1, 3, 3}; // Кількість полів на кожному меню налаштування
+int menu_option = OPTION_EXIT;   // Поточний вибір
+int option_cursor = OPTION_EXIT; // Індекс найвищої опції на екрані
 int current_field = 0;           // Поточне поле налаштування
 
+// Початок редагування часу: показ годинника та millis() в цей момент
+uint64_t time_edit_us = 0;
+uint32_t time_edit_ms = 0;
+bool time_edited = false; // Чи змінював користувач час на екрані
+
+// Збереження налаштувань у флеш (читаються при старті, записуються після
+// виходу з екрану налаштувань)
+SettingsStore settingsStore;
+
+// Поточні налаштування у вигляді запису для флешу
+void collectSettings(Settings &settings)
+{
+    for (int slot = 0; slot < ALARM_SLOTS; slot++)
+        settings.alarms[slot] = alarms.get(slot);
+
+    settings.sleepOn = sleep_on;
+    settings.sleepStart[0] = sleep_start_hours;
+    settings.sleepStart[1] = sleep_start_minutes;
+    settings.sleepStart[2] = sleep_start_seconds;
+    settings.sleepEnd[0] = sleep_end_hours;
+    settings.sleepEnd[1] = sleep_end_minutes;
+    settings.sleepEnd[2] = sleep_end_seconds;
+
+    settings.displaySeconds = display_seconds;
+
+    settings.date = clockCore.getDate();
+    settings.month = clockCore.getMonth();
+    settings.year = clockCore.getYear();
+    settings.clockTime[0] = clockCore.getHours();
+    settings.clockTime[1] = clockCore.getMinutes();
+    settings.clockTime[2] = clockCore.getSeconds();
+
+    settings.drift = calibrator.getFit();
+}
+
+// Встановити налаштування з запису. Годинник продовжує з часу запису (поки
+// годинник був без живлення, час не йшов, але це краще, ніж стартувати з
+// дати за замовчуванням)
+void applySettings(const Settings &settings)
+{
+    // Спрацювання перераховуються після встановлення годинника (setup())
+    for (int slot = 0; slot < ALARM_SLOTS; slot++)
+        alarms.set(slot, settings.alarms[slot], 0);
+
+    sleep_on = settings.sleepOn;
+    sleep_start_hours = settings.sleepStart[0];
+    sleep_start_minutes = settings.sleepStart[1];
+    sleep_start_seconds = settings.sleepStart[2];
+    sleep_end_hours = settings.sleepEnd[0];
+    sleep_end_minutes = settings.sleepEnd[1];
+    sleep_end_seconds = settings.sleepEnd[2];
+
+    display_seconds = settings.displaySeconds;
+
+    date = settings.date;
+    month = settings.month;
+    year = settings.year;
+    hours = settings.clockTime[0];
+    minutes = settings.clockTime[1];
+    seconds = settings.clockTime[2];
+
+    calibrator.restore(settings.drift);
+}
+
+// Поля вибраного будильника для редагування
+void loadAlarmFields()
+{
+    const Alarm &alarm = alarms.get(alarm_slot);
+    alarm_mode = alarm.mode;
+    alarm_days = alarm.days;
+    alarm_hours = alarm.hours;
+    alarm_minutes = alarm.minutes;
+    alarm_seconds = alarm.seconds;
+    alarm_melody = alarm.melody;
+}
+
+// Зберегти відредаговані поля в будильник (спрацювання перераховуються,
+// тільки якщо щось змінилось)
+void storeAlarmFields()
+{
+    Alarm alarm = {(uint8_t)alarm_mode, (uint8_t)alarm_days, (uint8_t)alarm_hours, (uint8_t)alarm_minutes,
+                   (uint8_t)alarm_seconds, (uint8_t)alarm_melody};
+    if (memcmp(&alarm, &alarms.get(alarm_slot), sizeof(alarm)))
+        alarms.set(alarm_slot, alarm, clockCore.getEpochSeconds());
+}
+
+// Записати налаштування, якщо запис запитаний (force - не чекати
+// SETTINGS_COMMIT_INTERVAL, наприклад перед глибоким сном)
+void saveSettings(bool force = false)
+{
+    if (!settingsStore.pending())
+        return;
+
+    Settings settings;
+    collectSettings(settings);
+    settingsStore.commit(currentTime, settings, force);
+}
+
+// Користувач виставив час на екрані налаштування: різниця з часом, який
+// показував би годинник, йде в калібровку дрифту
+void timeCorrected()
+{
+    int64_t expected = time_edit_us + (uint64_t)(uint32_t)(currentTime - time_edit_ms) * 1000;
+    int64_t error = (int64_t)clockCore.getEpochUs() - expected;
+
+    if (calibrator.userCorrection(error))
+        settingsStore.mark();
+}
+
 // Поріг зарахування натиску кнопки на певну дію
 #define MENU_ACTIVATION_THRESHOLD 1000 // Час для викликання SET MENU та підтвердження вибору\налаштувань
 #define ACTION_THRESHOLD 100           // Час для зарахування натиску кнопки
+#define BUTTON_REPEAT_TIME 100         // Період повтору, поки кнопка затиснута
+
+// Як часто (в мілісекундах) оновлювати температуру: звичайно та в режимі сну
+#define TEMPERATURE_AWAKE_PERIOD 30000
+#define TEMPERATURE_SLEEP_PERIOD 600000
+
+// Фронти кнопок від переривань (див. InputQueue.h)
+InputQueue inputQueue;
+
+// Частота CPU та легкий сон (див. PowerGovernor.h)
+PowerGovernor power;
 
-// Клас кнопки (для легшості роботи з ними та зменшеню повторення коду)
+// Журнал подій (див. TraceRing.h). Час записів - RTC таймер в мс, який йде
+// і в глибокому сні
+RTC_NOINIT_ATTR TraceRing trace;
+int64_t rtcMicros();
+
+uint32_t traceMs()
+{
+    return rtcMicros() / 1000;
+}
+
+// Клас кнопки (для легшості роботи з ними та зменшеню повторення коду).
+//
+// Порт не опитується: переривання записує кожну зміну рівня з її часом в
+// inputQueue, а update() фільтрує брязкіт за цими часами і видає події
+// натиску, затиску та повтору. Поки кнопка натиснута, чип прокидається тільки
+// на моменти, коли одна з цих подій може настати (див. nextWakeMs()).
 class Button
 {
 private:
     int pin; // Цифровий порт, до якого підключена кнопка
 
-    bool clicked = false; // Чи кнопка натиснута (тільк перший раз)
-    bool hold = false;    // Чи кнопка затиснута
-    bool pressed = false; // Чи кнопка натиснута (взагалі)
-    int pressedTime = 0;  // Час з початку натиску кнопки в мілісекундах
+    // Події (діють протягом одного циклу loop())
+    bool clicked = false; // Кнопка щойно натиснута
+    bool held = false;    // Кнопка щойно затиснута на MENU_ACTIVATION_THRESHOLD
+    bool repeat = false;  // Повтор, поки кнопка затиснута (кожні BUTTON_REPEAT_TIME)
+
+    bool pressed = false;      // Чи кнопка натиснута (взагалі, після фільтрації брязкоту)
+    bool ignored = false;      // Натиск скинутий через reset() і вже не дасть подій
+    uint32_t pressedTime = 0;  // Час з початку натиску кнопки в мілісекундах
+    uint32_t pressedSince = 0; // Час початку натиску
+    uint32_t nextRepeat = 0;   // Час наступного повтору (перший - разом з затиском)
+
+    int level = LOW;            // Останній рівень на порту (з переривань)
+    uint32_t lastEdgeTime = 0;  // Час останньої зміни рівня
+    volatile uint8_t waitLevel; // Рівень, на який налаштоване переривання
+
+    // Налаштувати переривання (і пробудження з легкого сну) на рівень level.
+    // Викликається з переривання, тому пише прямо в регістр піна:
+    // gpio_wakeup_enable() лежить у флеші і бере спінлок, а поки пишеться
+    // флеш (NVS), кеш вимкнений і такий виклик з переривання - паніка
+    void IRAM_ATTR waitFor(uint8_t level)
+    {
+        this->waitLevel = level;
+        gpio_ll_wakeup_enable(&GPIO, (gpio_num_t)this->pin, level == HIGH ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+    }
 
-    int action = LOW;       // Сигнал з цифрового порта
-    int lastAction = LOW;   // Минулий сигнал з цифрового порта
-    int lastActionTime = 0; // Час минулої зміни сигналу з цифрового порта
+    // Переривання. Легкий сон ESP32-C3 будять тільки рівні, тому переривання
+    // налаштоване на рівень, протилежний поточному, і після кожного спрацювання
+    // перемикається - так воно ловить обидва фронти.
+    static void IRAM_ATTR interrupt(void *arg)
+    {
+        Button *button = (Button *)arg;
+        uint8_t edge = button->waitLevel;
+
+        button->waitFor(edge == HIGH ? LOW : HIGH);
+        inputQueue.push({(uint8_t)button->pin, edge, (uint32_t)millis()});
+        power.wakeFromISR();
+    }
 
 public:
     // Конструктор. Приймає цифровий порт, до якого приєднана кнопка
@@ -145,64 +356,93 @@ public:
     };
 
     // Ініціалізація кнопки шляхом встановлення режиму роботи порта на вхід\зчитування
+    // та підключення переривання
     void init()
     {
         pinMode(pin, INPUT);
+
+        this->clicked = this->held = this->repeat = false;
+        this->pressed = this->ignored = false;
+        this->level = digitalRead(pin);
+        this->lastEdgeTime = millis();
+        this->waitLevel = this->level == HIGH ? LOW : HIGH;
+        attachInterruptArg(pin, interrupt, this, this->waitLevel == HIGH ? ONHIGH_WE : ONLOW_WE);
+    }
+
+    // Зміна рівня на порту (з inputQueue)
+    void edge(int level, uint32_t time)
+    {
+        this->level = level;
+        this->lastEdgeTime = time;
     }
 
     // Оновлення данних про кнопку
     void update()
     {
-        // Читання поточного сигналу з цифрового порта
-        action = digitalRead(this->pin);
-
-        // Якщо сигнал відрізняється від попереднього, то оновити час останої дії
-        // кнопки та останього сигналу.
-        if (action != lastAction)
-        {
-            lastAction = action;
-            lastActionTime = currentTime;
-        }
+        this->clicked = false;
+        this->held = false;
+        this->repeat = false;
 
-        // Якщо поточний сигнал високий (тобто кнопка затиснута) і час з останьої дії
-        // є більшим за час для зарахування натиску
-        if (action == HIGH && currentTime - lastActionTime >= ACTION_THRESHOLD)
+        // Рівень зараховується, тільки якщо він тримається довше за час
+        // для зарахування натиску (інакше це брязкіт контактів)
+        if ((int32_t)(currentTime - lastEdgeTime) >= ACTION_THRESHOLD)
         {
-
-            // Якщо це вже друга обробка, то кажемо що кнопка вже затиснута, а не натиснута
-            // перевіряти коли кнопка була натиснута, а не затиснута
-            if (this->hold == false && this->clicked == true)
+            if (level == HIGH && !this->pressed)
             {
-                this->hold = true;
-                this->clicked = false;
+                this->pressed = true;
+                this->clicked = true;
+                this->pressedSince = lastEdgeTime;
+                this->nextRepeat = lastEdgeTime + MENU_ACTIVATION_THRESHOLD;
             }
-            // Перевіряємо чи це перша обробка, для того щоб мати змогу
-            if (this->pressed == false && this->clicked == false)
+            else if (level == LOW)
             {
-                this->clicked = true;
-                this->hold = false;
+                this->pressed = false;
+                this->ignored = false;
             }
-
-            // Кажемо, що кнопка взагалі натиснута (не важливо чи затиснута чи натиснута вперше)
-            this->pressed = true;
         }
-        // Якщо ні, то кажемо що кнопка взагалі не натиснута і час натиску відповідно
-        // дорівнює 0
-        else
+
+        // Якщо кнопка не натиснута, то час натиску дорівнює 0
+        if (!this->pressed)
         {
-            this->pressed = false;
             this->pressedTime = 0;
-            this->hold = false;
-            this->clicked = false;
+            return;
         }
 
-        // Якщо конпка взагалі натиснута, то відслідковуємо час скільки вона є натиснутою
-        if (this->pressed)
+        // Відслідковуємо час скільки кнопка є натиснутою
+        this->pressedTime = currentTime - pressedSince;
+
+        if (!this->ignored && (int32_t)(currentTime - nextRepeat) >= 0)
         {
-            pressedTime = currentTime - lastActionTime;
+            // Перший повтор - це і є затиск
+            if (this->pressedTime < MENU_ACTIVATION_THRESHOLD + BUTTON_REPEAT_TIME)
+                this->held = true;
+
+            this->repeat = true;
+            this->nextRepeat = currentTime + BUTTON_REPEAT_TIME;
         }
     }
 
+    // Через скільки мілісекунд кнопка може дати наступну подію
+    // (UINT32_MAX - тільки після наступного фронту)
+    uint32_t nextWakeMs()
+    {
+        // Кінець фільтрації брязкоту
+        if ((level == HIGH) != this->pressed)
+        {
+            int32_t left = (int32_t)(lastEdgeTime + ACTION_THRESHOLD - currentTime);
+            return left > 0 ? left : 0;
+        }
+
+        // Затиск та повтори
+        if (this->pressed && !this->ignored)
+        {
+            int32_t left = (int32_t)(nextRepeat - currentTime);
+            return left > 0 ? left : 0;
+        }
+
+        return UINT32_MAX;
+    }
+
     // Методи-інтерфейс для отримання данних з кнопки
 
     bool getPressed()
@@ -220,41 +460,137 @@ public:
         return this->clicked;
     }
 
-    bool getHold()
+    bool getHeld()
+    {
+        return this->held;
+    }
+
+    bool getRepeat()
     {
-        return this->hold;
+        return this->repeat;
     }
 
     int getPin() {
         return this->pin;
     }
 
-    // Скидання стану кнопки, крім стану натиску взагалі. Використовується для
+    // Скидання подій кнопки до її відпускання. Використовується для
     // того, щоб, наприклад, коли користувач затиснув на вихід в меню його одразу не
-    // перекинуло назад в меню (якщо стан затиску і час натиску залишиться такими ж,
+    // перекинуло назад в меню (якщо кнопка залишиться затиснутою,
     // тоді програма подумає що користувач спеціально затиснув кнопку на екрані годиника
     // і хоче в меню)
     void reset()
     {
         this->pressedTime = 0;
-        this->hold = false;
+        this->held = false;
+        this->repeat = false;
         this->clicked = false;
+        this->ignored = this->pressed;
     }
 };
 
-// ДисплеЇ
-Adafruit_SSD1306 leftOled(128, 64, &Wire);
-Adafruit_SSD1306 rightOled(128, 64, &Wire);
+// Час передач по I2C: кадрів на панелі та операцій з датчиком
+I2CTiming oledTiming, sensorTiming;
+
+// ДисплеЇ (шина весь час на I2C_BUS_CLOCK, тому бібліотека її не перемикає)
+WarmSSD1306 leftOled(128, 64, &Wire, -1, I2C_BUS_CLOCK, I2C_BUS_CLOCK);
+WarmSSD1306 rightOled(128, 64, &Wire, -1, I2C_BUS_CLOCK, I2C_BUS_CLOCK);
+
+// Адреси дисплеїв на шині I2C
+#define LEFT_OLED_ADDRESS 0x3D
+#define RIGHT_OLED_ADDRESS 0x3C
+
+// Тіньові буфери дисплеїв (відправляють на екран тільки змінені частини
+// кадру). Копії пам'яті панелей в RTC пам'яті, бо панелі не втрачають вміст
+// під час глибокого сну чипа.
+RTC_DATA_ATTR ShadowMemory leftShadow, rightShadow;
+ShadowDisplay leftPanel(&leftOled, &Wire, LEFT_OLED_ADDRESS, &leftShadow, &oledTiming);
+ShadowDisplay rightPanel(&rightOled, &Wire, RIGHT_OLED_ADDRESS, &rightShadow, &oledTiming);
+
+// Версії видимого стану (ViewVersions.h), екран, який зараз на панелях, та
+// версії, з яких намальований його кадр
+ViewVersions view;
+int shown_screen = -1;
+ViewStamp drawn_frame;
 
 // Датчик температури
 Adafruit_BMP280 bmp;
+TemperatureSampler temperatureSampler(&bmp, &sensorTiming);
+RTC_DATA_ATTR float last_temperature = NAN; // Останнє значення (для теплого старту)
+char shown_temperature[FORMAT_TEMPERATURE_SIZE] = ""; // Текст, з якого намальована температура
+
+// Теплий старт: пробудження з глибокого сну, коли панелі та датчик вже
+// налаштовані (позначка в RTC пам'яті ставиться після повної ініціалізації
+// і знімається на її початку, тому перерваний холодний старт не рахується)
+#define PERIPHERALS_READY 0xC10C4EADUL
+RTC_DATA_ATTR uint32_t peripherals_marker = 0;
+bool warm_boot = false;
+bool sensor_pending = false;     // Датчик ще треба ініціалізувати (після першого кадру)
+bool first_frame_pending = true; // Перший кадр після старту ще не показаний
 
 // Кнопки
 Button upButton(0);
 Button setButton(1);
 Button downButton(2);
 
+Button *buttons[] = {&upButton, &setButton, &downButton};
+uint8_t inputDropped = 0; // Скільки фронтів вже відкинула черга
+
+// Передача фронтів з черги кнопкам та оновлення кнопок
+void inputUpdate()
+{
+    InputEdge edge;
+    while (inputQueue.pop(edge))
+    {
+        trace.record(TRACE_BUTTON, edge.pin * 2 + edge.level, traceMs() - (millis() - edge.timeMs));
+        for (Button *button : buttons)
+            if (button->getPin() == edge.pin)
+                button->edge(edge.level, edge.timeMs);
+    }
+
+    // Якщо черга переповнилась, частина фронтів загубилась, тому стан
+    // кнопок береться прямо з портів
+    if (inputQueue.getDropped() != inputDropped)
+    {
+        inputDropped = inputQueue.getDropped();
+        for (Button *button : buttons)
+            button->edge(digitalRead(button->getPin()), currentTime);
+    }
+
+    for (Button *button : buttons)
+        button->update();
+}
+
+// Планувальник пробуджень
+WakeScheduler wakeScheduler;
+
+// Облік енергії (зберігається в RTC пам'яті)
+RTC_DATA_ATTR EnergyMeter energy;
+
+// Нове значення температури (в журнал записується тільки зміна)
+void temperatureSampled()
+{
+    calibrator.setTemperature(last_temperature);
+    energy.countTemperatureRead();
+    if (!isnan(last_temperature))
+        trace.recordChange(TRACE_TEMPERATURE, lroundf(last_temperature * 10), traceMs());
+}
+
+// Температура перемальовується тільки коли змінився її текст на екрані
+// (нове значення часто відрізняється лише в сотих)
+void temperatureShown()
+{
+    const char *text = temperatureSampler.getText();
+    if (strcmp(text, shown_temperature) == 0)
+        return;
+    strcpy(shown_temperature, text);
+    view.bump(VIEW_TEMPERATURE);
+}
+
 #define PIEZO 3 // Цифровий порт для пієзодинаміка
+
+// Мелодії будильника на апаратному ШІМ (див. MelodyPlayer.h)
+MelodyPlayer melodyPlayer;
 #define CHARGE_LED 21
 
 // Функція для відмальовки вертикальної стрілки
@@ -275,6 +611,20 @@ void drawVArrow(int x, int y, int w, int h, int thickness, int direction, Adafru
     }
 }
 
+// Текст розміром 2 на екрані налаштування; вибраний - інверсний (біла рамка
+// з чорним текстом)
+void drawOption(Adafruit_SSD1306 *display, int x, int y, const char *text, bool selected)
+{
+    if (selected)
+    {
+        display->fillRect(x - 5, y - 6, strlen(text) * 12 + 9, 24, WHITE);
+        display->setTextColor(BLACK);
+    }
+    display->setCursor(x, y);
+    display->print(text);
+    display->setTextColor(WHITE);
+}
+
 // Функція відмальовки наполовину закругленого прямокутника
 void drawRoundRect(int x, int y, int w, int h, int rounding, int direction, Adafruit_SSD1306 *display, int color = WHITE) {
     if (direction == 1) {
@@ -304,16 +654,11 @@ void drawPattern(int x, int y, int w, int h, int lines, Adafruit_SSD1306 *displa
     }
 }
 
-
-int clamp(int value, int maximum, int minimum) {
-    return max(min(maximum, value), minimum);
-}
-
 // Функція для перевірки чи поточний час знаходиться 
 // в діапазоні режима сна.
 bool timeInRange() {
     // Розраховуєтсься час та межі в секундах
-    float total = hours * 3600 + minutes * 60 + seconds;
+    int total = clockCore.getSecondOfDay();
     int startTotal = sleep_start_hours * 3600 + sleep_start_minutes * 60 + sleep_start_seconds;
     int endTotal = sleep_end_hours * 3600 + sleep_end_minutes * 60 + sleep_end_seconds;
 
@@ -326,63 +671,117 @@ bool timeInRange() {
     }
 }
 
+// Чи зараз приглушений час: від CONTRAST_DIM_LEAD секунд до початку режиму
+// сну і до його кінця
+bool dimTime()
+{
+    if (!sleep_on)
+        return false;
+
+    int total = clockCore.getSecondOfDay();
+    int startTotal = (sleep_start_hours * 3600 + sleep_start_minutes * 60 + sleep_start_seconds - CONTRAST_DIM_LEAD +
+                      SECONDS_PER_DAY) % SECONDS_PER_DAY;
+    int endTotal = sleep_end_hours * 3600 + sleep_end_minutes * 60 + sleep_end_seconds;
+
+    if (startTotal <= endTotal)
+        return startTotal <= total and total <= endTotal;
+    return startTotal <= total or total <= endTotal;
+}
+
+// Контраст обох панелей (команда відправляється тільки якщо він змінився
+// або force)
+void setContrast(uint8_t contrast, bool force = false)
+{
+    if (contrast == panel_contrast && !force)
+        return;
+
+    leftOled.ssd1306_command(SSD1306_SETCONTRAST);
+    leftOled.ssd1306_command(contrast);
+    rightOled.ssd1306_command(SSD1306_SETCONTRAST);
+    rightOled.ssd1306_command(contrast);
+    panel_contrast = contrast;
+
+    energy.countOledBytes(0, 4);
+    energy.countOledBytes(1, 4);
+    energy.setOledLoad(0, leftPanel.getLitPixels(), contrast);
+    energy.setOledLoad(1, rightPanel.getLitPixels(), contrast);
+}
+
+// Ввімкнення та вимкнення обох дисплеїв (команда відправляється тільки
+// якщо стан змінився)
+void setDisplaysOn(bool on)
+{
+    if (on == displays_on)
+        return;
+
+    leftOled.ssd1306_command(on ? SSD1306_DISPLAYON : SSD1306_DISPLAYOFF);
+    rightOled.ssd1306_command(on ? SSD1306_DISPLAYON : SSD1306_DISPLAYOFF);
+    displays_on = on;
+
+    energy.countOledBytes(0, 2);
+    energy.countOledBytes(1, 2);
+    energy.setDisplayOn(on);
+}
+
+// Чи показується зараз час в режимі сну (після натиску SET)
+bool sleepShowing()
+{
+    return (int32_t)(sleep_show_until - currentTime) > 0;
+}
+
+// Скільки мікросекунд годинника залишилось до секунди доби target
+// (якщо це поточна секунда, то до неї ж наступної доби)
+uint64_t clockUsUntil(uint32_t target)
+{
+    uint32_t now = clockCore.getSecondOfDay();
+    uint32_t delta = (target + SECONDS_PER_DAY - now) % SECONDS_PER_DAY;
+    if (delta == 0)
+        delta = SECONDS_PER_DAY;
+    return delta * MICROS_PER_SECOND - clockCore.getMicrosOfSecond();
+}
+
+// Скільки мікросекунд годинника залишилось до секунди second від початку
+// епохи (0, якщо вона вже настала)
+uint64_t clockUsUntilSecond(uint64_t second)
+{
+    uint64_t now = clockCore.getEpochUs();
+    return second * MICROS_PER_SECOND > now ? second * MICROS_PER_SECOND - now : 0;
+}
+
 // ЕКРАН ГОДИННИКА
-// Оновлює час
+// Оновлює час (бере його з ядра годинника)
 void timeUpdate()
 {
-    if (seconds >= 60)
-    {
-        seconds = 0;
-        minutes += 1;
-    }
-    if (minutes >= 60)
-    {
-        minutes = 0;
-        hours += 1;
-    }
+    view.set(hours, clockCore.getHours(), VIEW_TIME);
+    view.set(minutes, clockCore.getMinutes(), VIEW_TIME);
+    view.set(seconds, clockCore.getSeconds(), VIEW_SECONDS);
 }
 
-// Оновлює дату
+// Оновлює дату (бере її з ядра годинника)
 void dateUpdate()
 {
-    if (hours >= 24)
-    {
-        hours = 0;
-        date += 1;
-        if (month == 2)
-        {
-            monthDays[1] = (year % 4 == 0) ? 29 : 28;
-        }
-    }
-    if (date > monthDays[month - 1])
-    {
-        date = 1;
-        month += 1;
-    }
-    if (month > 12)
-    {
-        month = 1;
-        year += 1;
-    }
+    view.set(date, clockCore.getDate(), VIEW_DATE);
+    view.set(month, clockCore.getMonth(), VIEW_DATE);
+    view.set(year, clockCore.getYear(), VIEW_DATE);
 }
 
 // Оновлення годиника в цілому
 void clockUpdate()
 {
     // Якщо кнопка меню затиснута, то перейти на екран меню
-    if (setButton.getHold() && setButton.getPressedTime() >= MENU_ACTIVATION_THRESHOLD && !sleeping)
+    if (setButton.getHeld() && !sleeping)
     {
-        menu_option = options_count - 1;
+        menu_option = OPTION_EXIT;
         mode = 1;
         setButton.reset();
     }
 
-    // Розрахунок скільки секунд пройшло з минулого оновлення
-    float deltaTime = currentTime - previousTime;
-    // Оффест
-    double time_offset = (sleeping and !setButton.getClicked()) ? SLEEP_TIME_OFFSET : TIME_OFFSET;
+    // Розрахунок скільки мілісекунд пройшло з минулого оновлення
+    uint32_t deltaTime = currentTime - previousTime;
+    // Поправка (нічна, якщо годинник спить)
+    int32_t time_offset = calibrator.correction((uint64_t)deltaTime * 1000, sleeping and !setButton.getClicked());
 
-    seconds += (deltaTime / MILLI_TO_SECOND) * time_offset;
+    clockCore.advance((uint64_t)deltaTime * 1000, time_offset);
 
     // Оновлення даних годиника
     timeUpdate();
@@ -393,24 +792,36 @@ void clockUpdate()
     if (setButton.getPressed() && alarm_playing)
     {
         alarm_playing = false;
+        view.bump(VIEW_ALARM);
+        trace.record(TRACE_ALARM_STOP, ringing_alarm, traceMs());
+        melodyPlayer.stop();
         setButton.reset();
     }
-    // Якщо час співпадає з часом будильника, то запустити будильник
-    if ((int)seconds == alarm_seconds && minutes == alarm_minutes && hours == alarm_hours && alarm_on)
+    // Якщо момент будильника настав (навіть якщо пробудження проскочило
+    // його секунду), то запустити будильник
+    int fired = alarms.poll(clockCore.getEpochSeconds());
+    if (fired >= 0)
+    {
         alarm_playing = true;
+        ringing_alarm = fired;
+        view.bump(VIEW_ALARM);
+        trace.record(TRACE_ALARM_START, fired, traceMs());
+        melodyPlayer.play(MELODIES[alarms.get(fired).melody % MELODY_COUNT]);
+    }
 
-    // Ввімкнення та вимкення пієзодинаміка для створення того самого
-    // пікання :)
-    if (alarm_playing && currentTime % 500 > 250)
-        analogWrite(PIEZO, 150);
-    else
-        analogWrite(PIEZO, 0);
+    // Одноразовий будильник вимкнувся (спрацював або запізнився і
+    // пропущений), і це теж треба записати
+    if (alarms.takeDisarmed())
+    {
+        settingsStore.mark();
+        settingsStore.queue();
+    }
+
+    // Ноти перемикає таймер плеєра, тут тільки облік часу звучання
+    energy.countPiezoUs(melodyPlayer.takeSoundingUs());
 
     if (alarm_playing) {
-        esp_sleep_enable_timer_wakeup(0.2 * MICRO_TO_SECOND);
-        gpio_wakeup_disable((gpio_num_t)setButton.getPin());
-        leftOled.ssd1306_command(SSD1306_DISPLAYON);        
-        rightOled.ssd1306_command(SSD1306_DISPLAYON);
+        setDisplaysOn(true);
         sleeping = false;
     }
 
@@ -420,42 +831,36 @@ void clockUpdate()
 // Відмальовка екрану годиника з будильником
 void displayClock()
 {
+    // Цифри малюються готовими спрайтами (DigitSprites.h)
+    char text[FORMAT_DATE_SIZE];
+
     if (!alarm_playing)
     {
-        leftOled.setTextSize(4);
         rightOled.setTextSize(2);
 
-        for (int i = 0; i < 2; i++)
-        {
-            leftOled.setCursor(2 + i, 16);
-            leftOled.print((hours < 10) ? '0' + String((int)hours) : String((int)hours));
-            leftOled.print(":");
-            leftOled.print((minutes < 10) ? '0' + String((int)minutes) : String((int)minutes));
-        }
+        // Жирні цифри, якщо вони влазять в бюджет пікселів, інакше тонкі
+        formatHoursMinutes(text, hours, minutes);
+        int budget = dimmed ? CLOCK_PIXEL_BUDGET_NIGHT : CLOCK_PIXEL_BUDGET_DAY;
+        drawSpriteText(leftOled, 2, 16, text, spriteTextPixels(text, FACE_4X_BOLD) <= budget ? FACE_4X_BOLD : FACE_4X);
 
         if (display_seconds) {
-            leftOled.setTextSize(1);
-            leftOled.setCursor(56, 56);
-            leftOled.print((seconds < 10) ? '0' + String((int)seconds) : String((int)seconds));
+            formatNumber(text, seconds, 2);
+            drawSpriteText(leftOled, 56, 56, text, FACE_1X);
         }
 
-        rightOled.setCursor(7, 8);
-        rightOled.print((date < 10) ? '0' + String(date) : String(date));
-        rightOled.print(".");
-        rightOled.print((month < 10) ? '0' + String(month) : String(month));
-        rightOled.print(".");
-        rightOled.print(year);
-
-        rightOled.drawFastHLine(0, 31, 128, WHITE);
+        formatDate(text, date, month, year);
+        drawSpriteText(rightOled, 7, 8, text, FACE_2X);
 
-        // Зчитування температури 2 рази на хвилину 
-        if (seconds == 0 or seconds == 30 or sleeping) {
-            String temperature = String(bmp.readTemperature());
-            temperature.remove(temperature.length() - 1);
-        }
+        // Вночі замість лінії - пунктир (кожен четвертий піксель)
+        if (!dimmed)
+            rightOled.drawFastHLine(0, 31, 128, WHITE);
+        else
+            for (int x = 0; x < 128; x += 4)
+                rightOled.drawPixel(x, 31, WHITE);
 
+        // Температура вже виміряна і відформатована (TemperatureSampler)
         rightOled.setCursor(31, 41);
-        rightOled.print(temperature);
+        rightOled.print(temperatureSampler.getText());
         rightOled.print("C");
     }
     else
@@ -468,39 +873,231 @@ void displayClock()
         leftOled.print("ALARM");
         leftOled.drawRect(4, 52, 120, 2, WHITE);
 
-        rightOled.setCursor(15, 26);
-        rightOled.print((alarm_hours < 10) ? '0' + String(alarm_hours) : String(alarm_hours));
-        rightOled.print(":");
-        rightOled.print((alarm_minutes < 10) ? '0' + String(alarm_minutes) : String(alarm_minutes));
-        rightOled.print(":");
-        rightOled.print((alarm_seconds < 10) ? '0' + String(alarm_seconds) : String(alarm_seconds));
+        const Alarm &alarm = alarms.get(ringing_alarm);
+        formatTime(text, alarm.hours, alarm.minutes, alarm.seconds);
+        drawSpriteText(rightOled, 15, 26, text, FACE_2X);
+    }
+}
+
+// ОПИС ЕКРАНІВ НАЛАШТУВАННЯ (див. SettingsMenu.h)
+
+// Кількість днів в місяці, який зараз виставляється
+int editedMonthDays()
+{
+    return daysInMonth(month, year);
+}
+
+const char *slotLabel(int slot)
+{
+    static char text[] = "#1";
+    text[1] = '1' + slot;
+    return text;
+}
+
+const char *alarmModeLabel(int mode)
+{
+    return ALARM_MODE_NAMES[mode];
+}
+
+const char *melodyLabel(int melody)
+{
+    return MELODIES[melody].name;
+}
+
+const char *weekdayLabel(int day)
+{
+    static char text[2];
+    text[0] = WEEKDAY_LETTERS[day];
+    return text;
+}
+
+// Поки час не змінений, годинник не чіпається: інакше відкриття екрану
+// обрізало б частку секунди, а час, проведений на екрані, губився б
+void updateTimeScreen()
+{
+    if (!time_edited)
+        return;
+
+    clockCore.setTime(hours, minutes, seconds);
+    if (mode == 1)
+    {
+        previousTime = currentTime;
+        timeCorrected();
+        alarms.rebuild(clockCore.getEpochSeconds());
     }
 }
 
+void updateDateScreen()
+{
+    // Після зміни місяця або року день може вийти за кінець місяця
+    if (date > daysInMonth(month, year))
+        date = 1;
+
+    clockCore.setDate(date, month, year);
+    if (mode == 1)
+        alarms.rebuild(clockCore.getEpochSeconds());
+}
+
+void drawEnergyScreen()
+{
+    rightOled.setTextSize(1);
+
+    leftOled.setTextSize(1);
+    leftOled.setCursor(43, 56);
+    leftOled.print("mAh/day");
+
+    // Оцінка споживання по підсистемах, по рядку на кожну
+    EnergyEstimate estimate = energy.estimate();
+    const char *labels[] = {"CPU", "SLEEP", "OLED", "I2C", "SENSORS", "PIEZO", "OTHER", "TOTAL"};
+    float values[] = {estimate.cpu, estimate.sleep, estimate.oled, estimate.i2c,
+                      estimate.temperature + estimate.battery, estimate.piezo, estimate.baseline, estimate.total};
+
+    for (int row = 0; row < 8; row++)
+    {
+        rightOled.setCursor(4, row * 8);
+        rightOled.print(labels[row]);
+        rightOled.setCursor(70, row * 8);
+        rightOled.print(values[row], 3);
+    }
+}
+
+// Звіт про енергію та час передач по I2C в Serial
+void printEnergyReport()
+{
+    energy.print(Serial);
+    Serial.printf("power: %s\r\n", power.isAutomatic() ? "esp_pm, automatic light sleep" : "manual light sleep");
+    oledTiming.print(Serial, "oled");
+    sensorTiming.print(Serial, "bmp280");
+}
+
+void drawBatteryScreen()
+{
+    char text[FORMAT_DATE_SIZE];
+
+    // Заряд вирівняний по правому краю: "100%", " 57%", "  7%"
+    formatNumber(text, charge, 3, ' ');
+    text[3] = '%';
+    text[4] = '\0';
+
+    rightOled.setCursor(40, 9);
+    rightOled.print(text);
+
+    drawRoundRect(30, 33, 14, 22, 5, 1, &rightOled);
+    if (charge > 5) drawPattern(30, 33, 14, 22, 4, &rightOled);
+    
+    rightOled.drawRect(48, 33, 14, 22, WHITE);
+    if (charge > 25) drawPattern(48, 33, 14, 22, 4, &rightOled);
+
+    rightOled.drawRect(66, 33, 14, 22, WHITE);
+    if (charge > 50) drawPattern(66, 33, 14, 22, 4, &rightOled);
+
+    drawRoundRect(84, 33, 14, 22, 5, 0, &rightOled);
+    if (charge > 75) drawPattern(84, 33, 14, 22, 4, &rightOled);
+}
+
+// Поля кожного екрану (в порядку переходу кнопкою SET) та розділювачі між
+// ними: час "12:00:05" та дата "17.07.2025" шрифтом 2x (12 пікселів на
+// символ)
+constexpr MenuLabel TIME_LABELS[] = {{":", 39, 26}, {":", 75, 26}};
+constexpr MenuLabel DATE_LABELS[] = {{".", 31, 26}, {".", 67, 26}};
+
+constexpr MenuField TIME_FIELDS[] = {
+    numberField(&hours, 0, 23, true, 15, 2, 19),
+    numberField(&minutes, 0, 59, true, 51, 2, 55),
+    numberField(&seconds, 0, 59, true, 87, 2, 91),
+};
+
+constexpr MenuField DATE_FIELDS[] = {
+    numberField(&date, 1, 31, true, 7, 2, 10, editedMonthDays),
+    numberField(&month, 1, 12, true, 43, 2, 46),
+    numberField(&year, CLOCK_MIN_YEAR, CLOCK_MAX_YEAR, false, 79, 4, 95),
+};
+
+// Будильник: номер, режим та мелодія; час та дні тижня під ним
+constexpr MenuField ALARM_STATUS_FIELDS[] = {
+    choiceField(&alarm_slot, ALARM_SLOTS, 14, 8, slotLabel, loadAlarmFields),
+    choiceField(&alarm_mode, ALARM_MODES, 14, 40, alarmModeLabel),
+    choiceField(&alarm_melody, MELODY_COUNT, 50, 8, melodyLabel),
+};
+
+constexpr MenuField ALARM_TIME_FIELDS[] = {
+    numberField(&alarm_hours, 0, 23, true, 15, 2, 19),
+    numberField(&alarm_minutes, 0, 59, true, 51, 2, 55),
+    numberField(&alarm_seconds, 0, 59, true, 87, 2, 91),
+    bitField(&alarm_days, 0, 15, 56, weekdayLabel),
+    bitField(&alarm_days, 1, 29, 56, weekdayLabel),
+    bitField(&alarm_days, 2, 43, 56, weekdayLabel),
+    bitField(&alarm_days, 3, 57, 56, weekdayLabel),
+    bitField(&alarm_days, 4, 71, 56, weekdayLabel),
+    bitField(&alarm_days, 5, 85, 56, weekdayLabel),
+    bitField(&alarm_days, 6, 99, 56, weekdayLabel),
+};
+
+constexpr MenuField SLEEP_START_FIELDS[] = {
+    numberField(&sleep_start_hours, 0, 23, true, 15, 2, 19),
+    numberField(&sleep_start_minutes, 0, 59, true, 51, 2, 55),
+    numberField(&sleep_start_seconds, 0, 59, true, 87, 2, 91),
+};
+
+constexpr MenuField SLEEP_END_FIELDS[] = {
+    numberField(&sleep_end_hours, 0, 23, true, 15, 2, 19),
+    numberField(&sleep_end_minutes, 0, 59, true, 51, 2, 55),
+    numberField(&sleep_end_seconds, 0, 59, true, 87, 2, 91),
+};
+
+constexpr MenuField SLEEP_STATUS_FIELDS[] = {toggleField(&sleep_on, 14, 26)};
+constexpr MenuField SECONDS_FIELDS[] = {toggleField(&display_seconds, 14, 26)};
+
+// Екрани в порядку MenuOption
+constexpr MenuScreen SCREENS[] = {
+    {"Energy", "ENERGY", 28, nullptr, 0, nullptr, 0, false, nullptr, drawEnergyScreen},
+    {"Battery", "BATTERY", 21, nullptr, 0, nullptr, 0, false, nullptr, drawBatteryScreen},
+    {"Display Seconds", "SECONDS", 21, SECONDS_FIELDS, menuCount(SECONDS_FIELDS), nullptr, 0, true, nullptr, nullptr},
+    {"Sleep End", "END TIME", 16, SLEEP_END_FIELDS, menuCount(SLEEP_END_FIELDS), TIME_LABELS, menuCount(TIME_LABELS),
+     true, nullptr, nullptr},
+    {"Sleep Start", "START TIME", 5, SLEEP_START_FIELDS, menuCount(SLEEP_START_FIELDS), TIME_LABELS,
+     menuCount(TIME_LABELS), true, nullptr, nullptr},
+    {"Sleep Status", "SLEEP", 33, SLEEP_STATUS_FIELDS, menuCount(SLEEP_STATUS_FIELDS), nullptr, 0, true, nullptr,
+     nullptr},
+    {"Alarm Time", "ALARM TIME", 5, ALARM_TIME_FIELDS, menuCount(ALARM_TIME_FIELDS), TIME_LABELS,
+     menuCount(TIME_LABELS), true, storeAlarmFields, nullptr},
+    {"Alarm Status", "ALARM", 33, ALARM_STATUS_FIELDS, menuCount(ALARM_STATUS_FIELDS), nullptr, 0, true,
+     storeAlarmFields, nullptr},
+    {"Date", "DATE", 40, DATE_FIELDS, menuCount(DATE_FIELDS), DATE_LABELS, menuCount(DATE_LABELS), true,
+     updateDateScreen, nullptr},
+    {"Time", "TIME", 40, TIME_FIELDS, menuCount(TIME_FIELDS), TIME_LABELS, menuCount(TIME_LABELS), true,
+     updateTimeScreen, nullptr},
+    {"Exit", nullptr, 0, nullptr, 0, nullptr, 0, false, nullptr, nullptr},
+};
+
+static_assert(menuCount(SCREENS) == OPTION_COUNT, "one screen per menu option");
+
 // ЕКРАН МЕНЮ
 // Оновлення та обробка кнопок в меню
 void menuUpdate()
 {
     // Піднятися вверх по списку дій
-    if (upButton.getClicked() && menu_option < options_count - 1) {
+    if (upButton.getClicked() && menu_option < OPTION_EXIT) {
         menu_option++;
         if (menu_option > option_cursor) option_cursor++;
+        view.bump(VIEW_MENU);
     }
 
     // Спуститися вниз по списку дій
     if (downButton.getClicked() && menu_option > 0) {
         menu_option--;
         if (menu_option <= option_cursor - 4) option_cursor--;
+        view.bump(VIEW_MENU);
     }
 
     // Якщо кнопка затиснута (тобто користувач підтвердив вибір)
-    if (setButton.getHold() && setButton.getPressedTime() >= MENU_ACTIVATION_THRESHOLD)
+    if (setButton.getHeld())
     {
         // Скидаємо стан кнопки
         setButton.reset();
 
         // Якщо вибір був вийти, топ повертаємось на годинник
-        if (menu_option == options_count - 1)
+        if (menu_option == OPTION_EXIT)
         {
             mode = 0;
         }
@@ -509,32 +1106,30 @@ void menuUpdate()
         {
             mode = 2;
             current_field = 0;
-        }
 
-        // Оновлення часу (потрібно, щоб годинник не збився поки він у меню)
-        float deltaTime = currentTime - previousTime;
-        float deltaSeconds = deltaTime / MILLI_TO_SECOND;
-        while (deltaSeconds > 60)
-        {
-            float timeToMinute = 60.0 - seconds;
-            deltaSeconds -= timeToMinute;
-            seconds += timeToMinute;
-            timeUpdate();
-            dateUpdate();
-        }
-        seconds += deltaSeconds;
+            // Звіт про енергію також відправляється в Serial
+            if (menu_option == OPTION_ENERGY)
+                printEnergyReport();
 
-        if (seconds > 60)
-        {
-            deltaSeconds = seconds - 60;
-            timeUpdate();
-            dateUpdate();
-            seconds += deltaSeconds;
+            if (menu_option == OPTION_ALARM_STATUS || menu_option == OPTION_ALARM_TIME)
+                loadAlarmFields();
         }
+
+        // Оновлення часу (потрібно, щоб годинник не збився поки він у меню)
+        uint32_t deltaTime = currentTime - previousTime;
+        clockCore.advance((uint64_t)deltaTime * 1000, calibrator.correction((uint64_t)deltaTime * 1000, false));
         timeUpdate();
         dateUpdate();
 
         previousTime = currentTime;
+
+        // Звідки почалось редагування часу (для калібровки)
+        if (mode == 2 && menu_option == OPTION_TIME)
+        {
+            time_edit_us = clockCore.getEpochUs();
+            time_edit_ms = currentTime;
+            time_edited = false;
+        }
     }
 }
 
@@ -549,61 +1144,41 @@ void displayMenu()
     leftOled.print("SET MENU");
     leftOled.drawRect(4, 52, 120, 2, WHITE);
 
-    for (int option = options_count - 1; option >= 0; option--)
+    for (int option = OPTION_EXIT; option >= 0; option--)
     {
         if (option > option_cursor - 4 and option <= option_cursor) {
-            rightOled.setCursor(12, 8 + 14 * (options_count - 1 - option - (options_count - 1 - option_cursor)));
-            rightOled.print(options[option]);
+            rightOled.setCursor(12, 8 + 14 * (option_cursor - option));
+            rightOled.print(SCREENS[option].name);
         }
     }
 
-    rightOled.drawRect(5, 5 + 14 * (options_count - 1 - menu_option - (options_count - 1 - option_cursor)), 104, 13, WHITE);
+    rightOled.drawRect(5, 5 + 14 * (option_cursor - menu_option), 104, 13, WHITE);
 }
 
 // ЕКРАН НАЛАШТУВАННЯ
 // Оновлення екрану налаштувань та обробка кнопок
 void actionMenuUpdate()
 {
-    // Повисити дату, хвилини, місяць, тощо.
-    if (upButton.getClicked() || upButton.getHold() && upButton.getPressedTime() > MILLI_TO_SECOND)
-    {
-        if (menu_option == 8)
-            (*timeFields[current_field])++;
-        else if (menu_option == 7)
-            (*dateFields[current_field])++;
-        else if (menu_option == 6)
-            alarm_on = (alarm_on) ? false : true;
-        else if (menu_option == 5)
-            (*alarmFields[current_field])++;
-        else if (menu_option == 4) 
-            sleep_on = (sleep_on) ? false : true;
-        else if (menu_option == 3)
-            (*sleepStartFields[current_field])++;
-        else if (menu_option == 2)
-            (*sleepEndFields[current_field])++;
-        else if (menu_option == 1)
-            display_seconds = (display_seconds) ? false : true;
-    }
+    const MenuScreen &screen = SCREENS[menu_option];
+
+    // Повисити або понизити поточне поле (дату, хвилини, місяць, тощо).
+    // Межі та чи значення ходить по колу (59 -> 00) - в описі поля
+    int delta = 0;
+    if (upButton.getClicked() || upButton.getRepeat())
+        delta++;
+    if (downButton.getClicked() || downButton.getRepeat())
+        delta--;
 
-    // Понизити дату, хвилини, місяць, тощо.
-    if (downButton.getClicked() || downButton.getHold() && downButton.getPressedTime() > MILLI_TO_SECOND)
+    if (delta && screen.fieldCount)
     {
-        if (menu_option == 8)
-            (*timeFields[current_field])--;
-        else if (menu_option == 7)
-            (*dateFields[current_field])--;
-        else if (menu_option == 6)
-            alarm_on = (alarm_on) ? false : true;
-        else if (menu_option == 5)
-            (*alarmFields[current_field])--;
-        else if (menu_option == 4) 
-            sleep_on = (sleep_on) ? false : true;
-        else if (menu_option == 3)
-            (*sleepStartFields[current_field])--;
-        else if (menu_option == 2)
-            (*sleepEndFields[current_field])--;
-        else if (menu_option == 1)
-            display_seconds = (display_seconds) ? false : true;
+        stepMenuField(screen.fields[current_field], delta);
+
+        // Змінене поле буде записане у флеш після виходу з налаштувань
+        if (screen.saved)
+            settingsStore.mark();
+        if (menu_option == OPTION_TIME)
+            time_edited = true;
+        view.bump(VIEW_FIELD);
     }
 
     // Переключення між полям (якщо я, наприклад, зараз на годинах, то після натисику
@@ -612,107 +1187,72 @@ void actionMenuUpdate()
     if (setButton.getClicked())
     {
         current_field++;
-        if (current_field >= fieldCount[menu_option])
+        if (current_field >= screen.fieldCount)
         {
             current_field = 0;
         }
+        view.bump(VIEW_FIELD);
+
+        // На екрані енергії SET повторно відправляє звіт в Serial
+        if (menu_option == OPTION_ENERGY)
+            printEnergyReport();
     }
 
     // Якщо кнопку SET затиснуто, то користувач підтверджує налаштування та можна переходити
     // Назад на екран меню
-    if (setButton.getHold() && setButton.getPressedTime() >= MENU_ACTIVATION_THRESHOLD)
+    if (setButton.getHeld())
     {
         mode = 1;
         setButton.reset();
+        settingsStore.queue();
     }
 
-    // Ціклічне поводження кожного поля (якщо хвилина 59 або місяць 12, то натиснувши на кнопку
-    // UP хвилина стане на занчення 00 а місяць на 01, і так для всіх полів)
-    switch (menu_option)
+    if (screen.update)
+        screen.update();
+}
+
+// Відмальовка одного поля на правому екрані (вибране поле - зі стрілками
+// або інверсне)
+void drawMenuField(const MenuField &field, bool selected)
+{
+    char text[FORMAT_DATE_SIZE]; // Найдовше число - рік
+
+    switch (field.type)
     {
-    case 8:
-        if (mode == 1)
-            previousTime = currentTime;
-
-        if (seconds < 0)
-            seconds = 59;
-        else if (seconds >= 60)
-            seconds = 0;
-
-        if (minutes < 0)
-            minutes = 59;
-        else if (minutes >= 60)
-            minutes = 0;
-
-        if (hours < 0)
-            hours = 23;
-        else if (hours >= 24)
-            hours = 0;
-        break;
+    case FIELD_NUMBER:
+        rightOled.setTextSize(2);
+        rightOled.setCursor(field.x, field.y);
+        formatNumber(text, *field.value, field.digits);
+        rightOled.print(text);
 
-    case 7:
-        if (month == 2)
-            monthDays[1] = (year % 4 == 0) ? 29 : 28;
-        else if (month < 1)
-            month = 12;
-        else if (month > 12)
-            month = 1;
-
-        if (date > monthDays[month - 1])
-            date = 1;
-        else if (date < 1)
-            date = monthDays[month - 1];
+        if (selected)
+        {
+            drawVArrow(field.arrowX, 10, 13, 8, 3, 1, &rightOled);
+            drawVArrow(field.arrowX, 45, 13, 8, 3, -1, &rightOled);
+        }
         break;
 
-    case 5:
-        if (alarm_seconds < 0)
-            alarm_seconds = 59;
-        else if (alarm_seconds >= 60)
-            alarm_seconds = 0;
-
-        if (alarm_minutes < 0)
-            alarm_minutes = 59;
-        else if (alarm_minutes >= 60)
-            alarm_minutes = 0;
-
-        if (alarm_hours < 0)
-            alarm_hours = 23;
-        else if (alarm_hours >= 24)
-            alarm_hours = 0;
+    case FIELD_TOGGLE:
+        rightOled.setTextSize(2);
+        drawOption(&rightOled, field.x, field.y, "ON", *field.flag);
+        drawOption(&rightOled, field.x + 55, field.y, "OFF", !*field.flag);
         break;
 
-    case 3:
-        if (sleep_start_seconds < 0)
-            sleep_start_seconds = 59;
-        else if (sleep_start_seconds >= 60)
-            sleep_start_seconds = 0;
-
-        if (sleep_start_minutes < 0)
-            sleep_start_minutes = 59;
-        else if (sleep_start_minutes >= 60)
-            sleep_start_minutes = 0;
-
-        if (sleep_start_hours < 0)
-            sleep_start_hours = 23;
-        else if (sleep_start_hours >= 24)
-            sleep_start_hours = 0;
+    case FIELD_CHOICE:
+        rightOled.setTextSize(2);
+        drawOption(&rightOled, field.x, field.y, field.label(*field.value), selected);
         break;
 
-    case 2:
-        if (sleep_end_seconds < 0)
-            sleep_end_seconds = 59;
-        else if (sleep_end_seconds >= 60)
-            sleep_end_seconds = 0;
-
-        if (sleep_end_minutes < 0)
-            sleep_end_minutes = 59;
-        else if (sleep_end_minutes >= 60)
-            sleep_end_minutes = 0;
-
-        if (sleep_end_hours < 0)
-            sleep_end_hours = 23;
-        else if (sleep_end_hours >= 24)
-            sleep_end_hours = 0;
+    case FIELD_BIT:
+        rightOled.setTextSize(1);
+        if (selected)
+        {
+            rightOled.fillRect(field.x - 2, field.y - 1, 9, 9, WHITE);
+            rightOled.setTextColor(BLACK);
+        }
+        rightOled.setCursor(field.x, field.y);
+        rightOled.print((*field.value >> field.min & 1) ? field.label(field.min) : ".");
+        rightOled.setTextColor(WHITE);
         break;
     }
 }
@@ -720,290 +1260,335 @@ void actionMenuUpdate()
 // Відмальовування екрану налаштувань
 void displayActionMenu()
 {
-    switch (menu_option)
-    {
-    case 8:
-        leftOled.setTextSize(2);
-        rightOled.setTextSize(2);
+    const MenuScreen &screen = SCREENS[menu_option];
 
-        leftOled.drawRect(4, 12, 120, 2, WHITE);
-        leftOled.setCursor(40, 26);
-        leftOled.print("TIME");
-        leftOled.drawRect(4, 52, 120, 2, WHITE);
-
-        rightOled.setCursor(15, 26);
-        rightOled.print((hours < 10) ? '0' + String((int)hours) : String((int)hours));
-        rightOled.print(":");
-        rightOled.print((minutes < 10) ? '0' + String((int)minutes) : String((int)minutes));
-        rightOled.print(":");
-        rightOled.print((seconds < 10) ? '0' + String((int)seconds) : String((int)seconds));
-
-        drawVArrow(19 + 36.3 * current_field, 10, 13, 8, 3, 1, &rightOled);
-        drawVArrow(19 + 36.3 * current_field, 45, 13, 8, 3, -1, &rightOled);
+    leftOled.setTextSize(2);
+    rightOled.setTextSize(2);
 
-        break;
+    leftOled.drawRect(4, 12, 120, 2, WHITE);
+    leftOled.setCursor(screen.titleX, 26);
+    leftOled.print(screen.title);
+    leftOled.drawRect(4, 52, 120, 2, WHITE);
 
-    case 7:
-        leftOled.setTextSize(2);
-        rightOled.setTextSize(2);
+    if (screen.draw)
+    {
+        screen.draw();
+        return;
+    }
 
-        leftOled.drawRect(4, 12, 120, 2, WHITE);
-        leftOled.setCursor(40, 26);
-        leftOled.print("DATE");
-        leftOled.drawRect(4, 52, 120, 2, WHITE);
+    for (int i = 0; i < screen.labelCount; i++)
+    {
+        rightOled.setCursor(screen.labels[i].x, screen.labels[i].y);
+        rightOled.print(screen.labels[i].text);
+    }
 
-        rightOled.setCursor(7, 26);
-        rightOled.print((date < 10) ? '0' + String(date) : String(date));
-        rightOled.print(".");
-        rightOled.print((month < 10) ? '0' + String(month) : String(month));
-        rightOled.print(".");
-        rightOled.print(year);
+    for (int i = 0; i < screen.fieldCount; i++)
+        drawMenuField(screen.fields[i], i == current_field);
+}
 
-        if (current_field == 0)
-        {
-            drawVArrow(10, 10, 13, 8, 3, 1, &rightOled);
-            drawVArrow(10, 45, 13, 8, 3, -1, &rightOled);
-        }
-        else if (current_field == 1)
-        {
-            drawVArrow(46, 10, 13, 8, 3, 1, &rightOled);
-            drawVArrow(46, 45, 13, 8, 3, -1, &rightOled);
-        }
-        else
-        {
-            drawVArrow(95, 10, 13, 8, 3, 1, &rightOled);
-            drawVArrow(95, 45, 13, 8, 3, -1, &rightOled);
-        }
+// ВІДМАЛЬОВКА
+// Відмальовка кадру екрану режиму screenMode та відправка змін на панелі.
+// Якщо нічого з того, що показує екран, не змінилось, кадр в буферах вже
+// правильний і не малюється та не порівнюється з панелями.
+void displayFrame(int screenMode)
+{
+    // Номер екрану (годинник, погашений годинник, меню, екран кожної
+    // опції) та частини стану, які на ньому видно
+    int screen;
+    uint32_t parts = VIEW_MASK(VIEW_SCREEN);
+    bool clockShown = !sleeping or sleepShowing(); // Годинник видно тільки коли не спимо
 
+    switch (screenMode)
+    {
+    case 0:
+        screen = clockShown ? 0 : 1;
+        if (clockShown)
+            parts |= VIEW_MASK(VIEW_TIME) | VIEW_MASK(VIEW_DATE) | VIEW_MASK(VIEW_TEMPERATURE) | VIEW_MASK(VIEW_ALARM) |
+                     VIEW_MASK(VIEW_DIM);
+        if (clockShown && display_seconds)
+            parts |= VIEW_MASK(VIEW_SECONDS);
         break;
-
-    case 6:
-        leftOled.setTextSize(2);
-        rightOled.setTextSize(2);
-
-        leftOled.drawRect(4, 12, 120, 2, WHITE);
-        leftOled.setCursor(33, 26);
-        leftOled.print("ALARM");
-        leftOled.drawRect(4, 52, 120, 2, WHITE);
-
-        if (alarm_on) {
-            rightOled.setTextColor(BLACK);
-            rightOled.fillRect(9, 20, 33, 24, WHITE);
-            rightOled.setCursor(14, 26);
-            rightOled.print("ON");
-
-            rightOled.setTextColor(WHITE);
-            rightOled.setCursor(69, 26);
-            rightOled.print("OFF");
-        } else {
-            rightOled.setTextColor(WHITE);
-            rightOled.setCursor(14, 26);
-            rightOled.print("ON");
-            
-            rightOled.setTextColor(BLACK);
-            rightOled.fillRect(64, 20, 42, 24, WHITE);
-            rightOled.setCursor(69, 26);
-            rightOled.print("OFF");
-        }
-
-        rightOled.setTextColor(WHITE);
+    case 1:
+        screen = 2;
+        parts |= VIEW_MASK(VIEW_MENU);
         break;
+    default:
+        screen = 3 + menu_option;
+        parts |= VIEW_MASK(VIEW_FIELD);
+        if (menu_option == OPTION_BATTERY)
+            parts |= VIEW_MASK(VIEW_BATTERY);
+        break;
+    }
+    bool switched = screen != shown_screen;
+    view.set(shown_screen, screen, VIEW_SCREEN);
 
-    case 5:
-        leftOled.setTextSize(2);
-        rightOled.setTextSize(2);
+    // Оцінка енергії змінюється з кожним пробудженням
+    bool dirty = view.changed(drawn_frame, parts);
+    if (!dirty && !(screenMode == 2 && menu_option == OPTION_ENERGY))
+        return;
 
-        leftOled.drawRect(4, 12, 120, 2, WHITE);
-        leftOled.setCursor(5, 26);
-        leftOled.print("ALARM TIME");
-        leftOled.drawRect(4, 52, 120, 2, WHITE);
-
-        rightOled.setCursor(15, 26);
-        rightOled.print((alarm_hours < 10) ? '0' + String(alarm_hours) : String(alarm_hours));
-        rightOled.print(":");
-        rightOled.print((alarm_minutes < 10) ? '0' + String(alarm_minutes) : String(alarm_minutes));
-        rightOled.print(":");
-        rightOled.print((alarm_seconds < 10) ? '0' + String(alarm_seconds) : String(alarm_seconds));
+    // Новий екран перемальовується і порівнюється з панелями повністю
+    if (switched)
+        power.acquire(POWER_LOCK_CPU_MAX);
 
-        drawVArrow(19 + 36.3 * current_field, 10, 13, 8, 3, 1, &rightOled);
-        drawVArrow(19 + 36.3 * current_field, 45, 13, 8, 3, -1, &rightOled);
+    leftOled.clearDisplay();
+    rightOled.clearDisplay();
 
+    switch (screenMode)
+    {
+    case 0:
+        if (clockShown)
+            displayClock();
         break;
+    case 1:
+        displayMenu();
+        break;
+    case 2:
+        displayActionMenu();
+        break;
+    }
 
-    case 4:
-        leftOled.setTextSize(2);
-        rightOled.setTextSize(2);
+    // Оновлення дисплею (відправляються тільки змінені частини кадру)
+    energy.countOledBytes(0, leftPanel.flush());
+    energy.countOledBytes(1, rightPanel.flush());
+    energy.setOledLoad(0, leftPanel.getLitPixels(), panel_contrast);
+    energy.setOledLoad(1, rightPanel.getLitPixels(), panel_contrast);
 
-        leftOled.drawRect(4, 12, 120, 2, WHITE);
-        leftOled.setCursor(33, 26);
-        leftOled.print("SLEEP");
-        leftOled.drawRect(4, 52, 120, 2, WHITE);
+    if (switched)
+        power.release(POWER_LOCK_CPU_MAX);
+}
 
-        if (sleep_on) {
-            rightOled.setTextColor(BLACK);
-            rightOled.fillRect(9, 20, 33, 24, WHITE);
-            rightOled.setCursor(14, 26);
-            rightOled.print("ON");
-
-            rightOled.setTextColor(WHITE);
-            rightOled.setCursor(69, 26);
-            rightOled.print("OFF");
-        } else {
-            rightOled.setTextColor(WHITE);
-            rightOled.setCursor(14, 26);
-            rightOled.print("ON");
-            
-            rightOled.setTextColor(BLACK);
-            rightOled.fillRect(64, 20, 42, 24, WHITE);
-            rightOled.setCursor(69, 26);
-            rightOled.print("OFF");
-        }
+// Планування наступного пробудження: чип спить до найближчої події, яка
+// щось змінить на екрані або в стані годинника
+void scheduleWakeup()
+{
+    wakeScheduler.reset();
 
-        rightOled.setTextColor(WHITE);
-        break;
+    // Фронти кнопок будять чип через GPIO, а кінець фільтрації брязкоту,
+    // затиск та повтори - за таймером
+    for (Button *button : buttons)
+        wakeScheduler.request((uint64_t)button->nextWakeMs() * 1000);
 
-    case 3:
-        leftOled.setTextSize(2);
-        rightOled.setTextSize(2);
+    // Зміна ноти мелодії (чип прокидається трохи раніше, щоб таймер плеєра
+    // спрацював вчасно; автоматичний сон esp_pm таймер будить сам) та
+    // блимання світлодіода при низькому заряді
+    if (!power.isAutomatic())
+        wakeScheduler.request(melodyPlayer.nextWakeUs());
+    if (charge < 5)
+        wakeScheduler.request((500 - currentTime % 500) * 1000);
 
-        leftOled.drawRect(4, 12, 120, 2, WHITE);
-        leftOled.setCursor(5, 26);
-        leftOled.print("START TIME");
-        leftOled.drawRect(4, 52, 120, 2, WHITE);
+    // Вимірювання заряду батареї (температура планується окремо, після
+    // всіх інших подій, див. TemperatureSampler::schedule)
+    wakeScheduler.request((uint64_t)battery.nextWakeMs(currentTime) * 1000);
 
-        rightOled.setCursor(15, 26);
-        rightOled.print((sleep_start_hours < 10) ? '0' + String(sleep_start_hours) : String(sleep_start_hours));
-        rightOled.print(":");
-        rightOled.print((sleep_start_minutes < 10) ? '0' + String(sleep_start_minutes) : String(sleep_start_minutes));
-        rightOled.print(":");
-        rightOled.print((sleep_start_seconds < 10) ? '0' + String(sleep_start_seconds) : String(sleep_start_seconds));
+    // Відкладений запис налаштувань
+    wakeScheduler.request((uint64_t)settingsStore.nextCommitMs(currentTime) * 1000);
 
-        drawVArrow(19 + 36.3 * current_field, 10, 13, 8, 3, 1, &rightOled);
-        drawVArrow(19 + 36.3 * current_field, 45, 13, 8, 3, -1, &rightOled);
+    // В меню час не йде і на екрані нічого не змінюється без кнопок
+    if (mode != 0)
+        return;
 
-        break;
+    int32_t offset = calibrator.getPpb(sleeping);
+    uint64_t toSecond = MICROS_PER_SECOND - clockCore.getMicrosOfSecond();
 
-    case 2:
-        leftOled.setTextSize(2);
-        rightOled.setTextSize(2);
+    // Зміна часу на екрані (секунди або хвилини)
+    if (!sleeping or sleepShowing())
+    {
+        if (display_seconds)
+            wakeScheduler.requestClock(toSecond, offset);
+        else
+            wakeScheduler.requestClock(toSecond + (59 - seconds) * MICROS_PER_SECOND, offset);
+    }
 
-        leftOled.drawRect(4, 12, 120, 2, WHITE);
-        leftOled.setCursor(16, 26);
-        leftOled.print("END TIME");
-        leftOled.drawRect(4, 52, 120, 2, WHITE);
+    // Кінець показу часу в режимі сну
+    if (sleeping and sleepShowing())
+        wakeScheduler.request((uint64_t)(sleep_show_until - currentTime) * 1000);
 
-        rightOled.setCursor(15, 26);
-        rightOled.print((sleep_end_hours < 10) ? '0' + String(sleep_end_hours) : String(sleep_end_hours));
-        rightOled.print(":");
-        rightOled.print((sleep_end_minutes < 10) ? '0' + String(sleep_end_minutes) : String(sleep_end_minutes));
-        rightOled.print(":");
-        rightOled.print((sleep_end_seconds < 10) ? '0' + String(sleep_end_seconds) : String(sleep_end_seconds));
+    // Найближчий будильник
+    if (alarms.next() != UINT64_MAX)
+        wakeScheduler.requestClock(clockUsUntilSecond(alarms.next()), offset);
 
-        drawVArrow(19 + 36.3 * current_field, 10, 13, 8, 3, 1, &rightOled);
-        drawVArrow(19 + 36.3 * current_field, 45, 13, 8, 3, -1, &rightOled);
+    // Початок та кінець режиму сну (кінець включно, тому прокидаємось
+    // на наступній секунді)
+    if (sleep_on)
+    {
+        wakeScheduler.requestClock(clockUsUntil(sleep_start_hours * 3600 + sleep_start_minutes * 60 + sleep_start_seconds), offset);
+        wakeScheduler.requestClock(clockUsUntil((sleep_end_hours * 3600 + sleep_end_minutes * 60 + sleep_end_seconds + 1) % SECONDS_PER_DAY), offset);
 
-        break;
+        // Початок приглушення перед режимом сну
+        wakeScheduler.requestClock(clockUsUntil((sleep_start_hours * 3600 + sleep_start_minutes * 60 + sleep_start_seconds -
+                                                 CONTRAST_DIM_LEAD + SECONDS_PER_DAY) % SECONDS_PER_DAY), offset);
+    }
+}
 
-    case 1:
-        leftOled.setTextSize(2);
-        rightOled.setTextSize(2);
+// Показ RTC таймера в мікросекундах. На відміну від millis(), він йде і в
+// глибокому сні
+int64_t rtcMicros()
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+}
 
-        leftOled.drawRect(4, 12, 120, 2, WHITE);
-        leftOled.setCursor(21, 26);
-        leftOled.print("SECONDS");
-        leftOled.drawRect(4, 52, 120, 2, WHITE);
+// Чи можна заснути глибоким сном: режим сну на екрані годинника, час не
+// показується і нічого не відбувається. sleeping рахується ще до оновлення
+// годинника, тому межі режиму перевіряються за оновленим часом.
+bool nightSleepAllowed()
+{
+    return sleep_on && timeInRange() && mode == 0 && !sleepShowing() && !alarm_playing && !setButton.getPressed();
+}
 
-        if (display_seconds) {
-            rightOled.setTextColor(BLACK);
-            rightOled.fillRect(9, 20, 33, 24, WHITE);
-            rightOled.setCursor(14, 26);
-            rightOled.print("ON");
-
-            rightOled.setTextColor(WHITE);
-            rightOled.setCursor(69, 26);
-            rightOled.print("OFF");
-        } else {
-            rightOled.setTextColor(WHITE);
-            rightOled.setCursor(14, 26);
-            rightOled.print("ON");
-            
-            rightOled.setTextColor(BLACK);
-            rightOled.fillRect(64, 20, 42, 24, WHITE);
-            rightOled.setCursor(69, 26);
-            rightOled.print("OFF");
-        }
+// Глибокий сон до кінця режиму сну, будильника або натиску SET. Все, що
+// потрібно після пробудження, знаходиться в RTC пам'яті (див. setup())
+void nightSleep()
+{
+    setDisplaysOn(false);
 
-        rightOled.setTextColor(WHITE);
-        break;
+    // Запит на запис налаштувань не переживе глибокий сон
+    saveSettings(true);
 
-    case 0:
-        leftOled.setTextSize(2);
-        rightOled.setTextSize(2);
+    wakeScheduler.reset(SECONDS_PER_DAY * MICROS_PER_SECOND);
+    int32_t offset = calibrator.getPpb(true);
+    wakeScheduler.requestClock(clockUsUntil((sleep_end_hours * 3600 + sleep_end_minutes * 60 + sleep_end_seconds + 1) % SECONDS_PER_DAY), offset);
+    if (alarms.next() != UINT64_MAX)
+        wakeScheduler.requestClock(clockUsUntilSecond(alarms.next()), offset);
 
-        leftOled.drawRect(4, 12, 120, 2, WHITE);
-        leftOled.setCursor(21, 26);
-        leftOled.print("BATTERY");
-        leftOled.drawRect(4, 52, 120, 2, WHITE);
+    esp_sleep_enable_timer_wakeup(wakeScheduler.get());
+    esp_deep_sleep_enable_gpio_wakeup(1ULL << setButton.getPin(), ESP_GPIO_WAKEUP_GPIO_HIGH);
 
-        String buffer = "100%";
-        if (charge < 100 and charge >= 10) {
-            buffer[0] = ' '; buffer[1] = String(charge)[0]; buffer[2] = String(charge)[1];
-        } else if (charge < 10) {
-            buffer[0] = ' '; buffer[1] = ' '; buffer[2] = String(charge)[1];
-        }
+    // Ядро годинника просунуте до currentTime, тому відлік сну - з того ж
+    // моменту
+    night_sleep = true;
+    night_sleep_start = rtcMicros() - (int64_t)(uint32_t)(millis() - currentTime) * 1000;
 
-        rightOled.setCursor(40, 9);
-        rightOled.print(buffer);
+    energy.sleep();
+    esp_deep_sleep_start();
+}
 
-        drawRoundRect(30, 33, 14, 22, 5, 1, &rightOled);
-        if (charge > 5) drawPattern(30, 33, 14, 22, 4, &rightOled);
-        
-        rightOled.drawRect(48, 33, 14, 22, WHITE);
-        if (charge > 25) drawPattern(48, 33, 14, 22, 4, &rightOled);
+// Відновлення після глибокого сну в режимі сну: годинник просувається на
+// час сну за RTC таймером. Якщо чип розбудив таймер, а режим сну ще триває і
+// будильник не настав, то чип одразу засинає знову, не чіпаючи дисплеї та
+// датчики.
+void nightResume()
+{
+    esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
 
-        rightOled.drawRect(66, 33, 14, 22, WHITE);
-        if (charge > 50) drawPattern(66, 33, 14, 22, 4, &rightOled);
+    night_sleep = false;
+    int64_t slept = rtcMicros() - night_sleep_start;
+    clockCore.advance(slept, calibrator.correction(slept, true));
+    energy.resume(slept - micros());
 
-        drawRoundRect(84, 33, 14, 22, 5, 0, &rightOled);
-        if (charge > 75) drawPattern(84, 33, 14, 22, 4, &rightOled);
-        
-        break;
+    sleeping = sleep_on && timeInRange();
+    if (cause == ESP_SLEEP_WAKEUP_TIMER && sleeping && !alarms.due(clockCore.getEpochSeconds()))
+    {
+        energy.wake(cause);
+        nightSleep();
     }
+
+    // Натиск SET, який розбудив чип, показує час
+    if (cause == ESP_SLEEP_WAKEUP_GPIO)
+        sleep_show_until = currentTime + SLEEP_SHOW_TIME;
 }
 
 // Setup. Налаштування цифрових портів, ініціалізація усіх об'єктів та встановлення
 // початкових параметрів роботи
 void setup()
 {
-    esp_sleep_enable_timer_wakeup(0.2 * MICRO_TO_SECOND);
+    energy.boot();
+    Serial.begin(115200);
+
+    // До кінця setup() чип не засинає посеред ініціалізації периферії
+    power.begin();
+    power.acquire(POWER_LOCK_NO_SLEEP);
+
+    // Журнал переживає сон і перезавантаження, але не втрату живлення
+    trace.begin();
+    trace.record(TRACE_BOOT, esp_sleep_get_wakeup_cause(), traceMs());
+
+    currentTime = millis();
+    previousTime = currentTime;
+    mode = 0;
+    sleep_show_until = currentTime;
+    battery.resume(currentTime);
+
+    // Після глибокого сну стан годинника та налаштування вже в RTC пам'яті,
+    // інакше встановлюються початкові дата та час
+    if (night_sleep)
+    {
+        nightResume();
+    }
+    else
+    {
+        Settings settings;
+        if (settingsStore.load(settings))
+            applySettings(settings);
+
+        // Час після втрати живлення не виставлений користувачем, тому
+        // наступне виправлення тільки почне проміжок калібровки
+        calibrator.desync();
+
+        clockCore.setDate(date, month, year);
+        clockCore.setTime(hours, minutes, seconds);
+        alarms.rebuild(clockCore.getEpochSeconds());
+    }
+
     esp_sleep_enable_gpio_wakeup();
     pinMode(CHARGE_LED, OUTPUT);
     digitalWrite(CHARGE_LED, HIGH);
 
-    pinMode(PIEZO, OUTPUT);
+    melodyPlayer.begin(PIEZO);
 
     setButton.init();
     upButton.init();
     downButton.init();
 
-    Wire.begin(8, 10);
+    Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN, I2C_BUS_CLOCK);
 
-    bmp.begin(BMP280_ADDRESS_ALT, BMP280_CHIPID);
+    esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+    warm_boot = (cause == ESP_SLEEP_WAKEUP_TIMER || cause == ESP_SLEEP_WAKEUP_GPIO) && peripherals_marker == PERIPHERALS_READY;
+    first_frame_pending = true;
 
-    bmp.setSampling(
-        Adafruit_BMP280::MODE_NORMAL,
-        Adafruit_BMP280::SAMPLING_X16,
-        Adafruit_BMP280::SAMPLING_NONE,
-        Adafruit_BMP280::FILTER_OFF,
-        Adafruit_BMP280::STANDBY_MS_4000);
+    // Буфери кадру нові, тому перший кадр малюється повністю
+    shown_screen = -1;
+    drawn_frame.parts = 0;
 
-    leftOled.begin(SSD1306_SWITCHCAPVCC, 0x3D);
-    rightOled.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+    if (warm_boot)
+    {
+        // Панелі зберегли налаштування, вміст (копії в RTC пам'яті) та стан
+        // ввімкнення, тому виділяються тільки буфери кадру
+        leftOled.resume(SSD1306_SWITCHCAPVCC, LEFT_OLED_ADDRESS);
+        rightOled.resume(SSD1306_SWITCHCAPVCC, RIGHT_OLED_ADDRESS);
+
+        // Датчик теж зберіг налаштування, але драйвер все одно читає з нього
+        // коефіцієнти калібровки, тому це відкладається до першого кадру
+        sensor_pending = true;
+    }
+    else
+    {
+        peripherals_marker = 0;
 
-    leftOled.ssd1306_command(SSD1306_SETCONTRAST);
-    leftOled.ssd1306_command(1);
-    rightOled.ssd1306_command(SSD1306_SETCONTRAST);
-    rightOled.ssd1306_command(1);
+        // Датчик спить між вимірюваннями (примусовий режим)
+        bmp.begin(BMP280_ADDRESS_ALT, BMP280_CHIPID);
+        temperatureSampler.begin(millis());
+        last_temperature = temperatureSampler.getCelsius();
+        temperatureSampled();
+        temperatureShown();
+        sensor_pending = false;
+
+        leftOled.begin(SSD1306_SWITCHCAPVCC, LEFT_OLED_ADDRESS);
+        rightOled.begin(SSD1306_SWITCHCAPVCC, RIGHT_OLED_ADDRESS);
+
+        // Після ініціалізації вміст пам'яті панелей невідомий
+        leftPanel.invalidate();
+        rightPanel.invalidate();
+
+        // Контраст за розкладом (далі його змінює loop())
+        setContrast(dimTime() ? CONTRAST_NIGHT : CONTRAST_DAY, true);
+
+        // Після begin() дисплеї ввімкнені
+        displays_on = true;
+        peripherals_marker = PERIPHERALS_READY;
+    }
 
     leftOled.setTextSize(4);
     leftOled.setTextColor(WHITE);
@@ -1012,13 +1597,8 @@ void setup()
     rightOled.setTextColor(WHITE);
     rightOled.cp437(true);
 
-    currentTime = 0;
-    previousTime = 0;
-
-    mode = 0;
-
-    temperature = String(bmp.readTemperature());
-    temperature.remove(temperature.length() - 1);
+    energy.setDisplayOn(displays_on);
+    power.release(POWER_LOCK_NO_SLEEP);
 }
 
 // Цикл програми
@@ -1026,16 +1606,30 @@ void loop()
 {
     // Час від запуску Arduino
     currentTime = millis();
+    esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+    energy.wake(cause);
+
+    // Пробудження за таймером заплановані і надто часті для журналу
+    if (cause == ESP_SLEEP_WAKEUP_GPIO)
+        trace.record(TRACE_WAKE, cause, traceMs());
+
+    // Драйвер I2C чекає кінця передачі, заблокувавши задачу, тому без цього
+    // блокування автоматичний сон міг би настати посеред передачі
+    power.acquire(POWER_LOCK_NO_SLEEP);
 
     // Оновлення кнопок
-    setButton.update();
-    downButton.update();
-    upButton.update();
+    inputUpdate();
+
+    // Команди з комп'ютера по USB: "t" - вивести журнал подій
+    while (Serial.available())
+        if (Serial.read() == 't')
+            trace.dump(Serial);
+
+    // Навігація по меню та налаштуваннях - на найбільшій частоті
+    bool navigating = mode != 0;
+    if (navigating)
+        power.acquire(POWER_LOCK_CPU_MAX);
 
-    // Очищення дисплею
-    leftOled.clearDisplay();
-    rightOled.clearDisplay();
-    
     // Якщо режим сну включений, перевіряємо чи час є в діапазоні 
     // цього режиму і зберагіємо цю інформацію
     if (sleep_on) {
@@ -1044,76 +1638,91 @@ void loop()
         // Якщо час знаходиться в діапазоні режима сну і зараз головний 
         // екран (годинник + будильник)
         if (sleeping and mode == 0) {
-            esp_sleep_enable_timer_wakeup(10 * MICRO_TO_SECOND); // Затримка між оновленням тепер 10 секунд
+            // Якщо кнопку SET настиснуто, то включити екран на SLEEP_SHOW_TIME
+            if (setButton.getClicked())
+                sleep_show_until = currentTime + SLEEP_SHOW_TIME;
 
-            // Якщо кнопку SET настиснуто, то включити екран на одну ітерацію
-            if (setButton.getClicked()) {
-                gpio_wakeup_disable((gpio_num_t)setButton.getPin());
-                leftOled.ssd1306_command(SSD1306_DISPLAYON);                
-                rightOled.ssd1306_command(SSD1306_DISPLAYON);
+            if (sleepShowing()) {
+                setDisplaysOn(true);
             } else { // Інакше виключаємо екран
-                gpio_wakeup_enable((gpio_num_t)setButton.getPin(), GPIO_INTR_HIGH_LEVEL);
-                leftOled.ssd1306_command(SSD1306_DISPLAYOFF);                
-                rightOled.ssd1306_command(SSD1306_DISPLAYOFF);
+                setDisplaysOn(false);
                 setButton.reset();
             }
         } else { // Якщо ми в іншому вікні або ще не час спати, скидаємо параметри до звичних
-            esp_sleep_enable_timer_wakeup(0.2 * MICRO_TO_SECOND);
-            gpio_wakeup_disable((gpio_num_t)setButton.getPin());
-            leftOled.ssd1306_command(SSD1306_DISPLAYON);            
-            rightOled.ssd1306_command(SSD1306_DISPLAYON);
+            setDisplaysOn(true);
         }
     } else { // На всякий випадок якщо режим сну виключений, скинути всі параметри до звичних
-        esp_sleep_enable_timer_wakeup(0.2 * MICRO_TO_SECOND);
-        gpio_wakeup_disable((gpio_num_t)setButton.getPin());
-        leftOled.ssd1306_command(SSD1306_DISPLAYON);        
-        rightOled.ssd1306_command(SSD1306_DISPLAYON);
+        setDisplaysOn(true);
         sleeping = false;
     }
 
-    
+    // Вночі панелі тьмяніші, а годинник малюється тоншим
+    view.set(dimmed, dimTime(), VIEW_DIM);
+    setContrast(dimmed ? CONTRAST_NIGHT : CONTRAST_DAY);
 
+    // Вимірювання температури (в режимі сну рідше)
+    temperatureSampler.setPeriod(sleeping ? TEMPERATURE_SLEEP_PERIOD : TEMPERATURE_AWAKE_PERIOD);
+    if (temperatureSampler.update(currentTime))
+    {
+        last_temperature = temperatureSampler.getCelsius();
+        temperatureSampled();
+        temperatureShown();
+    }
 
-    // Режими\екрани програми
+    // Режими\екрани програми. Показується екран режиму, з якого почалось
+    // пробудження, навіть якщо кнопка вже його змінила.
+    int screenMode = mode;
     switch (mode)
     {
     case 0: // Годинник + будильник
-        
         clockUpdate();
-        
-        // Відмальовуємо годинник тільки коли не спимо
-        if (!sleeping or setButton.getClicked()) displayClock();
-
         break;
     case 1: // Меню
         menuUpdate();
-
-        displayMenu();
         break;
     case 2: // Налаштування
         actionMenuUpdate();
-
-        displayActionMenu();
         break;
-    }    
-    
-    // Оновлення дисплею
-    leftOled.display();
-    rightOled.display();
+    }
 
-    // Приблизна напруга акамулятора
-    voltage = ((analogRead(4) / 4095.0) * 3.3) - 0.29;
-    voltage *= 2.02;
+    displayFrame(screenMode);
+    if (navigating)
+        power.release(POWER_LOCK_CPU_MAX);
 
-    // Приблизний заряд акамулятора і відфільтрований 
-    // заряд (максимум 100% та мінімум 0%)
-    charge = round((voltage - DISCHARGED_BATTERY_VOLTAGE) / (CHARGED_BATTERY_VOLTAGE - DISCHARGED_BATTERY_VOLTAGE) * 100);
-    charge = clamp(charge, 100, 0);
+    trace.recordChange(TRACE_MODE, mode, traceMs());
+    trace.recordChange(TRACE_SLEEPING, sleeping, traceMs());
 
-    // Якщо заряд менше 1%, виключаємо пристрій
-    // в Deep Sleep споживання енергії дуже мале, тому 
+    // Час від старту чипа до першого показаного кадру
+    if (first_frame_pending && displays_on)
+    {
+        first_frame_pending = false;
+        Serial.printf("boot: %s, first frame after %lu us\r\n", warm_boot ? "warm" : "cold", (unsigned long)micros());
+    }
+
+    // Після теплого старту датчик ініціалізується вже після першого кадру
+    if (sensor_pending)
+    {
+        sensor_pending = false;
+        bmp.begin(BMP280_ADDRESS_ALT, BMP280_CHIPID);
+        temperatureSampler.resume(currentTime, last_temperature);
+        temperatureShown();
+    }
+
+    // Заряд акамулятора (вимірюється раз на BATTERY_SAMPLE_PERIOD)
+    if (battery.update(currentTime)) {
+        energy.countBatteryRead(BATTERY_OVERSAMPLING);
+        view.set(charge, battery.getCharge(), VIEW_BATTERY);
+        trace.recordChange(TRACE_BATTERY, lroundf(battery.getVoltage() * 100), traceMs());
+    }
+
+    // Якщо відфільтрований заряд кілька вимірювань підряд 0%, виключаємо
+    // пристрій в Deep Sleep споживання енергії дуже мале, тому 
     // він майже виключений
-    if (charge < 1) {
+    if (battery.isEmpty()) {
+        saveSettings(true);
+        energy.sleep();
+        // Таймер останнього легкого сну розбудив би чип знову
+        esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
         esp_deep_sleep_start();
     }
     // Якщо заряд менше п'яти, кожні 500 мілісекунд блимати світлодіодом
@@ -1123,6 +1732,18 @@ void loop()
         digitalWrite(CHARGE_LED, LOW);
     }
 
-    // Затримка перед наступною ітерацією програми
-    esp_light_sleep_start();
+    saveSettings();
+
+    // В режимі сну з погашеним екраном - глибокий сон
+    if (nightSleepAllowed())
+        nightSleep();
+
+    // Сон до наступної події
+    scheduleWakeup();
+    wakeScheduler.request(temperatureSampler.schedule(currentTime, wakeScheduler.get()));
+    energy.countI2CUs(oledTiming.take() + sensorTiming.take());
+    energy.countBoostUs(power.takeBoostUs());
+    energy.sleep();
+    power.release(POWER_LOCK_NO_SLEEP);
+    power.idle(wakeScheduler.get());
 }
\ No newline at end of file
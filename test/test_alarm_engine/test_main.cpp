@@ -0,0 +1,117 @@
+// Будильники: повтор, дні тижня, одноразовий будильник та пропуск
+// запізнілого спрацювання.
+//
+// Запуск: pio test -e native -f test_alarm_engine
+#include "AlarmEngine.h"
+#include "Calendar.h"
+#include "ClockCore.h"
+
+#include <unity.h>
+
+// Понеділок 14.07.2025, 00:00:00
+static const uint64_t MONDAY = (uint64_t)daysFromCivil(2025, 7, 14) * SECONDS_PER_DAY;
+
+static AlarmEngine engine;
+
+void setUp()
+{
+    engine = AlarmEngine();
+    engine.set(0, {ALARM_OFF, ALARM_EVERY_DAY, 7, 30, 0, 0}, MONDAY);
+}
+
+void tearDown() {}
+
+static uint64_t at(int day, int hours, int minutes)
+{
+    return MONDAY + day * SECONDS_PER_DAY + hours * 3600 + minutes * 60;
+}
+
+static void test_repeat_fires_every_day()
+{
+    engine.set(1, {ALARM_REPEAT, ALARM_EVERY_DAY, 7, 30, 0, 0}, MONDAY);
+
+    for (int day = 0; day < 10; day++)
+    {
+        TEST_ASSERT_EQUAL_UINT64(at(day, 7, 30), engine.next());
+        TEST_ASSERT_EQUAL_INT(-1, engine.poll(at(day, 7, 30) - 1));
+        TEST_ASSERT_EQUAL_INT(1, engine.poll(at(day, 7, 30)));
+    }
+    TEST_ASSERT_FALSE(engine.takeDisarmed());
+}
+
+static void test_weekday_mask()
+{
+    // Вівторок та субота
+    engine.set(2, {ALARM_REPEAT, 1 << 1 | 1 << 5, 6, 0, 0, 0}, MONDAY);
+
+    TEST_ASSERT_EQUAL_UINT64(at(1, 6, 0), engine.next());
+    TEST_ASSERT_EQUAL_INT(2, engine.poll(at(1, 6, 0)));
+    TEST_ASSERT_EQUAL_UINT64(at(5, 6, 0), engine.next());
+    TEST_ASSERT_EQUAL_INT(2, engine.poll(at(5, 6, 0)));
+    TEST_ASSERT_EQUAL_UINT64(at(8, 6, 0), engine.next());
+
+    // Без жодного дня будильник не спрацьовує
+    engine.set(2, {ALARM_REPEAT, 0, 6, 0, 0, 0}, MONDAY);
+    TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, engine.next());
+}
+
+static void test_nearest_alarm_first()
+{
+    engine.set(0, {ALARM_REPEAT, ALARM_EVERY_DAY, 9, 0, 0, 0}, MONDAY);
+    engine.set(1, {ALARM_REPEAT, ALARM_EVERY_DAY, 6, 0, 0, 0}, MONDAY);
+    engine.set(2, {ALARM_ONCE, ALARM_EVERY_DAY, 7, 0, 0, 0}, MONDAY);
+    engine.set(3, {ALARM_REPEAT, 1 << 6, 5, 0, 0, 0}, MONDAY);
+
+    TEST_ASSERT_EQUAL_INT(1, engine.poll(at(0, 6, 0)));
+    TEST_ASSERT_EQUAL_INT(2, engine.poll(at(0, 7, 0)));
+    TEST_ASSERT_EQUAL_INT(0, engine.poll(at(0, 9, 0)));
+    TEST_ASSERT_EQUAL_UINT64(at(1, 6, 0), engine.next());
+}
+
+static void test_once_fires_and_turns_off()
+{
+    engine.set(1, {ALARM_ONCE, ALARM_EVERY_DAY, 7, 30, 0, 0}, at(0, 8, 0));
+
+    // Сьогодні час вже минув, тому завтра
+    TEST_ASSERT_EQUAL_UINT64(at(1, 7, 30), engine.next());
+
+    // Пробудження проскочило секунду будильника
+    TEST_ASSERT_EQUAL_INT(1, engine.poll(at(1, 7, 30) + 3));
+    TEST_ASSERT_EQUAL_INT(ALARM_OFF, engine.get(1).mode);
+    TEST_ASSERT_TRUE(engine.takeDisarmed());
+    TEST_ASSERT_FALSE(engine.takeDisarmed());
+    TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, engine.next());
+}
+
+static void test_late_alarm_is_skipped()
+{
+    engine.set(1, {ALARM_REPEAT, ALARM_EVERY_DAY, 7, 30, 0, 0}, MONDAY);
+    engine.set(2, {ALARM_ONCE, ALARM_EVERY_DAY, 7, 40, 0, 0}, MONDAY);
+
+    // Годинник стояв в меню довше ALARM_MAX_LATE_S
+    TEST_ASSERT_EQUAL_INT(-1, engine.poll(at(0, 7, 40) + ALARM_MAX_LATE_S + 1));
+
+    // Повторюваний - на завтра, а одноразовий вимкнений, і про це
+    // повідомляється, щоб годинник записав зміну
+    TEST_ASSERT_EQUAL_UINT64(at(1, 7, 30), engine.next());
+    TEST_ASSERT_EQUAL_INT(ALARM_OFF, engine.get(2).mode);
+    TEST_ASSERT_TRUE(engine.takeDisarmed());
+}
+
+static void test_late_within_limit_still_fires()
+{
+    engine.set(1, {ALARM_REPEAT, ALARM_EVERY_DAY, 7, 30, 0, 0}, MONDAY);
+    TEST_ASSERT_EQUAL_INT(1, engine.poll(at(0, 7, 30) + ALARM_MAX_LATE_S));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_repeat_fires_every_day);
+    RUN_TEST(test_weekday_mask);
+    RUN_TEST(test_nearest_alarm_first);
+    RUN_TEST(test_once_fires_and_turns_off);
+    RUN_TEST(test_late_alarm_is_skipped);
+    RUN_TEST(test_late_within_limit_still_fires);
+    return UNITY_END();
+}
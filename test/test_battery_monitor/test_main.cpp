@@ -0,0 +1,92 @@
+// Фільтр заряду та рішення про вимкнення годинника.
+//
+// Запуск: pio test -e native -f test_battery_monitor
+#include "BatteryMonitor.h"
+#include "NativeHal.h"
+
+#include <unity.h>
+
+#define PERIOD_MS 60000
+
+static BatteryMonitor battery(4, PERIOD_MS);
+static uint32_t now;
+
+void setUp()
+{
+    hal::begin();
+    battery = BatteryMonitor(4, PERIOD_MS);
+    now = 0;
+}
+
+void tearDown() {}
+
+// Одне вимірювання при напрузі volts
+static void measure(float volts)
+{
+    hal::setBatteryVoltage(volts);
+    battery.resume(now);
+    TEST_ASSERT_TRUE(battery.update(now));
+    now += PERIOD_MS;
+}
+
+static void test_empty_after_consecutive_readings()
+{
+    for (int i = 0; i < BATTERY_EMPTY_READINGS - 1; i++)
+    {
+        measure(3.1);
+        TEST_ASSERT_EQUAL_INT(0, battery.getCharge());
+        TEST_ASSERT_FALSE(battery.isEmpty());
+    }
+
+    measure(3.1);
+    TEST_ASSERT_TRUE(battery.isEmpty());
+}
+
+static void test_one_bad_reading_is_filtered()
+{
+    for (int i = 0; i < 10; i++)
+        measure(3.8);
+
+    // Стан фільтра пережив сон (об'єкт в RTC пам'яті): падіння напруги в
+    // одному вимірюванні не обнуляє заряд
+    measure(3.0);
+    TEST_ASSERT_TRUE(battery.getCharge() > 0);
+    TEST_ASSERT_FALSE(battery.isEmpty());
+}
+
+static void test_charge_resets_empty_count()
+{
+    for (int i = 0; i < BATTERY_EMPTY_READINGS - 1; i++)
+        measure(3.1);
+
+    // Після заряду лічильник починається спочатку
+    for (int i = 0; i < 10; i++)
+        measure(4.0);
+    for (int i = 0; i < BATTERY_EMPTY_READINGS - 1; i++)
+        measure(3.1);
+    TEST_ASSERT_FALSE(battery.isEmpty());
+}
+
+static void test_resume_measures_at_once()
+{
+    hal::setBatteryVoltage(3.8);
+    TEST_ASSERT_TRUE(battery.update(1000));
+    TEST_ASSERT_FALSE(battery.update(1000 + PERIOD_MS - 1));
+
+    // millis() після пробудження знову з нуля, і без resume() вимірювання
+    // чекало б на момент з минулого запуску
+    TEST_ASSERT_FALSE(battery.update(5000));
+    battery.resume(5000);
+    TEST_ASSERT_EQUAL_UINT32(0, battery.nextWakeMs(5000));
+    TEST_ASSERT_TRUE(battery.update(5000));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_after_consecutive_readings);
+    RUN_TEST(test_one_bad_reading_is_filtered);
+    RUN_TEST(test_charge_resets_empty_count);
+    RUN_TEST(test_resume_measures_at_once);
+    return UNITY_END();
+}
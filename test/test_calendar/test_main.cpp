@@ -0,0 +1,93 @@
+// Календар на кожному дні 1970-2199 проти libc та циклів по роках і
+// місяцях, якими ClockCore рахував дату раніше.
+//
+// Запуск: pio test -e native -f test_calendar
+#include "Calendar.h"
+
+#include <time.h>
+#include <unity.h>
+
+#define FIRST_YEAR 1970
+#define LAST_YEAR 2199
+
+void setUp() {}
+void tearDown() {}
+
+static int32_t lastDay()
+{
+    return daysFromCivil(LAST_YEAR, 12, 31);
+}
+
+// Дата дня так, як її рахував ClockCore до Calendar.h
+static CivilDate civilWithLoops(uint32_t day)
+{
+    int y = FIRST_YEAR;
+    while (day >= (uint32_t)(isLeapYear(y) ? 366 : 365))
+        day -= isLeapYear(y++) ? 366 : 365;
+
+    int m = 1;
+    while (day >= (uint32_t)daysInMonth(m, y))
+        day -= daysInMonth(m++, y);
+
+    return {(int16_t)y, (uint8_t)m, (uint8_t)(day + 1)};
+}
+
+static void test_every_day_matches_libc()
+{
+    uint32_t mismatches = 0;
+    for (int32_t day = 0; day <= lastDay(); day++)
+    {
+        time_t t = (time_t)day * 86400;
+        struct tm tm;
+        gmtime_r(&t, &tm);
+
+        CivilDate date = civilFromDays(day);
+        mismatches += date.year != tm.tm_year + 1900 || date.month != tm.tm_mon + 1 || date.date != tm.tm_mday ||
+                      weekdayFromDays(day) != (tm.tm_wday + 6) % 7;
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+}
+
+static void test_every_day_round_trips()
+{
+    uint32_t mismatches = 0;
+    CivilDate previous = civilFromDays(-1);
+    TEST_ASSERT_EQUAL_INT(1969, previous.year);
+
+    for (int32_t day = 0; day <= lastDay(); day++)
+    {
+        CivilDate date = civilFromDays(day);
+        CivilDate loops = civilWithLoops(day);
+
+        // Наступний день після previous: той же місяць, перше число
+        // наступного місяця або 1 січня наступного року
+        bool next = (date.date == previous.date + 1 && date.month == previous.month && date.year == previous.year) ||
+                    (date.date == 1 && previous.date == daysInMonth(previous.month, previous.year) &&
+                     (date.month == previous.month + 1 ? date.year == previous.year
+                                                       : date.month == 1 && date.year == previous.year + 1));
+
+        mismatches += !next || date.year != loops.year || date.month != loops.month || date.date != loops.date ||
+                      daysFromCivil(date.year, date.month, date.date) != day;
+        previous = date;
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+    TEST_ASSERT_EQUAL_INT(LAST_YEAR, previous.year);
+    TEST_ASSERT_EQUAL_INT(12, previous.month);
+    TEST_ASSERT_EQUAL_INT(31, previous.date);
+}
+
+static void test_leap_years()
+{
+    TEST_ASSERT_EQUAL_INT(29, civilFromDays(daysFromCivil(2000, 3, 1) - 1).date);
+    TEST_ASSERT_EQUAL_INT(28, civilFromDays(daysFromCivil(2100, 3, 1) - 1).date);
+    TEST_ASSERT_EQUAL_INT(29, civilFromDays(daysFromCivil(2028, 3, 1) - 1).date);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_every_day_matches_libc);
+    RUN_TEST(test_every_day_round_trips);
+    RUN_TEST(test_leap_years);
+    return UNITY_END();
+}
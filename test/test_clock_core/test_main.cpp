@@ -0,0 +1,96 @@
+// Ядро годинника проти точного цілого результату та старого шляху на float.
+//
+// Запуск: pio test -e native -f test_clock_core
+#include "ClockCore.h"
+
+#include <unity.h>
+
+// Тік, яким loop() просував годинник до ядра, та денна поправка (main.cpp)
+#define TICK_US 200000ULL
+#define TICK_PPB 2181676
+#define TICKS 100000000ULL
+
+// Старий шлях (до ядра): float секунди з переносом в хвилини. При переносі
+// залишок понад 60 секунд відкидався.
+#define OLD_TIME_OFFSET 1.002181676275
+#define OLD_MILLI_TO_SECOND 1000.0
+
+void setUp() {}
+void tearDown() {}
+
+// Точна кількість мікросекунд після ticks тіків: поправка кожного тіку
+// ділиться на цілу частину та залишок, і залишки всіх тіків додаються разом
+static uint64_t exactUs(uint64_t ticks, uint64_t tickUs, int32_t ppb)
+{
+    uint64_t scaled = tickUs * ppb;
+    return ticks * (tickUs + scaled / PPB) + ticks * (scaled % PPB) / PPB;
+}
+
+static void test_advance_matches_exact_integer_result()
+{
+    ClockCore core;
+    for (uint64_t i = 0; i < TICKS; i++)
+        core.advance(TICK_US, TICK_PPB);
+
+    TEST_ASSERT_EQUAL_UINT64(exactUs(TICKS, TICK_US, TICK_PPB), core.getEpochUs());
+}
+
+static void test_old_float_path_drifts()
+{
+    float seconds = 0;
+    uint64_t minutes = 0;
+    for (uint64_t i = 0; i < TICKS; i++)
+    {
+        float deltaTime = TICK_US / 1000;
+        seconds += (deltaTime / OLD_MILLI_TO_SECOND) * OLD_TIME_OFFSET;
+        if (seconds >= 60)
+        {
+            seconds = 0;
+            minutes++;
+        }
+    }
+
+    // За ~232 доби старий шлях відстає на години, ядро - ні на мікросекунду
+    double oldSeconds = minutes * 60.0 + seconds;
+    double exactSeconds = exactUs(TICKS, TICK_US, TICK_PPB) / 1e6;
+    TEST_ASSERT_TRUE(exactSeconds - oldSeconds > 3600);
+}
+
+static void test_negative_correction_carries_remainder()
+{
+    // Годинник, який має йти повільніше на 1 ppb: поправка кожної секунди -
+    // тисячна мікросекунди, а за 1000 секунд - рівно одна
+    ClockCore core;
+    for (int i = 0; i < 999; i++)
+        core.advance(1000000, -1);
+    TEST_ASSERT_EQUAL_UINT64(999ULL * 1000000, core.getEpochUs());
+
+    core.advance(1000000, -1);
+    TEST_ASSERT_EQUAL_UINT64(1000ULL * 1000000 - 1, core.getEpochUs());
+}
+
+static void test_fields_follow_the_counter()
+{
+    ClockCore core;
+    core.setDate(29, 2, 2028);
+    core.setTime(23, 59, 59);
+    TEST_ASSERT_EQUAL_INT(23, core.getHours());
+    TEST_ASSERT_EQUAL_INT(29, core.getDate());
+
+    core.advance(1000000, 0);
+    TEST_ASSERT_EQUAL_INT(0, core.getHours());
+    TEST_ASSERT_EQUAL_INT(0, core.getSeconds());
+    TEST_ASSERT_EQUAL_INT(1, core.getDate());
+    TEST_ASSERT_EQUAL_INT(3, core.getMonth());
+    TEST_ASSERT_EQUAL_INT(2028, core.getYear());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_advance_matches_exact_integer_result);
+    RUN_TEST(test_old_float_path_drifts);
+    RUN_TEST(test_negative_correction_carries_remainder);
+    RUN_TEST(test_fields_follow_the_counter);
+    return UNITY_END();
+}
@@ -0,0 +1,130 @@
+// Калібровка дрифту: збіжність на синтетичних кривих (DriftSimulation.h) та
+// правила, за якими виправлення часу стає рівнянням.
+//
+// Запуск: pio test -e native -f test_drift_calibrator
+#include "DriftSimulation.h"
+
+#include <math.h>
+#include <unity.h>
+
+#define WEEKS 26
+
+// Годинник з калібровкою за останні тижні має розходитись менше ніж на
+// стільки секунд за тиждень
+#define TARGET_S_PER_WEEK 3.0
+#define SETTLED_WEEKS 4
+
+// З якого тижня коефіцієнт кривої "step" вже знайдений (після двох
+// тижнів в холоднішій кімнаті) і з якою точністю, ppb/°C^2
+#define STEP_FIT_WEEK 14
+#define STEP_FIT_TOLERANCE 6.0
+
+// Без перепадів температури коефіцієнт лишається біля нуля
+#define OFFSET_MAX_QUADRATIC 20.0
+
+#define DAY_US (SECONDS_PER_DAY * MICROS_PER_SECOND)
+
+void setUp() {}
+void tearDown() {}
+
+static void test_every_curve_settles()
+{
+    for (const DriftCurve &curve : DRIFT_CURVES)
+    {
+        DriftSimulation simulation(curve);
+        double settled = 0;
+        for (int week = 0; week < WEEKS; week++)
+        {
+            simulation.runWeek();
+            if (week >= WEEKS - SETTLED_WEEKS)
+                settled += fabs(simulation.getCalibratedDrift()) / SETTLED_WEEKS;
+        }
+        TEST_ASSERT_TRUE_MESSAGE(settled < TARGET_S_PER_WEEK, curve.name);
+    }
+}
+
+static void test_temperature_step_finds_quadratic()
+{
+    const DriftCurve &curve = DRIFT_CURVES[3];
+    DriftSimulation simulation(curve);
+    for (int week = 1; week <= WEEKS; week++)
+    {
+        simulation.runWeek();
+        if (week >= STEP_FIT_WEEK)
+            TEST_ASSERT_FLOAT_WITHIN(STEP_FIT_TOLERANCE, curve.quadratic, simulation.getCalibrator().getFit().ppb[2]);
+    }
+}
+
+static void test_constant_offset_keeps_quadratic_small()
+{
+    DriftSimulation simulation(DRIFT_CURVES[0]);
+    for (int week = 0; week < WEEKS; week++)
+        simulation.runWeek();
+    TEST_ASSERT_TRUE(fabs(simulation.getCalibrator().getFit().ppb[2]) < OFFSET_MAX_QUADRATIC);
+}
+
+static void test_sample_rules()
+{
+    DriftCalibrator calibrator;
+
+    // Перше встановлення тільки синхронізує годинник
+    calibrator.correction(2 * DAY_US, false);
+    TEST_ASSERT_FALSE(calibrator.userCorrection(1000000));
+
+    // Менше доби - не рівняння
+    calibrator.correction(DAY_US / 2, false);
+    TEST_ASSERT_FALSE(calibrator.userCorrection(100000));
+
+    // Понад DRIFT_MAX_PPM - переведення годинника
+    calibrator.correction(2 * DAY_US, false);
+    TEST_ASSERT_FALSE(calibrator.userCorrection(3600LL * MICROS_PER_SECOND));
+
+    // Виправлення через північ (годинник на секунду відстав на 23:59:59)
+    calibrator.correction(2 * DAY_US, false);
+    TEST_ASSERT_TRUE(calibrator.userCorrection(1000000 - (int64_t)DAY_US));
+    TEST_ASSERT_EQUAL_UINT32(1, calibrator.getSamples());
+    TEST_ASSERT_TRUE(calibrator.getPpb(false) > DRIFT_DAY_PPB);
+
+    // Після відновлення часу з флешу похибка невідома
+    calibrator.desync();
+    calibrator.correction(2 * DAY_US, false);
+    TEST_ASSERT_FALSE(calibrator.userCorrection(1000000));
+}
+
+static void test_room_temperature_keeps_factory_rate()
+{
+    DriftCalibrator calibrator;
+    DriftFit fit = calibrator.getFit();
+    fit.ppb[2] = -34;
+    calibrator.restore(fit);
+
+    calibrator.setTemperature(DRIFT_ROOM_C);
+    TEST_ASSERT_EQUAL_INT(DRIFT_DAY_PPB, calibrator.getPpb(false));
+    calibrator.setTemperature(NAN);
+    TEST_ASSERT_EQUAL_INT(DRIFT_DAY_PPB, calibrator.getPpb(false));
+    calibrator.setTemperature(DRIFT_ROOM_C - 10);
+    TEST_ASSERT_TRUE(calibrator.getPpb(false) < DRIFT_DAY_PPB);
+}
+
+static void test_restore_rejects_broken_fit()
+{
+    DriftCalibrator calibrator;
+    DriftFit fit = calibrator.getFit();
+    fit.ppb[0] = NAN;
+    fit.samples = 7;
+    calibrator.restore(fit);
+    TEST_ASSERT_EQUAL_UINT32(0, calibrator.getSamples());
+    TEST_ASSERT_EQUAL_INT(DRIFT_DAY_PPB, calibrator.getPpb(false));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_every_curve_settles);
+    RUN_TEST(test_temperature_step_finds_quadratic);
+    RUN_TEST(test_constant_offset_keeps_quadratic_small);
+    RUN_TEST(test_sample_rules);
+    RUN_TEST(test_room_temperature_keeps_factory_rate);
+    RUN_TEST(test_restore_rejects_broken_fit);
+    return UNITY_END();
+}
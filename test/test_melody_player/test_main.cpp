@@ -0,0 +1,132 @@
+// Плеєр мелодій на таймерах та LEDC нативного HAL: кожна зміна ШІМ в свою
+// мікросекунду з тією ж частотою та гучністю, поки чип між нотами спить.
+//
+// Запуск: pio test -e native -f test_melody_player
+#include "MelodyPlayer.h"
+#include "NativeHal.h"
+
+#include <esp_sleep.h>
+#include <stdlib.h>
+#include <unity.h>
+
+#define TEST_PIN 3
+#define PLAY_SECONDS 30
+
+// Зміщення початку мелодії від старту, щоб вона не починалась на круглій
+// мікросекунді, та робота loop() на кожному пробудженні (кадр, кнопки), мкс
+#define START_OFFSET_US 12345
+#define LOOP_WORK_US 900
+
+static uint64_t start;
+static uint64_t soundingUs;
+
+void setUp()
+{
+    hal::begin();
+    soundingUs = 0;
+}
+
+void tearDown()
+{
+    hal::finish();
+}
+
+// Грати melody seconds секунд, засинаючи до моменту, який просить плеєр, як
+// loop() прошивки
+static void play(const Melody &melody, int seconds)
+{
+    MelodyPlayer player;
+    player.begin(TEST_PIN);
+    hal::advanceUs(START_OFFSET_US);
+
+    hal::setLedcLogging(true);
+    start = hal::nowUs();
+    uint64_t end = start + (uint64_t)seconds * 1000000;
+    player.play(melody);
+    while (hal::nowUs() < end)
+    {
+        hal::advanceUs(LOOP_WORK_US);
+        soundingUs += player.takeSoundingUs();
+
+        esp_sleep_enable_timer_wakeup(player.nextWakeUs());
+        esp_light_sleep_start();
+    }
+    player.stop();
+    soundingUs += player.takeSoundingUs();
+}
+
+// Журнал LEDC проти кроків мелодії по колу з моменту start: остання зміна -
+// зупинка
+static void checkLog(const Melody &melody)
+{
+    std::vector<hal::LedcChange> &log = hal::ledcLog();
+    TEST_ASSERT_TRUE(log.size() > (size_t)melody.count * 2);
+    TEST_ASSERT_EQUAL_UINT32(0, log.back().duty);
+
+    uint64_t at = start;
+    uint32_t freq = melody.steps[0].hz, loop = 0;
+    int step = 0;
+    uint32_t wrongTime = 0, wrongOutput = 0;
+    for (size_t i = 0; i + 1 < log.size(); i++)
+    {
+        const MelodyStep &expected = melody.steps[step];
+        if (expected.hz)
+            freq = expected.hz;
+
+        wrongTime += log[i].atUs != at;
+        wrongOutput += log[i].pin != TEST_PIN || log[i].freqHz != freq ||
+                       log[i].duty != melodyDuty(melody, expected, loop);
+
+        at += expected.us;
+        if (++step == melody.count)
+        {
+            step = 0;
+            loop++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, wrongTime, melody.name);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, wrongOutput, melody.name);
+    TEST_ASSERT_EQUAL_UINT32(0, hal::stats.lateTimerCallbacks);
+
+    // Облік часу звучання збігається з тим, скільки пін був під ШІМ
+    TEST_ASSERT_TRUE(llabs((int64_t)soundingUs - (int64_t)hal::pwmOnUs(TEST_PIN)) <= 1);
+}
+
+static void test_beep()
+{
+    play(MELODIES[0], PLAY_SECONDS);
+    checkLog(MELODIES[0]);
+}
+
+static void test_chirp()
+{
+    play(MELODIES[1], PLAY_SECONDS);
+    checkLog(MELODIES[1]);
+}
+
+static void test_rise()
+{
+    play(MELODIES[2], PLAY_SECONDS);
+    checkLog(MELODIES[2]);
+}
+
+static void test_chip_sleeps_between_notes()
+{
+    play(MELODIES[1], PLAY_SECONDS);
+
+    // Пробудження тільки до змін нот (та їх таймерів), а не на кожен
+    // період ШІМ чи мілісекунду
+    uint64_t length = melodyLength(MELODIES[1]);
+    uint32_t changesPerSecond = (uint32_t)(MELODIES[1].count * 1000000ULL / length) + 1;
+    TEST_ASSERT_TRUE(hal::stats.wakes < (uint32_t)PLAY_SECONDS * changesPerSecond * 3);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_beep);
+    RUN_TEST(test_chirp);
+    RUN_TEST(test_rise);
+    RUN_TEST(test_chip_sleeps_between_notes);
+    return UNITY_END();
+}
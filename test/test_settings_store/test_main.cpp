@@ -0,0 +1,112 @@
+// Записи налаштувань у флеш: злиття змін в один запис за
+// SETTINGS_COMMIT_INTERVAL та відсутність запису без змін.
+//
+// Запуск: pio test -e native -f test_settings_store
+#include "NativeHal.h"
+#include "SettingsStore.h"
+
+#include <string.h>
+#include <unity.h>
+
+static SettingsStore store;
+static Settings settings;
+
+void setUp()
+{
+    hal::begin();
+    Preferences preferences;
+    preferences.begin(SETTINGS_NAMESPACE, false);
+    preferences.clear();
+    preferences.end();
+
+    store = SettingsStore();
+    memset(&settings, 0, sizeof(settings));
+    hal::stats.nvsWrites = 0;
+}
+
+void tearDown() {}
+
+// Зміна на екрані налаштувань та вихід з нього в момент now
+static void edit(uint32_t now, uint8_t sleepHours)
+{
+    settings.sleepStart[0] = sleepHours;
+    store.mark();
+    store.queue();
+    store.commit(now, settings);
+}
+
+static void test_burst_of_edits_is_one_write()
+{
+    // Перший запис після старту - одразу
+    edit(1000, 22);
+    TEST_ASSERT_EQUAL_UINT32(1, hal::stats.nvsWrites);
+
+    // Ще п'ять змін протягом хвилини чекають
+    for (int i = 1; i <= 5; i++)
+        edit(1000 + i * 10000, 22 + i % 2);
+    TEST_ASSERT_EQUAL_UINT32(1, hal::stats.nvsWrites);
+    TEST_ASSERT_TRUE(store.pending());
+    TEST_ASSERT_EQUAL_UINT32(1000, store.nextCommitMs(1000 + 59000));
+
+    // Через SETTINGS_COMMIT_INTERVAL всі вони - один запис з останнім
+    // значенням
+    TEST_ASSERT_TRUE(store.commit(1000 + SETTINGS_COMMIT_INTERVAL, settings));
+    TEST_ASSERT_EQUAL_UINT32(2, hal::stats.nvsWrites);
+    TEST_ASSERT_FALSE(store.pending());
+
+    Settings loaded;
+    TEST_ASSERT_TRUE(store.load(loaded));
+    TEST_ASSERT_EQUAL_INT(23, loaded.sleepStart[0]);
+    TEST_ASSERT_EQUAL_UINT32(2, store.getCommits());
+}
+
+static void test_no_changes_no_write()
+{
+    edit(1000, 22);
+    TEST_ASSERT_EQUAL_UINT32(1, hal::stats.nvsWrites);
+
+    // Вихід з налаштувань без змін, навіть перед глибоким сном
+    store.queue();
+    TEST_ASSERT_FALSE(store.pending());
+    TEST_ASSERT_FALSE(store.commit(1000 + 2 * SETTINGS_COMMIT_INTERVAL, settings, true));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, store.nextCommitMs(1000));
+    TEST_ASSERT_EQUAL_UINT32(1, hal::stats.nvsWrites);
+}
+
+static void test_force_skips_the_interval()
+{
+    edit(1000, 22);
+    edit(2000, 23);
+    TEST_ASSERT_EQUAL_UINT32(1, hal::stats.nvsWrites);
+
+    // Перед глибоким сном запис не чекає
+    TEST_ASSERT_TRUE(store.commit(3000, settings, true));
+    TEST_ASSERT_EQUAL_UINT32(2, hal::stats.nvsWrites);
+}
+
+static void test_other_version_is_ignored()
+{
+    Settings old = settings;
+    old.version = SETTINGS_VERSION - 1;
+    Preferences preferences;
+    preferences.begin(SETTINGS_NAMESPACE, false);
+    preferences.putBytes(SETTINGS_KEY, &old, sizeof(old));
+    preferences.end();
+
+    Settings loaded;
+    TEST_ASSERT_FALSE(store.load(loaded));
+
+    edit(1000, 22);
+    TEST_ASSERT_TRUE(store.load(loaded));
+    TEST_ASSERT_EQUAL_UINT32(SETTINGS_VERSION, loaded.version);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_burst_of_edits_is_one_write);
+    RUN_TEST(test_no_changes_no_write);
+    RUN_TEST(test_force_skips_the_interval);
+    RUN_TEST(test_other_version_is_ignored);
+    return UNITY_END();
+}
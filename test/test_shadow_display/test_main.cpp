@@ -0,0 +1,148 @@
+// Тіньовий фреймбуфер: байти, які пішли на шину, відрізки змінених колонок,
+// їх злиття через короткі проміжки та поділ на передачі по I2C.
+//
+// Запуск: pio test -e native -f test_shadow_display
+#include "NativeHal.h"
+#include "ShadowDisplay.h"
+
+#include <string.h>
+#include <unity.h>
+#include <vector>
+
+#define TEST_ADDRESS 0x3C
+
+// Модель панелі, яка ще й запам'ятовує довжину кожної передачі
+class RecordingPanel : public FakePanel
+{
+public:
+    std::vector<size_t> transfers;
+
+    void receive(const uint8_t *data, size_t length) override
+    {
+        transfers.push_back(length);
+        FakePanel::receive(data, length);
+    }
+};
+
+static TwoWire bus;
+static RecordingPanel panel;
+static Adafruit_SSD1306 oled(OLED_WIDTH, OLED_HEIGHT, &bus);
+static ShadowMemory memory;
+static I2CTiming timing;
+static ShadowDisplay shadow(&oled, &bus, TEST_ADDRESS, &memory, &timing);
+
+void setUp()
+{
+    hal::begin();
+    bus.attach(TEST_ADDRESS, &panel);
+    oled.begin(SSD1306_SWITCHCAPVCC, TEST_ADDRESS);
+    oled.clearDisplay();
+    shadow.invalidate();
+    shadow.flush();
+
+    bus.resetCounters();
+    panel.transfers.clear();
+}
+
+void tearDown() {}
+
+// Відомий малюнок: рамка, діагональ та заповнений прямокутник
+static void drawPattern()
+{
+    oled.drawRect(0, 0, OLED_WIDTH, OLED_HEIGHT, SSD1306_WHITE);
+    oled.drawLine(0, 0, OLED_WIDTH - 1, OLED_HEIGHT - 1, SSD1306_WHITE);
+    oled.fillRect(40, 20, 30, 12, SSD1306_WHITE);
+}
+
+// Змінити байт кадру на сторінці page в колонці column
+static void touch(uint8_t page, uint8_t column)
+{
+    oled.getBuffer()[page * OLED_WIDTH + column] ^= 0x01;
+}
+
+static void test_bytes_sent_match_the_bus()
+{
+    uint32_t before = shadow.getBytesSent();
+    drawPattern();
+    uint16_t sent = shadow.flush();
+
+    TEST_ASSERT_TRUE(sent > 0);
+    TEST_ASSERT_EQUAL_UINT32(sent, shadow.getBytesSent() - before);
+    TEST_ASSERT_EQUAL_UINT64(bus.bytesWritten, sent);
+    TEST_ASSERT_EQUAL_UINT64(bus.bytesTo[TEST_ADDRESS], sent);
+
+    // На панелі саме той кадр, і світні пікселі пораховані так само
+    TEST_ASSERT_EQUAL_INT(0, memcmp(panel.ram, oled.getBuffer(), OLED_BUFFER_SIZE));
+    TEST_ASSERT_EQUAL_UINT32(panel.litPixels, shadow.getLitPixels());
+}
+
+static void test_unchanged_frame_sends_nothing()
+{
+    drawPattern();
+    shadow.flush();
+    uint32_t before = shadow.getBytesSent();
+    uint64_t busBefore = bus.bytesWritten;
+
+    TEST_ASSERT_EQUAL_UINT32(0, shadow.flush());
+    TEST_ASSERT_EQUAL_UINT32(before, shadow.getBytesSent());
+    TEST_ASSERT_EQUAL_UINT64(busBefore, bus.bytesWritten);
+}
+
+static void test_runs_within_gap_are_merged()
+{
+    // Між зміненими колонками OLED_RUN_MERGE_GAP - 1 незмінених байтів:
+    // одне вікно (команди) та одна передача даних
+    touch(3, 10);
+    touch(3, 10 + OLED_RUN_MERGE_GAP);
+    uint16_t sent = shadow.flush();
+
+    TEST_ASSERT_EQUAL_UINT32(2, panel.transfers.size());
+    TEST_ASSERT_EQUAL_UINT32(OLED_RUN_MERGE_GAP + 1 + 1, panel.transfers[1]);
+    TEST_ASSERT_EQUAL_UINT32(7 + OLED_RUN_MERGE_GAP + 2, sent);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(panel.ram, oled.getBuffer(), OLED_BUFFER_SIZE));
+}
+
+static void test_runs_past_gap_are_separate()
+{
+    touch(3, 10);
+    touch(3, 10 + OLED_RUN_MERGE_GAP + 1);
+    uint16_t sent = shadow.flush();
+
+    // Два вікна по одному байту даних
+    TEST_ASSERT_EQUAL_UINT32(4, panel.transfers.size());
+    TEST_ASSERT_EQUAL_UINT32(2, panel.transfers[1]);
+    TEST_ASSERT_EQUAL_UINT32(2, panel.transfers[3]);
+    TEST_ASSERT_EQUAL_UINT32(2 * (7 + 2), sent);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(panel.ram, oled.getBuffer(), OLED_BUFFER_SIZE));
+}
+
+static void test_long_run_is_split_into_chunks()
+{
+    // Вся сторінка - один відрізок, який не вміщується в одну передачу
+    for (int column = 0; column < OLED_WIDTH; column++)
+        touch(5, column);
+    uint16_t sent = shadow.flush();
+
+    size_t chunks = (OLED_WIDTH + OLED_I2C_CHUNK - 2) / (OLED_I2C_CHUNK - 1);
+    TEST_ASSERT_EQUAL_UINT32(1 + chunks, panel.transfers.size());
+    size_t data = 0;
+    for (size_t i = 1; i < panel.transfers.size(); i++)
+    {
+        TEST_ASSERT_TRUE(panel.transfers[i] <= OLED_I2C_CHUNK);
+        data += panel.transfers[i] - 1;
+    }
+    TEST_ASSERT_EQUAL_UINT32(OLED_WIDTH, data);
+    TEST_ASSERT_EQUAL_UINT32(7 + OLED_WIDTH + chunks, sent);
+    TEST_ASSERT_EQUAL_UINT64(bus.bytesWritten, sent);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bytes_sent_match_the_bus);
+    RUN_TEST(test_unchanged_frame_sends_nothing);
+    RUN_TEST(test_runs_within_gap_are_merged);
+    RUN_TEST(test_runs_past_gap_are_separate);
+    RUN_TEST(test_long_run_is_split_into_chunks);
+    return UNITY_END();
+}
@@ -0,0 +1,165 @@
+// Журнал подій: витіснення найстаріших записів, перенесення часу
+// найстарішого запису, перехід мілісекунд через 2^32 та вивід/читання.
+//
+// Запуск: pio test -e native -f test_trace_ring
+#include "TraceRing.h"
+
+#include <stdlib.h>
+#include <string>
+#include <unity.h>
+#include <vector>
+
+#define RECORDS 20000
+
+// Старт за кілька хвилин до переповнення лічильника мс
+#define START_MS 4294000000u
+
+static TraceRing ring;
+static std::vector<TraceRecord> written;
+
+// Вивід dump() в рядки
+class LinePrint : public Print
+{
+public:
+    std::vector<std::string> lines = {""};
+
+    size_t write(uint8_t c) override
+    {
+        if (c == '\n')
+            lines.push_back("");
+        else if (c != '\r')
+            lines.back() += (char)c;
+        return 1;
+    }
+};
+
+void setUp()
+{
+    ring.begin();
+    ring.clear();
+    written.clear();
+    srand(7);
+}
+
+void tearDown() {}
+
+static void write(uint8_t type, int32_t value, uint32_t timeMs)
+{
+    ring.record((TraceEvent)type, value, timeMs);
+    written.push_back({type, value, timeMs});
+}
+
+// Випадкові події: здебільшого маленькі значення та кроки, іноді великі
+// (окреме значення, довгий varint часу)
+static void writeRandom(int count, uint32_t startMs)
+{
+    uint32_t timeMs = startMs;
+    for (int i = 0; i < count; i++)
+    {
+        timeMs += rand() % 8 ? rand() % 2000 : rand() % 5000000;
+        int32_t value = rand() % 3 ? rand() % 15 : rand() % 200000 - 100000;
+        write(rand() % TRACE_EVENT_COUNT, value, timeMs);
+    }
+}
+
+static std::vector<TraceRecord> readAll(TraceRing &from)
+{
+    std::vector<TraceRecord> records;
+    TraceCursor cursor;
+    TraceRecord record;
+    from.rewind(cursor);
+    while (from.next(cursor, record))
+        records.push_back(record);
+    return records;
+}
+
+// В журналі - останні записані записи, всі з точним часом
+static void assertKeepsNewest(TraceRing &from)
+{
+    std::vector<TraceRecord> kept = readAll(from);
+    TEST_ASSERT_TRUE(kept.size() > 0);
+    TEST_ASSERT_EQUAL_UINT32(written.size(), kept.size() + from.getEvicted());
+
+    size_t first = written.size() - kept.size();
+    uint32_t mismatches = 0;
+    for (size_t i = 0; i < kept.size(); i++)
+    {
+        const TraceRecord &expected = written[first + i];
+        mismatches += kept[i].type != expected.type || kept[i].value != expected.value ||
+                      kept[i].timeMs != expected.timeMs;
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+}
+
+static void test_wrap_around_keeps_newest_records()
+{
+    writeRandom(RECORDS, START_MS);
+
+    TEST_ASSERT_TRUE(ring.getEvicted() > RECORDS / 2);
+    TEST_ASSERT_TRUE(ring.size() <= TRACE_RING_BYTES);
+    TEST_ASSERT_TRUE(written.back().timeMs < START_MS); // Лічильник мс перейшов через нуль
+    assertKeepsNewest(ring);
+}
+
+static void test_eviction_carries_base_time()
+{
+    // Записи з кроком 1 с, поки перший не витісниться
+    uint32_t timeMs = START_MS;
+    while (ring.getEvicted() == 0)
+        write(TRACE_MODE, 1, timeMs += 1000);
+
+    // Час найстарішого запису, що лишився, відновлюється з часу витіснених
+    // та їх кроків
+    std::vector<TraceRecord> kept = readAll(ring);
+    TEST_ASSERT_EQUAL_UINT32(written[ring.getEvicted()].timeMs, kept[0].timeMs);
+    assertKeepsNewest(ring);
+}
+
+static void test_time_wraps_between_records()
+{
+    write(TRACE_BOOT, 0, 0xFFFFFFF0u);
+    write(TRACE_BUTTON, 3, 0x00000010u);
+    write(TRACE_BUTTON, 2, 0x00000020u);
+    assertKeepsNewest(ring);
+}
+
+static void test_record_change_skips_repeats()
+{
+    ring.recordChange(TRACE_TEMPERATURE, 215, 1000);
+    ring.recordChange(TRACE_TEMPERATURE, 215, 2000);
+    ring.recordChange(TRACE_BATTERY, 380, 3000);
+    ring.recordChange(TRACE_TEMPERATURE, 214, 4000);
+
+    std::vector<TraceRecord> kept = readAll(ring);
+    TEST_ASSERT_EQUAL_UINT32(3, kept.size());
+    TEST_ASSERT_EQUAL_INT(214, kept[2].value);
+    TEST_ASSERT_EQUAL_UINT32(4000, kept[2].timeMs);
+}
+
+static void test_dump_and_load_after_wrap()
+{
+    writeRandom(RECORDS, START_MS);
+
+    LinePrint out;
+    ring.dump(out);
+
+    static TraceRing loaded;
+    loaded.begin();
+    bool done = false;
+    for (const std::string &line : out.lines)
+        done = loaded.load(line.c_str()) || done;
+    TEST_ASSERT_TRUE(done);
+    TEST_ASSERT_EQUAL_UINT32(ring.getEvicted(), loaded.getEvicted());
+    assertKeepsNewest(loaded);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_wrap_around_keeps_newest_records);
+    RUN_TEST(test_eviction_carries_base_time);
+    RUN_TEST(test_time_wraps_between_records);
+    RUN_TEST(test_record_change_skips_repeats);
+    RUN_TEST(test_dump_and_load_after_wrap);
+    return UNITY_END();
+}